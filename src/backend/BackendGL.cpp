@@ -33,26 +33,63 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "BackendGL.hpp"
 
+#include <algorithm>
+
 // Needs to go in the cpp file (should only be included once)
 #define NANOVG_GL3_IMPLEMENTATION
 #include "nanovg_gl.h"
+#include "nanovg_gl_utils.h"
 
+#ifndef TRASE_GL_NO_WINDOW
 #include "imgui_impl_glfw_gl3.h"
+#endif
+
+#include "util/Png.hpp"
 
 namespace trase {
+#ifndef TRASE_GL_NO_WINDOW
 static void glfw_error_callback(int error, const char *description) {
   fprintf(stderr, "Error %d: %s\n", error, description);
 }
+#endif
+
+BackendGL::~BackendGL() {
+  if (m_offscreen_context) {
+    if (m_framebuffer != nullptr) {
+      nvgluDeleteFramebuffer(m_framebuffer);
+    }
+    nvgDeleteGL3(m_vg);
+  }
+}
+
+void BackendGL::offscreen(const std::string &filename) {
+  m_offscreen = true;
+  m_offscreen_filename = filename;
+}
 
 void BackendGL::init(int x_pixels, int y_pixels, const char *name) {
+  if (m_offscreen) {
+    init_offscreen(x_pixels, y_pixels);
+    return;
+  }
+#ifdef TRASE_GL_NO_WINDOW
+  (void)name;
+  throw Exception("trase was built without window support, use offscreen()");
+#else
   m_window = create_window(x_pixels, y_pixels, name);
   if (!m_window)
     throw Exception("trase: Cannot create OpenGL window");
   init_imgui(m_window);
   m_vg = init_nanovg(x_pixels, y_pixels);
+#endif
 }
 
 void BackendGL::finalise() {
+  if (m_offscreen) {
+    finalise_offscreen();
+    return;
+  }
+#ifndef TRASE_GL_NO_WINDOW
   // Cleanup
   ImGui_ImplGlfwGL3_Shutdown();
   ImGui::DestroyContext();
@@ -61,8 +98,63 @@ void BackendGL::finalise() {
 
   glfwDestroyWindow(m_window);
   glfwTerminate();
+#endif
+}
+
+void BackendGL::init_offscreen(int x_pixels, int y_pixels) {
+  if (!m_offscreen_context) {
+    m_offscreen_context.reset(new OffscreenContext(x_pixels, y_pixels));
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(
+            &OffscreenContext::get_proc_address))) {
+      throw Exception("Could not load GL extensions");
+    }
+    m_vg = init_nanovg(x_pixels, y_pixels);
+  }
+
+  if (m_framebuffer == nullptr || x_pixels != m_image_width ||
+      y_pixels != m_image_height) {
+    if (m_framebuffer != nullptr) {
+      nvgluDeleteFramebuffer(m_framebuffer);
+    }
+    m_framebuffer = nvgluCreateFramebuffer(m_vg, x_pixels, y_pixels, 0);
+    if (m_framebuffer == nullptr) {
+      throw Exception("Could not create OpenGL framebuffer");
+    }
+    m_image_width = x_pixels;
+    m_image_height = y_pixels;
+  }
+
+  nvgluBindFramebuffer(m_framebuffer);
+  glViewport(0, 0, x_pixels, y_pixels);
+  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+  nvgBeginFrame(m_vg, x_pixels, y_pixels, 1.0f);
+}
+
+void BackendGL::finalise_offscreen() {
+  nvgEndFrame(m_vg);
+
+  const size_t row_bytes = 4 * static_cast<size_t>(m_image_width);
+  m_image.resize(row_bytes * m_image_height);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, m_image_width, m_image_height, GL_RGBA, GL_UNSIGNED_BYTE,
+               m_image.data());
+  nvgluBindFramebuffer(nullptr);
+
+  // OpenGL returns the bottom row first
+  for (int i = 0; i < m_image_height / 2; ++i) {
+    std::swap_ranges(m_image.begin() + i * row_bytes,
+                     m_image.begin() + (i + 1) * row_bytes,
+                     m_image.end() - (i + 1) * row_bytes);
+  }
+
+  if (!m_offscreen_filename.empty()) {
+    write_png(m_offscreen_filename, m_image_width, m_image_height,
+              m_image.data());
+  }
 }
 
+#ifndef TRASE_GL_NO_WINDOW
 vfloat2_t BackendGL::begin_frame() {
   glfwPollEvents();
   ImGui_ImplGlfwGL3_NewFrame();
@@ -126,6 +218,15 @@ GLFWwindow *BackendGL::create_window(int x_pixels, int y_pixels,
             << std::endl;
   return window;
 }
+#else
+vfloat2_t BackendGL::begin_frame() {
+  throw Exception("trase was built without window support");
+}
+
+void BackendGL::end_frame() {
+  throw Exception("trase was built without window support");
+}
+#endif
 
 NVGcontext *BackendGL::init_nanovg(int x_pixels, int y_pixels) {
   NVGcontext *vg =
@@ -152,6 +253,7 @@ NVGcontext *BackendGL::init_nanovg(int x_pixels, int y_pixels) {
   return vg;
 }
 
+#ifndef TRASE_GL_NO_WINDOW
 void BackendGL::init_imgui(GLFWwindow *window) {
   // Setup Dear ImGui binding
   IMGUI_CHECKVERSION();
@@ -166,5 +268,6 @@ void BackendGL::init_imgui(GLFWwindow *window) {
   // Setup style
   ImGui::StyleColorsDark();
 }
+#endif
 
 } // namespace trase
@@ -37,41 +37,96 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define BACKENDGL_H_
 
 #include <glad.h>
+#ifdef TRASE_GL_NO_WINDOW
+// trase is built for off-screen rendering only
+struct GLFWwindow;
+#else
 // works for you.
 #define GLFW_INCLUDE_GLEXT
 #include <GLFW/glfw3.h>
+#endif
 
 #include <array>
 #include <cstdio>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "imgui.h"
 #include "nanovg.h"
 
 #include "backend/Backend.hpp"
+#include "backend/OffscreenGL.hpp"
 #include "util/BBox.hpp"
 #include "util/Colors.hpp"
 #include "util/Exception.hpp"
 #include "util/Vector.hpp"
 
+// declared in nanovg_gl_utils.h
+struct NVGLUframebuffer;
+
 namespace trase {
 
 class BackendGL : public Backend {
-  GLFWwindow *m_window;
-  NVGcontext *m_vg;
+  GLFWwindow *m_window{nullptr};
+  NVGcontext *m_vg{nullptr};
   FontManager m_fm;
   RGBA m_stroke_color_mouseover;
   RGBA m_fill_color_mouseover;
 
+  /// true if rendering off-screen, see offscreen()
+  bool m_offscreen{false};
+
+  /// the PNG file written by finalise() when rendering off-screen
+  std::string m_offscreen_filename;
+
+  /// the context used when rendering off-screen
+  std::unique_ptr<OffscreenContext> m_offscreen_context;
+
+  /// the framebuffer object rendered into when rendering off-screen
+  NVGLUframebuffer *m_framebuffer{nullptr};
+
+  /// the last image rendered off-screen, see image()
+  std::vector<unsigned char> m_image;
+  int m_image_width{0};
+  int m_image_height{0};
+
 public:
   TRASE_BACKEND_VISITABLE()
 
+  BackendGL() = default;
+  BackendGL(const BackendGL &) = delete;
+  BackendGL &operator=(const BackendGL &) = delete;
+  ~BackendGL();
+
   void init(int x_pixels, int y_pixels, const char *name);
   void finalise();
   vfloat2_t begin_frame();
   void end_frame();
 
-  inline bool is_interactive() { return true; }
+  /// render off-screen rather than in a window. This must be called before
+  /// init()
+  ///
+  /// Each figure drawn (e.g. with Figure::draw(backend, time)) is rendered
+  /// with NanoVG into a framebuffer object the size of the figure, using a
+  /// context that needs no window or display (see OffscreenContext). When the
+  /// figure is finished, finalise() reads the pixels back (see image()) and,
+  /// if \p filename is not empty, writes them to the PNG file \p filename. The
+  /// context is kept for the next figure until this backend is destroyed, so
+  /// offscreen() can be called again to render the next figure (or frame) to
+  /// another file
+  ///
+  /// \param filename the PNG file to write, or empty to only keep the image
+  void offscreen(const std::string &filename = "");
+
+  /// returns the last image rendered off-screen, with 4 bytes (RGBA) for each
+  /// pixel and the rows in order from the top of the image
+  const std::vector<unsigned char> &image() const { return m_image; }
+  int image_width() const { return m_image_width; }
+  int image_height() const { return m_image_height; }
+
+  inline bool is_interactive() { return !m_offscreen; }
 
   inline float get_time() { return ImGui::GetTime(); }
 
@@ -97,6 +152,10 @@ public:
 
   inline void reset_scissor() { nvgResetScissor(m_vg); }
 
+  // static layers are not cached, every frame is drawn from scratch
+  inline bool begin_layer(const std::string &) { return false; }
+  inline void end_layer() {}
+
   inline void rotate(const float angle) { nvgRotate(m_vg, angle); }
   inline void translate(const vfloat2_t &v) { nvgTranslate(m_vg, v[0], v[1]); }
   inline void reset_transform() { nvgResetTransform(m_vg); }
@@ -156,6 +215,21 @@ public:
     nvgText(m_vg, x[0], x[1], string, end);
   }
 
+  /// Starts a batch of strings that share the current font, alignment and
+  /// fill color (see BackendSVG::begin_text_batch()). NanoVG has no public
+  /// API for drawing several strings at once, so each string is still passed
+  /// to nvgText(), but the text state is only set once for the whole batch
+  inline void begin_text_batch() {}
+
+  /// Adds \p string at \p x to the current text batch
+  inline void add_text(const vfloat2_t &x, const char *string,
+                       const char *end) {
+    nvgText(m_vg, x[0], x[1], string, end);
+  }
+
+  /// Ends the current text batch
+  inline void end_text_batch() {}
+
   inline bfloat2_t text_bounds(const vfloat2_t &x, const char *string) {
     bfloat2_t ret;
     float bounds[4];
@@ -168,13 +242,20 @@ public:
   }
 
   inline bool should_close() {
-    return static_cast<bool>(glfwWindowShouldClose(m_window));
+#ifdef TRASE_GL_NO_WINDOW
+    return true;
+#else
+    // there is no window to close when rendering off-screen
+    return m_offscreen || static_cast<bool>(glfwWindowShouldClose(m_window));
+#endif
   }
 
 private:
   NVGcontext *init_nanovg(int x_pixels, int y_pixels);
   void init_imgui(GLFWwindow *window);
   GLFWwindow *create_window(int x_pixels, int y_pixels, const char *name);
+  void init_offscreen(int x_pixels, int y_pixels);
+  void finalise_offscreen();
 };
 
 } // namespace trase
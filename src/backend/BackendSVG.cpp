@@ -33,6 +33,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "backend/BackendSVG.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace trase {
 
 bool BackendSVG::mouseover() const noexcept {
@@ -42,6 +45,15 @@ bool BackendSVG::mouseover() const noexcept {
 
 void BackendSVG::init(const float width, const float height, const char *name,
                       const float time_span) noexcept {
+  if (m_embedded) {
+    // all the figures in a document share its animation timeline
+    m_time_span = std::max(time_span, m_document_time_span);
+    m_out << "<svg x=\"" << m_embed_origin[0] << "\" y=\"" << m_embed_origin[1]
+          << "\" width=\"" << width << "px\" height=\"" << height << "px\">\n";
+    m_out << "<desc>" << name << "</desc>\n";
+    return;
+  }
+
   m_time_span = time_span;
   m_out << R"del(<?xml version="1.0" encoding="utf-8" standalone="no"?>
 <!DOCTYPE svg PUBLIC "-//W3C//DTD SVG 1.1//EN"
@@ -49,7 +61,11 @@ void BackendSVG::init(const float width, const float height, const char *name,
 )del";
 
   m_out << "<svg width=\"" << width << "px\" height=\"" << height
-        << "px\" version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\">\n";
+        << "px\" version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\"";
+  if (m_detail_levels > 1) {
+    m_out << " viewBox=\"0 0 " << width << ' ' << height << '\"';
+  }
+  m_out << ">\n";
 
   m_out << "<desc>" << name << "</desc>\n";
 
@@ -58,7 +74,7 @@ void BackendSVG::init(const float width, const float height, const char *name,
                  "');</style>\n";
   }
   m_out << R"del(<script>
-function tooltip(x,y,string,size,face) {
+function tooltip(evt,x,y,string,size,face) {
     var txtElem = document.createElementNS("http://www.w3.org/2000/svg", "text");
     txtElem.setAttributeNS(null,"id","tooltip");
     txtElem.setAttributeNS(null,"x",x);
@@ -67,19 +83,132 @@ function tooltip(x,y,string,size,face) {
     txtElem.setAttributeNS(null,"font-family",face);
 
     txtElem.appendChild(document.createTextNode(string))
-    document.documentElement.appendChild(txtElem);
+    evt.target.ownerSVGElement.appendChild(txtElem);
 }
 function remove_tooltip() {
     var txtElem = document.getElementById("tooltip");
-    document.documentElement.removeChild(txtElem);
+    txtElem.parentNode.removeChild(txtElem);
 }
 </script>
 )del";
+
+  if (m_detail_levels > 1) {
+    // CDATA so that the comparisons in the script are not parsed as XML
+    m_out << "<script><![CDATA[\nvar trase_lod = {w: " << width << ", h: " << height
+          << ", levels: " << m_detail_levels << "};\n";
+    m_out << R"del((function(lod) {
+    var svg = document.documentElement;
+    var view = {x: 0, y: 0, w: lod.w, h: lod.h};
+    var level = 0;
+    var drag = null;
+    function update() {
+        svg.setAttribute("viewBox", view.x + " " + view.y + " " + view.w + " " + view.h);
+        var zoom = Math.log(lod.w / view.w) / Math.LN2;
+        var new_level = Math.max(0, Math.min(lod.levels - 1, Math.floor(zoom)));
+        if (new_level == level) return;
+        level = new_level;
+        var groups = svg.getElementsByClassName("trase-lod");
+        for (var i = 0; i < groups.length; ++i) {
+            var show = groups[i].getAttribute("data-level") == level;
+            groups[i].setAttribute("display", show ? "inline" : "none");
+        }
+    }
+    function to_view(evt) {
+        var r = svg.getBoundingClientRect();
+        return {x: view.x + (evt.clientX - r.left) / r.width * view.w,
+                y: view.y + (evt.clientY - r.top) / r.height * view.h};
+    }
+    svg.addEventListener("wheel", function(evt) {
+        evt.preventDefault();
+        var p = to_view(evt);
+        var s = Math.min(lod.w / view.w, evt.deltaY < 0 ? 1.0 / 1.25 : 1.25);
+        view = {x: p.x - (p.x - view.x) * s, y: p.y - (p.y - view.y) * s,
+                w: view.w * s, h: view.h * s};
+        update();
+    });
+    svg.addEventListener("mousedown", function(evt) { drag = to_view(evt); });
+    svg.addEventListener("mousemove", function(evt) {
+        if (!drag) return;
+        var p = to_view(evt);
+        view.x -= p.x - drag.x;
+        view.y -= p.y - drag.y;
+        update();
+    });
+    svg.addEventListener("mouseup", function() { drag = null; });
+    svg.addEventListener("dblclick", function() {
+        view = {x: 0, y: 0, w: lod.w, h: lod.h};
+        update();
+    });
+})(trase_lod);
+]]></script>
+)del";
+  }
+}
+
+void BackendSVG::level_of_detail(const int levels, const float cell_size) {
+  if (levels < 1 || cell_size <= 0.f) {
+    throw Exception("level of detail requires at least one level and a "
+                    "positive cell size");
+  }
+  m_detail_levels = levels;
+  m_detail_cell_size = cell_size;
+}
+
+float BackendSVG::detail_cell_size(const int level) const {
+  return std::ldexp(m_detail_cell_size, -level);
+}
+
+void BackendSVG::begin_detail_level(const int level) {
+  m_out << "<g class=\"trase-lod\" data-level=\"" << level << "\" display=\""
+        << (level == 0 ? "inline" : "none") << "\">\n";
 }
 
 void BackendSVG::finalise() noexcept {
   m_out << "</svg>\n";
-  m_out.flush();
+  if (!m_embedded) {
+    m_out.flush();
+  }
+}
+
+void BackendSVG::begin_document(const float width, const float height,
+                                const char *name,
+                                const float time_span) noexcept {
+  m_embedded = false;
+  init(width, height, name, time_span);
+  m_document_time_span = time_span;
+  m_embedded = true;
+}
+
+void BackendSVG::end_document() noexcept {
+  m_embedded = false;
+  m_document_time_span = 0.f;
+  finalise();
+}
+
+bool BackendSVG::begin_layer(const std::string &key) {
+  if (!m_layer_cache) {
+    return false;
+  }
+  std::string bytes;
+  if (m_layer_cache->find(key, bytes)) {
+    m_out << bytes;
+    return true;
+  }
+  m_layer_key = key;
+  m_layer_out.str("");
+  m_layer_buf = m_out.rdbuf(m_layer_out.rdbuf());
+  return false;
+}
+
+void BackendSVG::end_layer() {
+  if (m_layer_buf == nullptr) {
+    return;
+  }
+  m_out.rdbuf(m_layer_buf);
+  m_layer_buf = nullptr;
+  std::string bytes = m_layer_out.str();
+  m_out << bytes;
+  m_layer_cache->insert(m_layer_key, std::move(bytes));
 }
 
 void BackendSVG::rounded_rect(const bfloat2_t &x, const float r) noexcept {
@@ -146,9 +275,24 @@ void BackendSVG::add_animated_rect(const bfloat2_t &x, float time) {
     m_animate_values[2] += std::to_string(delta[0]) + ';';
     m_animate_values[3] += std::to_string(delta[1]) + ';';
   }
+  m_last_key_time = time;
+}
+
+void BackendSVG::hold_last_keyframe(const int values) {
+  if (m_last_key_time >= m_time_span) {
+    return;
+  }
+  m_animate_times += "1;";
+  for (int i = 0; i < values; ++i) {
+    std::string &v = m_animate_values[i];
+    const size_t last = v.find_last_of(";\"", v.size() - 2) + 1;
+    v += v.substr(last);
+  }
+  m_last_key_time = m_time_span;
 }
 
 void BackendSVG::end_animated_rect() {
+  hold_last_keyframe(4);
 
   m_animate_times.back() = '\"';
   for (int i = 0; i < 4; ++i) {
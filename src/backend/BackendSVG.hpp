@@ -37,12 +37,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define BACKENDSVG_H_
 
 #include "backend/Backend.hpp"
+#include "backend/LayerCache.hpp"
 #include "util/BBox.hpp"
 #include "util/Colors.hpp"
 #include "util/Exception.hpp"
 #include "util/Vector.hpp"
 
 #include <iomanip>
+#include <memory>
 #include <ostream>
 #include <sstream>
 
@@ -79,6 +81,8 @@ class BackendSVG : public AnimatedBackend {
   std::string m_font_face;
   std::string m_font_size;
   std::string m_font_align;
+  std::string m_font_anchor;
+  std::string m_font_baseline;
   std::string m_web_font;
   std::string m_onmouseover_stroke;
   std::string m_onmouseout_stroke;
@@ -90,10 +94,36 @@ class BackendSVG : public AnimatedBackend {
   std::string m_animate_times;
   float m_time_span;
   float m_old_time;
+
+  /// the time of the last keyframe added to the current animation
+  float m_last_key_time{0.f};
   std::string m_font_size_base;
   std::string m_font_face_base;
   TransformMatrix m_transform;
   AttributeFormatter m_att;
+  std::shared_ptr<LayerCache> m_layer_cache;
+  std::string m_layer_key;
+  std::ostringstream m_layer_out;
+  std::streambuf *m_layer_buf{nullptr};
+  int m_detail_levels{1};
+  float m_detail_cell_size{1.f};
+
+  /// true if init() writes a nested figure within a document (see
+  /// begin_document())
+  bool m_embedded{false};
+
+  /// the position of the next nested figure within the document
+  vfloat2_t m_embed_origin{0.f, 0.f};
+
+  /// the animation time span of the document, which can be longer than that
+  /// of a figure within it
+  float m_document_time_span{0.f};
+
+  /// true between begin_text_batch() and end_text_batch()
+  bool m_text_batch{false};
+
+  /// the number of strings added to the current text batch
+  int m_text_batch_size{0};
 
   /// Add the opening circle tag to m_out
   /// @param centre coordinates of the centre of the circle
@@ -127,6 +157,24 @@ public:
 
   void finalise() noexcept;
 
+  /// start a document that holds several figures (e.g. a dashboard), with a
+  /// total size of \p width by \p height pixels
+  ///
+  /// The document header, web font import and scripts are written once.
+  /// Until end_document() is called, each init() / finalise() pair (i.e. each
+  /// Figure drawn) writes a nested `<svg>` element at the position given by
+  /// embed_at(), and all the figures share one animation timeline of at least
+  /// \p time_span seconds
+  void begin_document(float width, float height, const char *name,
+                      float time_span = 0.f) noexcept;
+
+  /// sets the position of the next figure in the document, see
+  /// begin_document()
+  void embed_at(const vfloat2_t &origin) { m_embed_origin = origin; }
+
+  /// finish the document started with begin_document()
+  void end_document() noexcept;
+
   inline bool is_interactive() { return false; }
 
   inline vfloat2_t get_mouse_pos() { return vfloat2_t(0, 0); }
@@ -135,6 +183,50 @@ public:
 
   inline void reset_scissor() {}
 
+  /// use \p cache to store and reuse static layers (see begin_layer()). By
+  /// default no layers are cached
+  void layer_cache(std::shared_ptr<LayerCache> cache) {
+    m_layer_cache = std::move(cache);
+  }
+
+  /// start drawing a static layer, whose output is fully determined by \p key
+  ///
+  /// If the layer cache already holds a layer for \p key, its bytes are
+  /// written to the output and true is returned. The caller should then skip
+  /// drawing the layer (and not call end_layer()). Otherwise the output is
+  /// captured until end_layer() is called, and false is returned.
+  bool begin_layer(const std::string &key);
+
+  /// finish drawing a static layer, storing it in the layer cache
+  void end_layer();
+
+  /// enables the interactive level of detail mode, which must be set before
+  /// init() is called
+  ///
+  /// The figure can be zoomed with the mouse wheel and panned by dragging (a
+  /// double click resets the view). Dense, static plots are written at \p
+  /// levels levels of detail, each with four times the density of the one
+  /// before. Level 0 has at most one element per \p cell_size pixels, and the
+  /// final level at most one per \p cell_size / 2^(levels - 1) pixels, so the
+  /// size of the file depends on the levels rather than the number of
+  /// elements. Only the level matching the current zoom is displayed,
+  /// starting with level 0.
+  void level_of_detail(int levels, float cell_size = 1.f);
+
+  /// returns the number of levels of detail (1 unless level_of_detail() has
+  /// been called)
+  int detail_levels() const { return m_detail_levels; }
+
+  /// returns the grid cell size in pixels used to decimate the elements
+  /// written at level \p level
+  float detail_cell_size(int level) const;
+
+  /// start writing the elements displayed at level of detail \p level
+  void begin_detail_level(int level);
+
+  /// finish writing the elements of the current level of detail
+  void end_detail_level() { m_out << "</g>\n"; }
+
   inline void rotate(const float angle) { m_transform.rotate(angle); }
   inline void reset_transform() { m_transform.clear(); }
   inline void translate(const vfloat2_t &v) { m_transform.translate(v); }
@@ -143,6 +235,11 @@ public:
 
   bool mouseover() const noexcept;
 
+  /// repeats the last keyframe of the first \p values animated values at the
+  /// end of the time span, if it is earlier (e.g. for a figure that is shorter
+  /// than the document it is in), as SMIL needs keyTimes to end at 1
+  void hold_last_keyframe(int values);
+
   inline void begin_animated_path() {
     if (m_animate_values.empty()) {
       m_animate_values.resize(1);
@@ -165,11 +262,13 @@ public:
     // all times are scaled by total time span (all times start at 0)
     m_animate_times += std::to_string(time / m_time_span) + ';';
     m_animate_values[0] += m_path + ';';
+    m_last_key_time = time;
     m_path.clear();
   }
 
   inline void end_animated_path(const float time) {
     add_animated_path(time);
+    hold_last_keyframe(1);
     m_animate_times.back() = '\"';
     m_animate_values[0].back() = '\"';
     m_out << "<animate attributeName=\"d\" "
@@ -234,9 +333,11 @@ public:
       m_animate_values[1] += std::to_string(centre[1]) + ';';
       m_animate_values[2] += std::to_string(radius) + ';';
     }
+    m_last_key_time = time;
   }
 
   inline void end_animated_circle() {
+    hold_last_keyframe(3);
 
     m_animate_times.back() = '\"';
     for (int i = 0; i < 3; ++i) {
@@ -311,7 +412,7 @@ public:
   }
 
   inline void tooltip(const vfloat2_t &x, const char *string) {
-    m_onmouseover_tooltip = "tooltip(" + std::to_string(x[0]) + ',' +
+    m_onmouseover_tooltip = "tooltip(evt," + std::to_string(x[0]) + ',' +
                             std::to_string(x[1]) + ",'" + string + "'," +
                             m_font_size_base + ",'" + m_font_face_base + "');";
     m_onmouseout_tooltip = "remove_tooltip();";
@@ -392,8 +493,9 @@ public:
     } else if (align & ALIGN_BOTTOM) {
       vert_align_text = "baseline";
     }
-    m_font_align = "text-anchor=\"" + align_text + "\" alignment-baseline=\"" +
-                   vert_align_text + '\"';
+    m_font_anchor = "text-anchor=\"" + align_text + '\"';
+    m_font_baseline = "alignment-baseline=\"" + vert_align_text + '\"';
+    m_font_align = m_font_anchor + ' ' + m_font_baseline;
   }
 
   inline void text(const vfloat2_t &x, const char *string, const char *end) {
@@ -404,6 +506,46 @@ public:
     }
     m_out << '>' << string << "</text>\n";
   }
+
+  /// Starts a batch of strings that share the current font, alignment, fill
+  /// color and transform. Each string added with add_text() is written as a
+  /// positioned `<tspan>` within a single `<text>` element, rather than as a
+  /// `<text>` element of its own. Nothing else may be drawn until
+  /// end_text_batch() is called
+  inline void begin_text_batch() {
+    m_text_batch = true;
+    m_text_batch_size = 0;
+  }
+
+  /// Adds \p string at \p x to the current text batch, see begin_text_batch()
+  inline void add_text(const vfloat2_t &x, const char *string,
+                       const char *end) {
+    if (!m_text_batch) {
+      text(x, string, end);
+      return;
+    }
+    if (m_text_batch_size++ == 0) {
+      m_out << "<text " << m_font_face << ' ' << m_font_size << ' '
+            << m_font_anchor << ' ' << m_fill_color;
+      if (!m_transform.is_identity()) {
+        m_out << ' ' << m_transform.to_string();
+      }
+      m_out << '>';
+    }
+    // the baseline alignment is not inherited by a tspan, and there must be
+    // no whitespace between the tspans, which would be rendered as text
+    m_out << "<tspan x=\"" << x[0] << "\" y=\"" << x[1] << "\" "
+          << m_font_baseline << '>' << string << "</tspan>";
+  }
+
+  /// Ends the current text batch, see begin_text_batch()
+  inline void end_text_batch() {
+    if (m_text_batch_size > 0) {
+      m_out << "</text>\n";
+    }
+    m_text_batch = false;
+    m_text_batch_size = 0;
+  }
 };
 
 } // namespace trase
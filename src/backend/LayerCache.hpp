@@ -0,0 +1,88 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file LayerCache.hpp
+
+#ifndef LAYER_CACHE_H_
+#define LAYER_CACHE_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace trase {
+
+/// Stores the serialised output of static figure layers (e.g. the axis box,
+/// ticks and labels), keyed on the inputs used to draw them
+///
+/// A LayerCache can be shared between several backends (and threads), so that
+/// repeated exports of a figure only regenerate the layers that change.
+class LayerCache {
+  std::unordered_map<std::string, std::string> m_layers;
+  mutable std::mutex m_mutex;
+
+public:
+  /// copies the bytes stored for \p key into \p bytes and returns true, or
+  /// returns false if there is no layer stored for \p key
+  bool find(const std::string &key, std::string &bytes) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_layers.find(key);
+    if (i == m_layers.end()) {
+      return false;
+    }
+    bytes = i->second;
+    return true;
+  }
+
+  /// stores \p bytes for \p key, replacing any existing layer
+  void insert(const std::string &key, std::string bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layers[key] = std::move(bytes);
+  }
+
+  /// removes all stored layers
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layers.clear();
+  }
+
+  /// returns the number of stored layers
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_layers.size();
+  }
+};
+
+} // namespace trase
+
+#endif // LAYER_CACHE_H_
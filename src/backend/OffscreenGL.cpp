@@ -0,0 +1,212 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "backend/OffscreenGL.hpp"
+
+#include <vector>
+
+#if defined(TRASE_GL_OFFSCREEN_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#elif defined(TRASE_GL_OFFSCREEN_OSMESA)
+#include <GL/osmesa.h>
+#endif
+
+#include "util/Exception.hpp"
+
+namespace trase {
+
+#if defined(TRASE_GL_OFFSCREEN_EGL)
+
+struct OffscreenContext::Impl {
+  EGLDisplay display{EGL_NO_DISPLAY};
+  EGLSurface surface{EGL_NO_SURFACE};
+  EGLContext context{EGL_NO_CONTEXT};
+
+  ~Impl() {
+    if (display == EGL_NO_DISPLAY) {
+      return;
+    }
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != EGL_NO_CONTEXT) {
+      eglDestroyContext(display, context);
+    }
+    if (surface != EGL_NO_SURFACE) {
+      eglDestroySurface(display, surface);
+    }
+    eglTerminate(display);
+  }
+};
+
+OffscreenContext::OffscreenContext(const int width, const int height)
+    : m_impl(new Impl) {
+  Impl &impl = *m_impl;
+
+  // a surfaceless display needs no window system at all
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+  auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+      eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (get_platform_display != nullptr) {
+    impl.display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                        EGL_DEFAULT_DISPLAY, nullptr);
+  }
+#endif
+  if (impl.display == EGL_NO_DISPLAY) {
+    impl.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+  EGLint major, minor;
+  if (impl.display == EGL_NO_DISPLAY ||
+      !eglInitialize(impl.display, &major, &minor)) {
+    impl.display = EGL_NO_DISPLAY;
+    throw Exception("Could not initialise EGL display");
+  }
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    throw Exception("EGL does not support OpenGL");
+  }
+
+  const EGLint config_attribs[] = {EGL_SURFACE_TYPE,
+                                   EGL_PBUFFER_BIT,
+                                   EGL_RENDERABLE_TYPE,
+                                   EGL_OPENGL_BIT,
+                                   EGL_RED_SIZE,
+                                   8,
+                                   EGL_GREEN_SIZE,
+                                   8,
+                                   EGL_BLUE_SIZE,
+                                   8,
+                                   EGL_ALPHA_SIZE,
+                                   8,
+                                   EGL_STENCIL_SIZE,
+                                   8,
+                                   EGL_NONE};
+  EGLConfig config;
+  EGLint num_configs = 0;
+  if (!eglChooseConfig(impl.display, config_attribs, &config, 1,
+                       &num_configs) ||
+      num_configs < 1) {
+    throw Exception("Could not find an EGL config for OpenGL");
+  }
+
+  const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                    3,
+                                    EGL_CONTEXT_MINOR_VERSION,
+                                    2,
+                                    EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                    EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                    EGL_NONE};
+  impl.context =
+      eglCreateContext(impl.display, config, EGL_NO_CONTEXT, context_attribs);
+  if (impl.context == EGL_NO_CONTEXT) {
+    throw Exception("Could not create an OpenGL 3.2 EGL context");
+  }
+
+  // without EGL_KHR_surfaceless_context a pbuffer must be current
+  if (!eglMakeCurrent(impl.display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                      impl.context)) {
+    const EGLint pbuffer_attribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height,
+                                      EGL_NONE};
+    impl.surface =
+        eglCreatePbufferSurface(impl.display, config, pbuffer_attribs);
+    if (impl.surface == EGL_NO_SURFACE ||
+        !eglMakeCurrent(impl.display, impl.surface, impl.surface,
+                        impl.context)) {
+      throw Exception("Could not make the EGL context current");
+    }
+  }
+}
+
+void *OffscreenContext::get_proc_address(const char *name) {
+  return reinterpret_cast<void *>(eglGetProcAddress(name));
+}
+
+#elif defined(TRASE_GL_OFFSCREEN_OSMESA)
+
+struct OffscreenContext::Impl {
+  OSMesaContext context{nullptr};
+
+  // OSMesa renders the default framebuffer into this memory
+  std::vector<unsigned char> buffer;
+
+  ~Impl() {
+    if (context != nullptr) {
+      OSMesaDestroyContext(context);
+    }
+  }
+};
+
+OffscreenContext::OffscreenContext(const int width, const int height)
+    : m_impl(new Impl) {
+  Impl &impl = *m_impl;
+  const int attribs[] = {OSMESA_FORMAT,
+                         OSMESA_RGBA,
+                         OSMESA_DEPTH_BITS,
+                         24,
+                         OSMESA_STENCIL_BITS,
+                         8,
+                         OSMESA_PROFILE,
+                         OSMESA_CORE_PROFILE,
+                         OSMESA_CONTEXT_MAJOR_VERSION,
+                         3,
+                         OSMESA_CONTEXT_MINOR_VERSION,
+                         2,
+                         0};
+  impl.context = OSMesaCreateContextAttribs(attribs, nullptr);
+  if (impl.context == nullptr) {
+    throw Exception("Could not create an OpenGL 3.2 OSMesa context");
+  }
+  impl.buffer.resize(4 * static_cast<size_t>(width) * height);
+  if (!OSMesaMakeCurrent(impl.context, impl.buffer.data(), GL_UNSIGNED_BYTE,
+                         width, height)) {
+    throw Exception("Could not make the OSMesa context current");
+  }
+}
+
+void *OffscreenContext::get_proc_address(const char *name) {
+  return reinterpret_cast<void *>(OSMesaGetProcAddress(name));
+}
+
+#else
+
+struct OffscreenContext::Impl {};
+
+OffscreenContext::OffscreenContext(const int width, const int height) {
+  throw Exception("trase was built without off-screen OpenGL support");
+}
+
+void *OffscreenContext::get_proc_address(const char *name) { return nullptr; }
+
+#endif
+
+OffscreenContext::~OffscreenContext() = default;
+
+} // namespace trase
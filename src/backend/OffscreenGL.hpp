@@ -0,0 +1,73 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file OffscreenGL.hpp
+/// Creates an OpenGL context without a window or display
+
+#ifndef OFFSCREENGL_H_
+#define OFFSCREENGL_H_
+
+#include <memory>
+
+namespace trase {
+
+/// An OpenGL 3.2 core context that is not attached to a window, for rendering
+/// into framebuffer objects on machines without a display (e.g. with Mesa's
+/// llvmpipe software rasteriser)
+///
+/// The context is created with EGL (if trase is built with
+/// TRASE_GL_OFFSCREEN_EGL), preferring a surfaceless display and falling back
+/// to a pbuffer surface, or with OSMesa (TRASE_GL_OFFSCREEN_OSMESA). Otherwise
+/// the constructor throws
+class OffscreenContext {
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+
+public:
+  /// creates a context and makes it current on the calling thread. \p width
+  /// and \p height are the size of the default framebuffer, if the platform
+  /// needs one. Throws if no context can be created
+  OffscreenContext(int width, int height);
+  ~OffscreenContext();
+
+  OffscreenContext(const OffscreenContext &) = delete;
+  OffscreenContext &operator=(const OffscreenContext &) = delete;
+
+  /// returns the address of the OpenGL function \p name, for loading the
+  /// OpenGL functions with gladLoadGLLoader()
+  static void *get_proc_address(const char *name);
+};
+
+} // namespace trase
+
+#endif // OFFSCREENGL_H_
@@ -0,0 +1,285 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file trase.cpp
+
+#include "capi/trase.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trase.hpp"
+
+struct trase_figure {
+  std::shared_ptr<trase::Figure> figure;
+};
+
+namespace {
+
+using namespace trase;
+
+thread_local std::string last_error;
+
+/// thrown for a malformed argument, reported as TRASE_INVALID_ARGUMENT
+class InvalidArgument : public Exception {
+public:
+  explicit InvalidArgument(const std::string &arg) : Exception(arg) {}
+};
+
+/// runs f, converting any exception it throws into a status
+template <typename F> trase_status guard(F f) {
+  try {
+    last_error.clear();
+    f();
+    return TRASE_OK;
+  } catch (const InvalidArgument &e) {
+    last_error = e.what();
+    return TRASE_INVALID_ARGUMENT;
+  } catch (const std::exception &e) {
+    last_error = e.what();
+    return TRASE_ERROR;
+  } catch (...) {
+    last_error = "unknown error";
+    return TRASE_ERROR;
+  }
+}
+
+void check_not_null(const void *p, const char *name) {
+  if (p == nullptr) {
+    throw InvalidArgument(std::string(name) + " is null");
+  }
+}
+
+Axis *to_axis(trase_axis *axis) { return reinterpret_cast<Axis *>(axis); }
+Plot1D *to_plot(trase_plot *plot) { return reinterpret_cast<Plot1D *>(plot); }
+
+/// calls the release callback of a frame when destroyed
+class FrameRelease {
+  void (*m_release)(void *context);
+  void *m_context;
+
+public:
+  FrameRelease(void (*release)(void *context), void *context)
+      : m_release(release), m_context(context) {}
+  FrameRelease(const FrameRelease &) = delete;
+  FrameRelease &operator=(const FrameRelease &) = delete;
+  ~FrameRelease() { m_release(m_context); }
+};
+
+/// returns the stride of \p column in floats, checking that it is valid
+int column_stride(const trase_column &column, const char *name) {
+  if (column.stride == 0) {
+    return 1;
+  }
+  const auto size = static_cast<ptrdiff_t>(sizeof(float));
+  if (column.stride < 0 || column.stride % size != 0 ||
+      column.stride / size > INT_MAX) {
+    throw InvalidArgument(std::string(name) +
+                          " stride is not a positive multiple of the size "
+                          "of a float");
+  }
+  return static_cast<int>(column.stride / size);
+}
+
+/// converts \p frame into a dataset, which either copies or borrows its
+/// columns. The release callback is called when the returned dataset (and
+/// every copy of it) is destroyed, or before this returns if it throws
+DataWithAesthetic to_data(const trase_frame *frame) {
+  check_not_null(frame, "frame");
+  std::shared_ptr<const void> release;
+  if (frame->release != nullptr) {
+    release = std::make_shared<FrameRelease>(frame->release, frame->context);
+  }
+
+  check_not_null(frame->x.data, "x column");
+  check_not_null(frame->y.data, "y column");
+  if (frame->rows > static_cast<size_t>(INT_MAX)) {
+    throw InvalidArgument("too many rows");
+  }
+  const int rows = static_cast<int>(frame->rows);
+
+  const std::pair<const trase_column *, int> columns[] = {
+      {&frame->x, Aesthetic::x::index},
+      {&frame->y, Aesthetic::y::index},
+      {&frame->color, Aesthetic::color::index},
+      {&frame->size, Aesthetic::size::index}};
+
+  std::vector<ColumnView> views;
+  std::vector<int> aesthetics;
+  for (const auto &c : columns) {
+    if (c.first->data != nullptr) {
+      const char *name = aesthetic_name(c.second);
+      const int stride = column_stride(*c.first, name);
+      if (static_cast<long long>(rows) * stride > INT_MAX) {
+        throw InvalidArgument(std::string(name) + " column is too long");
+      }
+      views.push_back({c.first->data, stride});
+      aesthetics.push_back(c.second);
+    }
+  }
+
+  std::shared_ptr<RawData> raw;
+  if (frame->ownership == TRASE_BORROW) {
+    raw = std::make_shared<RawData>(rows, views, release);
+  } else if (frame->ownership == TRASE_COPY) {
+    raw = std::make_shared<RawData>();
+    for (const auto &view : views) {
+      const ColumnIterator begin(view.data, view.stride);
+      raw->add_column(std::vector<float>(begin, begin + rows));
+    }
+  } else {
+    throw InvalidArgument("unknown ownership");
+  }
+
+  DataWithAesthetic data(raw);
+  for (size_t i = 0; i < aesthetics.size(); ++i) {
+    data.map(aesthetics[i], static_cast<int>(i));
+  }
+  return data;
+}
+
+/// a stream buffer that writes into a fixed size array, and counts the
+/// characters that do not fit
+class ArrayBuffer : public std::streambuf {
+  char *m_array;
+  size_t m_capacity;
+  size_t m_length{0};
+
+public:
+  ArrayBuffer(char *array, size_t capacity)
+      : m_array(array), m_capacity(capacity) {}
+
+  /// the number of characters written, including those that did not fit
+  size_t length() const { return m_length; }
+
+protected:
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    const auto count = static_cast<size_t>(n);
+    if (m_length < m_capacity) {
+      std::memcpy(m_array + m_length, s,
+                  std::min(count, m_capacity - m_length));
+    }
+    m_length += count;
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      const char ch = traits_type::to_char_type(c);
+      xsputn(&ch, 1);
+    }
+    return traits_type::not_eof(c);
+  }
+};
+
+} // namespace
+
+extern "C" {
+
+const char *trase_last_error(void) { return last_error.c_str(); }
+
+trase_status trase_figure_new(float width, float height,
+                              trase_figure **figure) {
+  return guard([&]() {
+    check_not_null(figure, "figure");
+    *figure = nullptr;
+    if (!(width > 0 && height > 0)) {
+      throw InvalidArgument("figure size must be positive");
+    }
+    *figure = new trase_figure{trase::figure({{width, height}})};
+  });
+}
+
+void trase_figure_free(trase_figure *figure) { delete figure; }
+
+trase_status trase_figure_axis(trase_figure *figure, trase_axis **axis) {
+  return guard([&]() {
+    check_not_null(figure, "figure");
+    check_not_null(axis, "axis");
+    *axis = reinterpret_cast<trase_axis *>(figure->figure->axis().get());
+  });
+}
+
+trase_status trase_axis_points(trase_axis *axis, const trase_frame *frame,
+                               trase_plot **plot) {
+  return guard([&]() {
+    DataWithAesthetic data = to_data(frame);
+    check_not_null(plot, "plot");
+    *plot = nullptr;
+    check_not_null(axis, "axis");
+    *plot = reinterpret_cast<trase_plot *>(to_axis(axis)->points(data).get());
+  });
+}
+
+trase_status trase_plot_add_frame(trase_plot *plot, const trase_frame *frame,
+                                  float time) {
+  return guard([&]() {
+    DataWithAesthetic data = to_data(frame);
+    check_not_null(plot, "plot");
+    to_plot(plot)->add_frame(data, time);
+  });
+}
+
+trase_status trase_render_svg(trase_figure *figure, char *buffer,
+                              size_t capacity, size_t *length) {
+  trase_status status = guard([&]() {
+    check_not_null(figure, "figure");
+    check_not_null(length, "length");
+    if (buffer == nullptr && capacity != 0) {
+      throw InvalidArgument("buffer is null");
+    }
+    ArrayBuffer array(buffer, capacity);
+    std::ostream out(&array);
+    BackendSVG backend(out);
+    figure->figure->draw(backend);
+    out.flush();
+    *length = array.length();
+  });
+  if (status == TRASE_OK) {
+    if (*length >= capacity) {
+      last_error = "buffer is too small";
+      return TRASE_BUFFER_TOO_SMALL;
+    }
+    buffer[*length] = '\0';
+  }
+  return status;
+}
+
+} // extern "C"
@@ -0,0 +1,112 @@
+/// \file trase.h
+/// A C interface to trase, for plotting from other languages
+///
+/// Figures, axes and plots are opaque handles. Axes and plots belong to the
+/// figure they were created in, and are valid until that figure is freed with
+/// trase_figure_free(). Every function that can fail returns a trase_status,
+/// and trase_last_error() describes the failure. No C++ exception ever escapes
+/// this interface.
+///
+/// Data is passed to trase as columns of floats, each with its own stride, so
+/// a column can be a field of an array of structs or a strided slice of a
+/// larger array. The frame's ownership decides whether trase copies the
+/// columns or borrows them (see trase_frame).
+
+#ifndef TRASE_C_H_
+#define TRASE_C_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct trase_figure trase_figure;
+typedef struct trase_axis trase_axis;
+typedef struct trase_plot trase_plot;
+
+typedef enum trase_status {
+  /// the call succeeded
+  TRASE_OK = 0,
+  /// an argument was null, or a frame was malformed
+  TRASE_INVALID_ARGUMENT = 1,
+  /// the output buffer is too small, nothing else went wrong
+  TRASE_BUFFER_TOO_SMALL = 2,
+  /// any other failure, see trase_last_error()
+  TRASE_ERROR = 3
+} trase_status;
+
+typedef enum trase_ownership {
+  /// trase reads the columns in place every time the figure is drawn. They
+  /// must stay alive and unmodified until release is called or, if there is no
+  /// release callback, until the figure is freed
+  TRASE_BORROW = 0,
+  /// trase copies the columns before the call returns
+  TRASE_COPY = 1
+} trase_ownership;
+
+/// A column of rows floats
+typedef struct trase_column {
+  /// the first element, or null if the column is not used
+  const float *data;
+  /// the distance in bytes between consecutive elements (0 means
+  /// sizeof(float)). Must be a positive multiple of sizeof(float)
+  ptrdiff_t stride;
+} trase_column;
+
+/// A data frame, with a column for each aesthetic. The x and y columns are
+/// required, color and size are optional
+typedef struct trase_frame {
+  size_t rows;
+  trase_column x;
+  trase_column y;
+  trase_column color;
+  trase_column size;
+  trase_ownership ownership;
+  /// if not null, called with context exactly once when trase no longer reads
+  /// the columns: before returning for a copied frame or a failed call, or
+  /// when the last plot using a borrowed frame is destroyed (which may be on
+  /// another thread)
+  void (*release)(void *context);
+  void *context;
+} trase_frame;
+
+/// returns a description of why the last call on the calling thread failed, or
+/// an empty string if it succeeded. The string is valid until the next call on
+/// this thread
+const char *trase_last_error(void);
+
+/// creates a new figure of width x height pixels in *figure
+trase_status trase_figure_new(float width, float height, trase_figure **figure);
+
+/// frees a figure together with its axes and plots. Does nothing if figure is
+/// null
+void trase_figure_free(trase_figure *figure);
+
+/// creates a new axis in figure and returns it in *axis
+trase_status trase_figure_axis(trase_figure *figure, trase_axis **axis);
+
+/// creates a new points plot in axis with frame as its first frame (at time
+/// 0), and returns it in *plot
+trase_status trase_axis_points(trase_axis *axis, const trase_frame *frame,
+                               trase_plot **plot);
+
+/// adds frame to plot at the given time, which must not be less than the
+/// time of its previous frame
+trase_status trase_plot_add_frame(trase_plot *plot, const trase_frame *frame,
+                                  float time);
+
+/// draws figure as an animated svg document into buffer, followed by a null
+/// terminator, and sets *length to the length of the document
+///
+/// If the document and terminator do not fit in capacity bytes this returns
+/// TRASE_BUFFER_TOO_SMALL, and the contents of buffer are unspecified. Call
+/// with a null buffer and zero capacity to find the size of buffer needed.
+trase_status trase_render_svg(trase_figure *figure, char *buffer,
+                              size_t capacity, size_t *length);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // TRASE_C_H_
@@ -0,0 +1,143 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "frontend/Align.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace trase {
+
+namespace {
+
+bool has_ids(const DataWithAesthetic &data) {
+  return data.column(Aesthetic::id::index) != -1;
+}
+
+} // namespace
+
+FrameAlignment align_frames(const DataWithAesthetic &previous,
+                            const DataWithAesthetic &next) {
+  FrameAlignment ret;
+  if (!has_ids(previous) || !has_ids(next)) {
+    const int n = std::min(previous.rows(), next.rows());
+    ret.matched.reserve(n);
+    for (int i = 0; i < n; ++i) {
+      ret.matched.emplace_back(i, i);
+    }
+    for (int i = n; i < next.rows(); ++i) {
+      ret.entered.push_back(i);
+    }
+    for (int i = n; i < previous.rows(); ++i) {
+      ret.exited.push_back(i);
+    }
+    return ret;
+  }
+
+  // the row of each id in the previous frame, set to -1 once the id is seen
+  // in the next frame
+  std::unordered_map<float, int> rows(previous.rows());
+  previous.visit<Aesthetic::id>([&](const auto id) {
+    for (int i = 0; i < previous.rows(); ++i) {
+      if (std::isnan(id[i])) {
+        throw Exception("id is NaN");
+      }
+      if (!rows.emplace(id[i], i).second) {
+        throw Exception("id is repeated within a frame");
+      }
+    }
+  });
+
+  ret.matched.reserve(std::min(previous.rows(), next.rows()));
+  next.visit<Aesthetic::id>([&](const auto id) {
+    for (int i = 0; i < next.rows(); ++i) {
+      if (std::isnan(id[i])) {
+        throw Exception("id is NaN");
+      }
+      auto search = rows.find(id[i]);
+      if (search == rows.end()) {
+        ret.entered.push_back(i);
+        rows.emplace(id[i], -1);
+      } else if (search->second == -1) {
+        throw Exception("id is repeated within a frame");
+      } else {
+        ret.matched.emplace_back(search->second, i);
+        search->second = -1;
+      }
+    }
+  });
+
+  previous.visit<Aesthetic::id>([&](const auto id) {
+    for (int i = 0; i < previous.rows(); ++i) {
+      if (rows[id[i]] != -1) {
+        ret.exited.push_back(i);
+      }
+    }
+  });
+  return ret;
+}
+
+std::vector<FrameTrack>
+frame_tracks(const std::vector<DataWithAesthetic> &frames) {
+  std::vector<FrameTrack> tracks;
+  if (frames.empty()) {
+    return tracks;
+  }
+
+  // the track of each row of the previous frame
+  std::vector<int> track_of_row(frames[0].rows());
+  for (int i = 0; i < frames[0].rows(); ++i) {
+    track_of_row[i] = static_cast<int>(tracks.size());
+    tracks.push_back({0, {i}});
+  }
+
+  std::vector<int> next_track_of_row;
+  for (size_t f = 1; f < frames.size(); ++f) {
+    const auto alignment = align_frames(frames[f - 1], frames[f]);
+    next_track_of_row.assign(frames[f].rows(), -1);
+    for (const auto &m : alignment.matched) {
+      const int t = track_of_row[m.first];
+      tracks[t].rows.push_back(m.second);
+      next_track_of_row[m.second] = t;
+    }
+    for (const int i : alignment.entered) {
+      next_track_of_row[i] = static_cast<int>(tracks.size());
+      tracks.push_back({static_cast<int>(f), {i}});
+    }
+    track_of_row.swap(next_track_of_row);
+  }
+  return tracks;
+}
+
+} // namespace trase
@@ -0,0 +1,88 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Align.hpp
+/// Matching of the rows of consecutive animation frames
+
+#ifndef ALIGN_H_
+#define ALIGN_H_
+
+#include <utility>
+#include <vector>
+
+#include "frontend/Data.hpp"
+
+namespace trase {
+
+/// The rows of two frames, matched using their id aesthetic
+struct FrameAlignment {
+  /// pairs of rows {previous, next} with the same id
+  std::vector<std::pair<int, int>> matched;
+
+  /// the rows of the next frame whose id is not in the previous frame
+  std::vector<int> entered;
+
+  /// the rows of the previous frame whose id is not in the next frame
+  std::vector<int> exited;
+};
+
+/// matches the rows of \p previous and \p next that have the same id, using a
+/// hash table so the cost is linear in the number of rows
+///
+/// If either frame has no id aesthetic the rows are matched by their index
+/// instead, and the extra rows of the longer frame are entered or exited. The
+/// matched and entered rows are in the order of \p next, the exited rows in
+/// the order of \p previous. Throws if an id is repeated within a frame, or
+/// is NaN (which never compares equal, so could not be matched).
+FrameAlignment align_frames(const DataWithAesthetic &previous,
+                            const DataWithAesthetic &next);
+
+/// A single element (e.g. particle) followed through a sequence of frames
+struct FrameTrack {
+  /// the first frame that contains this element
+  int first_frame;
+
+  /// the row of this element in each frame from first_frame, until the frame
+  /// before it exits
+  std::vector<int> rows;
+};
+
+/// aligns each pair of consecutive \p frames, and returns the track of every
+/// element. An element that exits and later re-enters has a separate track
+/// for each interval in which it is present
+std::vector<FrameTrack>
+frame_tracks(const std::vector<DataWithAesthetic> &frames);
+
+} // namespace trase
+
+#endif // ALIGN_H_
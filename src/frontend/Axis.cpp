@@ -31,6 +31,8 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <sstream>
+
 #include "frontend/Axis.hpp"
 #include "frontend/Histogram.hpp"
 #include "frontend/Line.hpp"
@@ -53,7 +55,11 @@ std::shared_ptr<Plot1D> Axis::plot_impl(const std::shared_ptr<Plot1D> &plot,
                                         const Transform &transform,
                                         const DataWithAesthetic &values) {
   plot->set_transform(transform);
-  plot->add_frame(values, 0);
+  if (values.column(Aesthetic::time::index) != -1) {
+    plot->add_frames(values);
+  } else {
+    plot->add_frame(values, 0);
+  }
   plot->set_color(RGBA::defaults[m_children.size()]);
   plot->resize(m_pixels);
   m_children.push_back(plot);
@@ -122,6 +128,47 @@ void Axis::update_tick_information() {
   }
 }
 
+std::string Axis::layer_key() const {
+  std::ostringstream key;
+
+  // floats are written exactly, strings are prefixed with their length
+  key << std::hexfloat;
+  const auto write_string = [&key](const std::string &s) {
+    key << s.size() << ':' << s << ' ';
+  };
+  const auto write_floats = [&key](const std::vector<float> &v) {
+    key << v.size() << ':';
+    for (const float f : v) {
+      key << f << ' ';
+    }
+  };
+
+  key << m_pixels.bmin[0] << ' ' << m_pixels.bmin[1] << ' '
+      << m_pixels.bmax[0] << ' ' << m_pixels.bmax[1] << ' ';
+  write_floats(m_tick_info.x_val);
+  write_floats(m_tick_info.x_pos);
+  write_floats(m_tick_info.y_val);
+  write_floats(m_tick_info.y_pos);
+  key << m_sig_digits << ' ' << m_tick_len << ' ' << m_line_width << ' '
+      << m_font_size << ' ';
+  write_string(m_font_face);
+  write_string(m_title);
+  write_string(m_xlabel);
+  write_string(m_ylabel);
+
+  key << m_legend << ' ';
+  if (m_legend) {
+    for (const auto &drawable : m_children) {
+      auto plot1d = std::dynamic_pointer_cast<Plot1D>(drawable);
+      const RGBA &color = plot1d->get_color();
+      key << color.r() << ' ' << color.g() << ' ' << color.b() << ' '
+          << color.a() << ' ';
+      write_string(plot1d->get_label());
+    }
+  }
+  return key.str();
+}
+
 vfloat2_t Axis::calculate_num_ticks() {
 
   if (m_nx_ticks > 0 && m_ny_ticks > 0) {
@@ -80,6 +80,8 @@ struct TickInfo {
 ///     * a label for the y axis
 ///     * a legend that identifies each Plot1D
 class Axis : public Drawable {
+  friend class SceneIO;
+
   /// limits of all children plots
   Limits m_limits;
 
@@ -128,6 +130,10 @@ public:
 
   TRASE_DISPATCH_BACKENDS
 
+  std::shared_ptr<Drawable> clone(Drawable *parent) const override {
+    return clone_as<Axis>(parent);
+  }
+
   /// returns the current Aesthetic limits
   const Limits &limits() const { return m_limits; }
 
@@ -155,6 +161,10 @@ public:
   /// set the title of the Axis
   void title(const char *string) { m_title.assign(string); }
 
+  const std::string &get_xlabel() const { return m_xlabel; }
+  const std::string &get_ylabel() const { return m_ylabel; }
+  const std::string &get_title() const { return m_title; }
+
   /// show a legend identifying each Plot1D in the Axis
   void legend() { m_legend = true; }
 
@@ -172,7 +182,8 @@ public:
                                const std::vector<T2> &y);
 
   /// Create a new Points plot and return a shared pointer to it.
-  /// \param data the `DataWithAesthetic` dataset to use
+  /// \param data the `DataWithAesthetic` dataset to use, if this has a time
+  /// aesthetic it is split into frames (see Plot1D::add_frames())
   /// \param transform (optional) the transform to apply
   /// \return shared pointer to the new plot
   std::shared_ptr<Plot1D>
@@ -180,7 +191,8 @@ public:
          const Transform &transform = Transform(Identity()));
 
   /// Create a new Line and return a shared pointer to it.
-  /// \param data the `DataWithAesthetic` dataset to use
+  /// \param data the `DataWithAesthetic` dataset to use, if this has a time
+  /// aesthetic it is split into frames (see Plot1D::add_frames())
   /// \param transform (optional) the transform to apply
   /// \return shared pointer to the new plot
   std::shared_ptr<Plot1D>
@@ -188,7 +200,8 @@ public:
        const Transform &transform = Transform(Identity()));
 
   /// Create a new histogram and return a shared pointer to it.
-  /// \param data the `DataWithAesthetic` dataset to use
+  /// \param data the `DataWithAesthetic` dataset to use, if this has a time
+  /// aesthetic it is split into frames (see Plot1D::add_frames())
   /// \param transform (optional) the transform to apply
   /// \return shared pointer to the new plot
   std::shared_ptr<Plot1D>
@@ -201,6 +214,9 @@ public:
   /// \return a shared pointer to the nth plot
   std::shared_ptr<Plot1D> plot(int n);
 
+  /// Return the number of plots in this axis
+  int number_of_plots() const { return static_cast<int>(m_children.size()); }
+
   template <typename AnimatedBackend> void draw(AnimatedBackend &backend);
   template <typename Backend> void draw(Backend &backend, float time);
 
@@ -248,7 +264,12 @@ private:
   void update_tick_information();
   vfloat2_t calculate_num_ticks();
 
+  /// returns a key that uniquely identifies the output of draw_common(), given
+  /// the current tick information
+  std::string layer_key() const;
+
   template <typename Backend> void draw_common(Backend &backend);
+  template <typename Backend> void draw_common_state(Backend &backend);
   template <typename Backend> void draw_common_axis_box(Backend &backend);
   template <typename Backend> void draw_common_ticks(Backend &backend);
   template <typename Backend> void draw_common_gridlines(Backend &backend);
@@ -52,12 +52,25 @@ std::shared_ptr<Plot1D> Axis::plot(const std::vector<T1> &x,
 
 template <typename Backend>
 void Axis::draw(Backend &backend, const float time) {
+  // transform the frames of lazy plots that are drawn at this time, so that
+  // their limits are included in the ticks
+  for (const auto &child : m_children) {
+    if (auto plot = std::dynamic_pointer_cast<Plot1D>(child)) {
+      plot->transform_frames(time);
+    }
+  }
   draw_common(backend);
   // make sure all child elements are cut to the axis pixel limits
   backend.scissor(m_pixels);
 }
 
 template <typename AnimatedBackend> void Axis::draw(AnimatedBackend &backend) {
+  // every frame is drawn
+  for (const auto &child : m_children) {
+    if (auto plot = std::dynamic_pointer_cast<Plot1D>(child)) {
+      plot->transform_frames();
+    }
+  }
   draw_common(backend);
   // make sure all child elements are cut to the axis pixel limits
   backend.scissor(m_pixels);
@@ -66,6 +79,13 @@ template <typename AnimatedBackend> void Axis::draw(AnimatedBackend &backend) {
 template <typename Backend> void Axis::draw_common(Backend &backend) {
   update_tick_information();
 
+  // the static layer only depends on the layout of the axis, so the backend
+  // can reuse its output from a previous draw
+  if (backend.begin_layer(layer_key())) {
+    draw_common_state(backend);
+    return;
+  }
+
   draw_common_axis_box(backend);
   draw_common_ticks(backend);
   draw_common_gridlines(backend);
@@ -73,6 +93,41 @@ template <typename Backend> void Axis::draw_common(Backend &backend) {
   draw_common_xlabel(backend);
   draw_common_ylabel(backend);
   draw_common_legend(backend);
+
+  backend.end_layer();
+}
+
+template <typename Backend> void Axis::draw_common_state(Backend &backend) {
+  // leave the backend in the same state as the draw_common_* functions above,
+  // as the child plots inherit the font and (for some) the stroke settings
+  backend.font_size(m_font_size);
+  backend.font_blur(0.0f);
+  backend.font_face(m_font_face.c_str());
+  backend.fill_color(RGBA(0, 0, 0, 255));
+
+  auto align = ALIGN_RIGHT | ALIGN_MIDDLE;
+  if (!m_title.empty()) {
+    align = ALIGN_CENTER | ALIGN_BOTTOM;
+  }
+  if (!m_xlabel.empty()) {
+    align = ALIGN_CENTER | ALIGN_TOP;
+  }
+  if (!m_ylabel.empty()) {
+    align = ALIGN_CENTER | ALIGN_BOTTOM;
+  }
+  if (m_legend) {
+    align = ALIGN_RIGHT | ALIGN_TOP;
+  }
+  backend.text_align(align);
+
+  if (m_legend && !m_children.empty()) {
+    auto plot1d = std::dynamic_pointer_cast<Plot1D>(m_children.back());
+    backend.stroke_width(m_line_width);
+    backend.stroke_color(plot1d->get_color());
+  } else {
+    backend.stroke_width(m_legend ? m_line_width : m_line_width / 2.f);
+    backend.stroke_color(RGBA(255, 255, 255, 255));
+  }
 }
 
 template <typename Backend> void Axis::draw_common_axis_box(Backend &backend) {
@@ -93,7 +148,8 @@ template <typename Backend> void Axis::draw_common_ticks(Backend &backend) {
   backend.text_align(ALIGN_CENTER | ALIGN_TOP);
   backend.fill_color(RGBA(0, 0, 0, 255));
 
-  // x ticks
+  // x ticks, the labels share a style so are drawn as one batch
+  backend.begin_text_batch();
   for (std::size_t i = 0; i < m_tick_info.x_pos.size(); ++i) {
     const float pos = m_tick_info.x_pos[i];
     const float val = m_tick_info.x_val[i];
@@ -101,13 +157,15 @@ template <typename Backend> void Axis::draw_common_ticks(Backend &backend) {
     backend.move_to(vfloat2_t(pos, m_pixels.bmax[1] + m_tick_len / 2));
     backend.line_to(vfloat2_t(pos, m_pixels.bmax[1]));
     std::snprintf(buffer, sizeof(buffer), "%.*g", m_sig_digits + 1, val);
-    backend.text(vfloat2_t(pos, m_pixels.bmax[1] + m_tick_len / 2), buffer,
-                 NULL);
+    backend.add_text(vfloat2_t(pos, m_pixels.bmax[1] + m_tick_len / 2),
+                     buffer, NULL);
   }
+  backend.end_text_batch();
 
   backend.text_align(ALIGN_RIGHT | ALIGN_MIDDLE);
 
   // y ticks
+  backend.begin_text_batch();
   for (std::size_t i = 0; i < m_tick_info.y_pos.size(); ++i) {
     const float pos = m_tick_info.y_pos[i];
     const float val = m_tick_info.y_val[i];
@@ -115,9 +173,10 @@ template <typename Backend> void Axis::draw_common_ticks(Backend &backend) {
     backend.move_to(vfloat2_t(m_pixels.bmin[0] - m_tick_len / 2, pos));
     backend.line_to(vfloat2_t(m_pixels.bmin[0], pos));
     std::snprintf(buffer, sizeof(buffer), "%.*g", m_sig_digits + 1, val);
-    backend.text(vfloat2_t(m_pixels.bmin[0] - m_tick_len / 2, pos), buffer,
-                 NULL);
+    backend.add_text(vfloat2_t(m_pixels.bmin[0] - m_tick_len / 2, pos),
+                     buffer, NULL);
   }
+  backend.end_text_batch();
 
   backend.stroke_color(RGBA(0, 0, 0, 255));
   backend.stroke_width(m_line_width / 2);
@@ -210,10 +269,20 @@ template <typename Backend> void Axis::draw_common_legend(Backend &backend) {
                     vfloat2_t(-(4.f / 3.f) * sample_length, m_font_size / 2.f));
     backend.stroke_color(plot1d->get_color());
     backend.stroke();
-    backend.text(text_loc + vfloat2_t(-(5.f / 3.f) * sample_length, 0.f),
-                 plot1d->get_label().c_str(), nullptr);
     text_loc[1] += m_font_size;
   }
+
+  // the labels are drawn after the samples, as nothing else can be drawn
+  // during a text batch
+  text_loc = upper_right_corner;
+  backend.begin_text_batch();
+  for (const auto &drawable : m_children) {
+    auto plot1d = std::dynamic_pointer_cast<Plot1D>(drawable);
+    backend.add_text(text_loc + vfloat2_t(-(5.f / 3.f) * sample_length, 0.f),
+                     plot1d->get_label().c_str(), nullptr);
+    text_loc[1] += m_font_size;
+  }
+  backend.end_text_batch();
 }
 
 } // namespace trase
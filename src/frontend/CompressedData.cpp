@@ -0,0 +1,203 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file CompressedData.cpp
+
+#include "frontend/CompressedData.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "util/Compression.hpp"
+#include "util/Exception.hpp"
+
+namespace trase {
+
+CompressedData::CompressedData(const int block_rows)
+    : m_block_rows(block_rows) {
+  if (block_rows <= 0) {
+    throw Exception("block size must be positive");
+  }
+}
+
+void CompressedData::append(const DataWithAesthetic &data) {
+  const int rows = data.rows();
+  if (rows == 0) {
+    return;
+  }
+  std::vector<int> aesthetics;
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    if (data.column(a) != -1) {
+      aesthetics.push_back(a);
+    }
+  }
+  if (aesthetics.empty()) {
+    throw Exception("rows to compress have no aesthetics");
+  }
+  if (m_rows == 0) {
+    m_aesthetics = aesthetics;
+  } else if (aesthetics != m_aesthetics) {
+    throw Exception("appended rows must have the same aesthetics");
+  }
+
+  // the rows are gathered into m_pending a block at a time, and each block is
+  // compressed as soon as it is full, so however many rows are appended at
+  // once m_pending never holds more than one block
+  const size_t cols = m_aesthetics.size();
+  const size_t block_values = static_cast<size_t>(m_block_rows) * cols;
+  for (int first = 0; first < rows;) {
+    const size_t old_size = m_pending.size();
+    const int n = std::min(rows - first,
+                           m_block_rows - static_cast<int>(old_size / cols));
+    m_pending.resize(old_size + static_cast<size_t>(n) * cols);
+    for (size_t k = 0; k < cols; ++k) {
+      data.visit_columns(
+          [&](const auto begin) {
+            auto value = begin + first;
+            for (int i = 0; i < n; ++i, ++value) {
+              m_pending[old_size + i * cols + k] = *value;
+            }
+          },
+          data.column(m_aesthetics[k]));
+    }
+    first += n;
+
+    if (m_pending.size() == block_values) {
+      std::vector<uint8_t> bytes;
+      for (size_t k = 0; k < cols; ++k) {
+        compress_column(&m_pending[k], m_block_rows, static_cast<int>(cols),
+                        bytes);
+      }
+      bytes.shrink_to_fit();
+      m_blocks.push_back(std::move(bytes));
+      m_pending.clear();
+    }
+  }
+  for (const int a : m_aesthetics) {
+    m_limits.bmin[a] = std::min(m_limits.bmin[a], data.limits().bmin[a]);
+    m_limits.bmax[a] = std::max(m_limits.bmax[a], data.limits().bmax[a]);
+  }
+  m_rows += rows;
+}
+
+int CompressedData::blocks() const {
+  return static_cast<int>(m_blocks.size()) + (m_pending.empty() ? 0 : 1);
+}
+
+size_t CompressedData::bytes() const {
+  size_t n = m_pending.capacity() * sizeof(float);
+  for (const auto &block : m_blocks) {
+    n += block.capacity() + sizeof(block);
+  }
+  return n;
+}
+
+int CompressedData::decompress_block(const int i,
+                                     std::vector<float> &matrix) const {
+  if (i < 0 || i >= blocks()) {
+    throw std::out_of_range("block does not exist");
+  }
+  const size_t cols = m_aesthetics.size();
+  if (i == static_cast<int>(m_blocks.size())) {
+    const int rows = static_cast<int>(m_pending.size() / cols);
+    matrix.resize(m_pending.size());
+    for (size_t k = 0; k < cols; ++k) {
+      for (int r = 0; r < rows; ++r) {
+        matrix[k * rows + r] = m_pending[r * cols + k];
+      }
+    }
+    return rows;
+  }
+
+  const auto &bytes = m_blocks[i];
+  matrix.resize(static_cast<size_t>(m_block_rows) * cols);
+  size_t pos = 0;
+  for (size_t k = 0; k < cols; ++k) {
+    pos += decompress_column(bytes.data() + pos, bytes.size() - pos,
+                             m_block_rows, &matrix[k * m_block_rows], 1);
+  }
+  return m_block_rows;
+}
+
+DataWithAesthetic CompressedData::decompress() const {
+  if (m_rows == 0) {
+    return DataWithAesthetic();
+  }
+  const size_t cols = m_aesthetics.size();
+  std::vector<float> matrix(static_cast<size_t>(m_rows) * cols);
+  float *row = matrix.data();
+  for (const auto &bytes : m_blocks) {
+    size_t pos = 0;
+    for (size_t k = 0; k < cols; ++k) {
+      pos += decompress_column(bytes.data() + pos, bytes.size() - pos,
+                               m_block_rows, row + k, static_cast<int>(cols));
+    }
+    row += static_cast<size_t>(m_block_rows) * cols;
+  }
+  std::copy(m_pending.begin(), m_pending.end(), row);
+
+  DataWithAesthetic result(
+      std::make_shared<RawData>(static_cast<int>(cols), std::move(matrix)));
+  for (size_t k = 0; k < cols; ++k) {
+    result.map(m_aesthetics[k], static_cast<int>(k));
+  }
+  return result;
+}
+
+bool CompressedSource::next(DataWithAesthetic &block) {
+  if (m_next_block >= m_data.blocks()) {
+    return false;
+  }
+
+  // let go of the previous block, so that its buffer can be reused if nobody
+  // else holds it
+  block = DataWithAesthetic();
+  if (!m_scratch || m_scratch.use_count() > 1) {
+    m_scratch = std::make_shared<std::vector<float>>();
+  }
+  const int rows = m_data.decompress_block(m_next_block++, *m_scratch);
+
+  const size_t cols = m_data.aesthetics().size();
+  std::vector<ColumnView> columns;
+  for (size_t k = 0; k < cols; ++k) {
+    columns.push_back({m_scratch->data() + k * rows, 1});
+  }
+  block = DataWithAesthetic(
+      std::make_shared<RawData>(rows, std::move(columns), m_scratch));
+  for (size_t k = 0; k < cols; ++k) {
+    block.map(m_data.aesthetics()[k], static_cast<int>(k));
+  }
+  return true;
+}
+
+} // namespace trase
@@ -0,0 +1,141 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file CompressedData.hpp
+/// A dataset held in memory as losslessly compressed blocks of rows
+
+#ifndef COMPRESSED_DATA_H_
+#define COMPRESSED_DATA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "frontend/Data.hpp"
+#include "frontend/Streaming.hpp"
+
+namespace trase {
+
+/// Holds the rows of a dataset as compressed blocks, e.g. to keep a long
+/// history of a live plot in a fraction of the memory
+///
+/// Rows are appended as they arrive. Every \p block_rows rows, each column of
+/// the new rows is compressed on its own with compress_column(), which suits
+/// timestamps and slowly changing values. The rows of the last, partial block
+/// are kept uncompressed until it is full.
+///
+/// A block can be decompressed on its own, so streaming passes over the data
+/// (those run with stream(), e.g. StreamingLimits or StreamingBinX) only need
+/// one block in memory at a time: read the blocks with a CompressedSource.
+///
+/// CompressedData is not a backing for RawData, so plots cannot draw or
+/// transform it block by block. To plot the rows, decompress() them into a
+/// dataset, which holds every row uncompressed for as long as it is drawn.
+/// The saving is in the history that is kept but not currently plotted.
+class CompressedData {
+  int m_block_rows;
+
+  /// the aesthetic index of each column, in increasing order
+  std::vector<int> m_aesthetics;
+
+  /// the compressed columns of each full block, one after the other
+  std::vector<std::vector<uint8_t>> m_blocks;
+
+  /// the rows of the last block, in row major order, not yet compressed
+  std::vector<float> m_pending;
+
+  Limits m_limits;
+  int m_rows{0};
+
+public:
+  /// \param block_rows the number of rows in each compressed block
+  explicit CompressedData(int block_rows = 4096);
+
+  /// appends and compresses the rows of \p data. The first call sets the
+  /// aesthetics of the dataset, every later \p data must have the same
+  /// aesthetics (or no rows). Throws if it does not
+  void append(const DataWithAesthetic &data);
+
+  /// returns the number of rows
+  int rows() const { return m_rows; }
+
+  /// returns the number of blocks, including a last partial block
+  int blocks() const;
+
+  /// returns the number of rows in each block (the last may have fewer)
+  int block_rows() const { return m_block_rows; }
+
+  /// returns the aesthetic index of each column
+  const std::vector<int> &aesthetics() const { return m_aesthetics; }
+
+  /// returns the min/max limits of all the rows appended
+  const Limits &limits() const { return m_limits; }
+
+  /// returns the number of bytes used to hold the rows, compressed or not
+  size_t bytes() const;
+
+  /// decompresses block \p i into \p matrix, one column after the other.
+  /// \p matrix is resized to fit, so its memory can be reused for each block
+  ///
+  /// \return the number of rows in the block. Throws std::out_of_range if
+  /// the block does not exist
+  int decompress_block(int i, std::vector<float> &matrix) const;
+
+  /// returns every row as an uncompressed dataset, e.g. to plot it. This
+  /// needs the memory of the whole dataset, not just one block
+  DataWithAesthetic decompress() const;
+};
+
+/// A RowSource that decompresses each block of a CompressedData in turn
+///
+/// Each block is decompressed into a scratch buffer, and returned as a view
+/// onto it. The buffer is reused for the next block unless the previous one
+/// is still in use, so streaming through the data with stream() only ever
+/// holds one block uncompressed.
+class CompressedSource : public RowSource {
+  const CompressedData &m_data;
+  int m_next_block;
+  std::shared_ptr<std::vector<float>> m_scratch;
+
+public:
+  /// \param data the data to read, must remain valid while this source is used
+  explicit CompressedSource(const CompressedData &data)
+      : m_data(data), m_next_block(0) {}
+
+  bool next(DataWithAesthetic &block) override;
+};
+
+} // namespace trase
+
+#endif // COMPRESSED_DATA_H_
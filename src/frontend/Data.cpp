@@ -33,12 +33,32 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "frontend/Data.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace trase {
 
+RawData::RawData(const int rows, std::vector<ColumnView> columns,
+                 std::shared_ptr<const void> owner)
+    : m_views(std::move(columns)), m_owner(std::move(owner)), m_rows(rows),
+      m_cols(static_cast<int>(m_views.size())) {}
+
+RawData::RawData(const int cols, std::vector<float> matrix)
+    : m_matrix(std::move(matrix)), m_cols(cols) {
+  if (cols <= 0 || m_matrix.size() % cols != 0) {
+    throw Exception("matrix must have a value for each column of every row");
+  }
+  m_rows = static_cast<int>(m_matrix.size() / cols);
+}
+
 ColumnIterator RawData::begin(const int i) const {
   if (i < 0 || i >= cols()) {
     throw std::out_of_range("column does not exist");
   }
+  if (is_view()) {
+    return {m_views[i].data, m_views[i].stride};
+  }
   return {m_matrix.cbegin() + i, m_cols};
 }
 
@@ -46,44 +66,177 @@ ColumnIterator RawData::end(const int i) const {
   if (i < 0 || i >= cols()) {
     throw std::out_of_range("column does not exist");
   }
+  if (is_view()) {
+    return {m_views[i].data + m_rows * m_views[i].stride, m_views[i].stride};
+  }
   return {m_matrix.cend() + i, m_cols};
 }
 
-int DataWithAesthetic::rows() const { return m_data->rows(); }
+void RawData::append_rows(const std::vector<float> &rows) {
+  if (is_view()) {
+    throw Exception("cannot append rows to a read-only view");
+  }
+  if (m_cols == 0 || rows.size() % m_cols != 0) {
+    throw Exception("appended rows must have a value for each column");
+  }
+  m_matrix.insert(m_matrix.end(), rows.begin(), rows.end());
+  m_rows += static_cast<int>(rows.size() / m_cols);
+}
+
+void DataWithAesthetic::append(const DataWithAesthetic &rows) {
+  if (m_data->cols() == 0) {
+    *this = rows;
+    return;
+  }
+  if (m_selection) {
+    throw Exception("cannot append to a dataset with a selection");
+  }
+  if (m_data->is_view()) {
+    throw Exception("cannot append rows to a read-only view");
+  }
+
+  // gather the new rows into the column order of m_data
+  const int cols = m_data->cols();
+  std::vector<int> aesthetic_of(cols, -1);
+  for (const auto &i : m_map) {
+    aesthetic_of[i.second] = i.first;
+  }
+  std::vector<int> sources;
+  for (const int a : aesthetic_of) {
+    if (a == -1) {
+      throw Exception("cannot append to a dataset with an unused column");
+    }
+    const int column = rows.column(a);
+    if (column == -1) {
+      throw Exception(std::string("appended rows have no ") +
+                      aesthetic_name(a) + " aesthetic");
+    }
+    sources.push_back(column);
+  }
+  const int n = rows.rows();
+  std::vector<float> matrix(static_cast<size_t>(n) * cols);
+  for (int j = 0; j < cols; ++j) {
+    rows.visit_columns(
+        [&](auto source) {
+          for (int i = 0; i < n; ++i, ++source) {
+            matrix[static_cast<size_t>(i) * cols + j] = *source;
+          }
+        },
+        sources[j]);
+  }
+
+  if (m_data.use_count() > 1) {
+    m_data = std::make_shared<RawData>(*m_data);
+  }
+  m_data->append_rows(matrix);
+
+  for (const auto &i : m_map) {
+    const int a = i.first;
+    m_limits.bmin[a] = std::min(m_limits.bmin[a], rows.limits().bmin[a]);
+    m_limits.bmax[a] = std::max(m_limits.bmax[a], rows.limits().bmax[a]);
+  }
+}
+
+int DataWithAesthetic::rows() const {
+  if (m_selection) {
+    return m_selection_size;
+  }
+  return m_data->rows();
+}
 
 int DataWithAesthetic::cols() const { return m_data->cols(); }
 
 const Limits &DataWithAesthetic::limits() const { return m_limits; }
 
-template <typename Aesthetic> ColumnIterator DataWithAesthetic::begin() const {
+int DataWithAesthetic::column(const int aesthetic) const {
+  auto search = m_map.find(aesthetic);
+  if (search == m_map.end()) {
+    return -1;
+  }
+  return search->second;
+}
 
-  auto search = m_map.find(Aesthetic::index);
+void DataWithAesthetic::select(std::shared_ptr<const std::vector<int>> rows) {
+  const int end = rows ? static_cast<int>(rows->size()) : 0;
+  select(std::move(rows), 0, end);
+}
 
-  if (search == m_map.end()) {
-    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+void DataWithAesthetic::select(std::shared_ptr<const std::vector<int>> rows,
+                               const int begin, const int end) {
+  if (rows) {
+    if (begin < 0 || end < begin || end > static_cast<int>(rows->size())) {
+      throw std::out_of_range("selection range is out of range");
+    }
+    for (int i = begin; i < end; ++i) {
+      if ((*rows)[i] < 0 || (*rows)[i] >= m_data->rows()) {
+        throw std::out_of_range("selected row does not exist");
+      }
+    }
+  }
+  m_selection = std::move(rows);
+  m_selection_begin = m_selection ? begin : 0;
+  m_selection_size = m_selection ? end - begin : 0;
+  for (const auto &i : m_map) {
+    map(i.first, i.second);
   }
-  return m_data->begin(search->second);
 }
 
-template <typename Aesthetic> ColumnIterator DataWithAesthetic::end() const {
+void DataWithAesthetic::map(const int aesthetic, const int column) {
+  const int n = rows();
+  visit_columns(
+      [&](auto begin) {
+        if (n != 0) {
+          auto min_max = std::minmax_element(begin, begin + n);
+          m_limits.bmin[aesthetic] = *min_max.first;
+          m_limits.bmax[aesthetic] = *min_max.second;
+        }
+      },
+      column);
+  m_map[aesthetic] = column;
+
+  if (n == 0 && m_selection) {
+    // nothing is selected, so the limits of the previous selection are reset
+    m_limits.bmin[aesthetic] = Limits().bmin[aesthetic];
+    m_limits.bmax[aesthetic] = Limits().bmax[aesthetic];
+  } else if (n != 0) {
+
+    // if limits are equal spread them out by 2*1e4*eps to stop zeros later on
+    if (m_limits.bmin[aesthetic] == m_limits.bmax[aesthetic]) {
+      m_limits.bmin[aesthetic] -= 1e4f * std::numeric_limits<float>::epsilon();
+      m_limits.bmax[aesthetic] += 1e4f * std::numeric_limits<float>::epsilon();
+    }
+  }
+}
 
-  auto search = m_map.find(Aesthetic::index);
+template <typename Aesthetic> ColumnIterator DataWithAesthetic::begin() const {
+  const int column = required_column<Aesthetic>();
+  if (m_selection) {
+    throw Exception("dataset has a selection, use visit()");
+  }
+  return m_data->begin(column);
+}
 
-  if (search == m_map.end()) {
-    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+template <typename Aesthetic> ColumnIterator DataWithAesthetic::end() const {
+  const int column = required_column<Aesthetic>();
+  if (m_selection) {
+    throw Exception("dataset has a selection, use visit()");
   }
-  return m_data->end(search->second);
+  return m_data->end(column);
 }
 
 template ColumnIterator DataWithAesthetic::begin<Aesthetic::x>() const;
 template ColumnIterator DataWithAesthetic::begin<Aesthetic::y>() const;
 template ColumnIterator DataWithAesthetic::begin<Aesthetic::color>() const;
 template ColumnIterator DataWithAesthetic::begin<Aesthetic::size>() const;
+template ColumnIterator DataWithAesthetic::begin<Aesthetic::id>() const;
+template ColumnIterator DataWithAesthetic::begin<Aesthetic::time>() const;
 
 template ColumnIterator DataWithAesthetic::end<Aesthetic::x>() const;
 template ColumnIterator DataWithAesthetic::end<Aesthetic::y>() const;
 template ColumnIterator DataWithAesthetic::end<Aesthetic::color>() const;
 template ColumnIterator DataWithAesthetic::end<Aesthetic::size>() const;
+template ColumnIterator DataWithAesthetic::end<Aesthetic::id>() const;
+template ColumnIterator DataWithAesthetic::end<Aesthetic::time>() const;
 
 const int Aesthetic::N;
 const int Aesthetic::x::index;
@@ -94,6 +247,38 @@ const int Aesthetic::color::index;
 const char *Aesthetic::color::name = "color";
 const int Aesthetic::size::index;
 const char *Aesthetic::size::name = "size";
+const int Aesthetic::id::index;
+const char *Aesthetic::id::name = "id";
+const int Aesthetic::time::index;
+const char *Aesthetic::time::name = "time";
+
+int aesthetic_index(const std::string &name) {
+  for (int i = 0; i < Aesthetic::N; ++i) {
+    if (name == aesthetic_name(i)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const char *aesthetic_name(const int index) {
+  switch (index) {
+  case Aesthetic::x::index:
+    return Aesthetic::x::name;
+  case Aesthetic::y::index:
+    return Aesthetic::y::name;
+  case Aesthetic::color::index:
+    return Aesthetic::color::name;
+  case Aesthetic::size::index:
+    return Aesthetic::size::name;
+  case Aesthetic::id::index:
+    return Aesthetic::id::name;
+  case Aesthetic::time::index:
+    return Aesthetic::time::name;
+  default:
+    throw std::out_of_range("aesthetic index out of range");
+  }
+}
 
 float Aesthetic::x::to_display(const float data, const Limits &data_lim,
                                const bfloat2_t &display_lim) {
@@ -170,6 +355,35 @@ float Aesthetic::size::from_display(const float display, const Limits &data_lim,
   return data_lim.bmin[index] + rel_pos * len_ratio;
 }
 
+float Aesthetic::id::to_display(const float data, const Limits &data_lim,
+                                const bfloat2_t &display_lim) {
+  (void)data_lim;
+  (void)display_lim;
+  return data;
+}
+
+float Aesthetic::id::from_display(const float display, const Limits &data_lim,
+                                  const bfloat2_t &display_lim) {
+  (void)data_lim;
+  (void)display_lim;
+  return display;
+}
+
+float Aesthetic::time::to_display(const float data, const Limits &data_lim,
+                                  const bfloat2_t &display_lim) {
+  (void)data_lim;
+  (void)display_lim;
+  return data;
+}
+
+float Aesthetic::time::from_display(const float display,
+                                    const Limits &data_lim,
+                                    const bfloat2_t &display_lim) {
+  (void)data_lim;
+  (void)display_lim;
+  return display;
+}
+
 template <typename Aesthetic>
 void DataWithAesthetic::set(const float min, const float max) {
   m_limits.bmin[Aesthetic::index] = min;
@@ -198,4 +412,67 @@ DataWithAesthetic &DataWithAesthetic::size(const float min, const float max) {
 
 DataWithAesthetic create_data() { return DataWithAesthetic(); }
 
+TimeFrames split_frames(const DataWithAesthetic &data) {
+  const int column = data.column(Aesthetic::time::index);
+  if (column == -1) {
+    throw Exception(Aesthetic::time::name +
+                    std::string(" aestheic not provided"));
+  }
+  const int rows = data.rows();
+
+  // count the rows at each distinct time
+  std::unordered_map<float, int> frame_of_time;
+  std::vector<int> counts;
+  TimeFrames ret;
+  data.visit_columns(
+      [&](const auto time) {
+        for (int i = 0; i < rows; ++i) {
+          const float t = time[i];
+          if (std::isnan(t)) {
+            continue;
+          }
+          auto search =
+              frame_of_time.emplace(t, static_cast<int>(counts.size()));
+          if (search.second) {
+            counts.push_back(0);
+            ret.times.push_back(t);
+          }
+          ++counts[search.first->second];
+        }
+      },
+      column);
+
+  // number the frames in time order, and find the first sorted row of each
+  const int frames = static_cast<int>(ret.times.size());
+  std::sort(ret.times.begin(), ret.times.end());
+  std::vector<int> offsets(frames + 1, 0);
+  for (int f = 0; f < frames; ++f) {
+    auto &frame = frame_of_time[ret.times[f]];
+    offsets[f + 1] = offsets[f] + counts[frame];
+    frame = f;
+  }
+
+  // place each row (as an index into the RawData) in its frame
+  auto sorted = std::make_shared<std::vector<int>>(offsets.back());
+  const int *selected = data.selection();
+  std::vector<int> next(offsets.begin(), offsets.end() - 1);
+  data.visit_columns(
+      [&](const auto time) {
+        for (int i = 0; i < rows; ++i) {
+          const float t = time[i];
+          if (std::isnan(t)) {
+            continue;
+          }
+          (*sorted)[next[frame_of_time[t]]++] = selected ? selected[i] : i;
+        }
+      },
+      column);
+
+  ret.frames.resize(frames, data);
+  for (int f = 0; f < frames; ++f) {
+    ret.frames[f].select(sorted, offsets[f], offsets[f + 1]);
+  }
+  return ret;
+}
+
 } // namespace trase
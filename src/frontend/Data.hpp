@@ -40,7 +40,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "util/BBox.hpp"
@@ -51,6 +53,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace trase {
 
 /// Raw data class, impliments a matrix with row major order
+///
+/// A RawData either owns its matrix, or is a read-only view onto columns that
+/// live in memory owned by someone else (e.g. a shared memory segment). A view
+/// keeps a handle to the owner of this memory alive for as long as it exists
 class RawData {
   // raw data set, in row major order
   std::vector<float> m_matrix;
@@ -58,16 +64,36 @@ class RawData {
   /// temporary data
   std::vector<float> m_tmp;
 
+  /// the columns of a view (empty if this RawData owns its data)
+  std::vector<ColumnView> m_views;
+
+  /// keeps the memory pointed to by m_views alive
+  std::shared_ptr<const void> m_owner;
+
   int m_rows{0};
   int m_cols{0};
 
 public:
+  RawData() = default;
+
+  /// create a read-only view with \p rows rows over \p columns, none of the
+  /// data is copied. \p owner is held until this RawData is destroyed
+  RawData(int rows, std::vector<ColumnView> columns,
+          std::shared_ptr<const void> owner);
+
+  /// create a dataset with \p cols columns that takes ownership of \p matrix,
+  /// which holds its rows in row major order
+  RawData(int cols, std::vector<float> matrix);
+
   /// return the number of columns
   int cols() const { return m_cols; };
 
   /// return the number of rows
   int rows() const { return m_rows; };
 
+  /// return true if this is a read-only view onto external memory
+  bool is_view() const { return !m_views.empty(); }
+
   /// add a new column to the matrix. the data in `new_col` is copied into the
   /// new column
   template <typename T> void add_column(const std::vector<T> &new_col);
@@ -75,6 +101,10 @@ public:
   /// set a column in the matrix. the data in `new_col` is copied into column i
   template <typename T> void set_column(int i, const std::vector<T> &new_col);
 
+  /// append rows to the end of the matrix. `rows` holds the new rows in row
+  /// major order, with one value for each column
+  void append_rows(const std::vector<float> &rows);
+
   /// return a ColumnIterator to the beginning of column i
   ColumnIterator begin(int i) const;
 
@@ -89,7 +119,7 @@ public:
 /// Each Aesthetic defines a mapping to and from a display type
 struct Aesthetic {
   // aesthetic indexes must be able to index a vector with size=N
-  static const int N = 4;
+  static const int N = 6;
 
   using Limits = bbox<float, N>;
 
@@ -135,16 +165,51 @@ struct Aesthetic {
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
+
+  /// an identifier for each plotting element, used to match the rows of
+  /// different frames when the rows in each frame differ (e.g. particles that
+  /// are created and destroyed). Ids must be integers that a float can hold
+  /// exactly (i.e. less than 2^24 in magnitude), and are not displayed
+  struct id {
+    static const int index = 4;
+    static const char *name;
+
+    static float to_display(float data, const Limits &data_lim,
+                            const bfloat2_t &display_lim);
+    static float from_display(float display, const Limits &data_lim,
+                              const bfloat2_t &display_lim);
+  };
+
+  /// the time of the frame that each row belongs to, see split_frames(). Not
+  /// displayed
+  struct time {
+    static const int index = 5;
+    static const char *name;
+
+    static float to_display(float data, const Limits &data_lim,
+                            const bfloat2_t &display_lim);
+    static float from_display(float display, const Limits &data_lim,
+                              const bfloat2_t &display_lim);
+  };
 };
 
 /// Each aesthetic has a set of min/max limits, or scales, that are used for
 /// plotting
 using Limits = Aesthetic::Limits;
 
+/// returns the index of the aesthetic called \p name (e.g. "x"), or -1 if there
+/// is no such aesthetic
+int aesthetic_index(const std::string &name);
+
+/// returns the name of the aesthetic with index \p index
+const char *aesthetic_name(int index);
+
 /// Combination of the RawData class and Aesthetics, this class points to a
 /// RawData object, and contains a mapping from aesthetics to RawData column
 /// numbers
 class DataWithAesthetic {
+  friend class SceneIO;
+
   /// matrix of raw data
   std::shared_ptr<RawData> m_data;
 
@@ -154,19 +219,44 @@ class DataWithAesthetic {
   /// the min/max limits of m_data for each aesthetics
   Limits m_limits;
 
+  /// holds the rows of m_data in this dataset, or null if every row is
+  /// included. The rows are m_selection[m_selection_begin] onwards
+  std::shared_ptr<const std::vector<int>> m_selection;
+  int m_selection_begin{0};
+  int m_selection_size{0};
+
+  /// returns the RawData column of \p Aesthetic, throws if it has not been set
+  template <typename Aesthetic> int required_column() const;
+
 public:
   DataWithAesthetic() : m_data(std::make_shared<RawData>()) {}
   explicit DataWithAesthetic(std::shared_ptr<RawData> data)
       : m_data(std::move(data)) {}
 
   /// return a ColumnIterator to the beginning of the data column for aesthetic
-  /// a, throws if a has not yet been set
+  /// a, throws if a has not yet been set or this dataset has a selection (see
+  /// visit())
   template <typename Aesthetic> ColumnIterator begin() const;
 
   /// return a ColumnIterator to the end of the data column for aesthetic a,
-  /// throws if a has not yet been set
+  /// throws if a has not yet been set or this dataset has a selection
   template <typename Aesthetic> ColumnIterator end() const;
 
+  /// calls \p f with an iterator to the first row of the data column of each
+  /// of \p Aesthetics, throws if one has not yet been set. See visit_columns()
+  template <typename... Aesthetics, typename F> void visit(F &&f) const;
+
+  /// calls \p f with an iterator to the first row of each of the RawData
+  /// \p columns, which only visits the selected rows. The end of each column
+  /// is its first iterator + rows(). Throws std::out_of_range if a column
+  /// does not exist
+  ///
+  /// The iterators are ColumnIterators, or IndexedColumnIterators if this
+  /// dataset has a selection, so \p f (e.g. a generic lambda) is compiled for
+  /// each and neither checks for a selection at every row
+  template <typename F, typename... Columns>
+  void visit_columns(F &&f, Columns... columns) const;
+
   /// if aesthetic a is not yet been set, this creates a new data column and
   /// copies in `data` (throws if data does not have the correct number of
   /// rows). If aesthetic a has been previously set, its data column is
@@ -180,7 +270,17 @@ public:
   /// widths)
   template <typename Aesthetic> void set(float min, float max);
 
-  /// returns number of rows in the data set
+  /// appends the rows of \p rows, which must have every aesthetic of this
+  /// dataset, and expands the limits to include them. If the RawData is
+  /// shared with another dataset it is copied first, so that the other dataset
+  /// is unchanged. A dataset without any columns becomes a copy of \p rows
+  ///
+  /// Throws if this dataset has a selection, is a read-only view, or has a
+  /// column that is not used by an aesthetic
+  void append(const DataWithAesthetic &rows);
+
+  /// returns number of rows in the data set (the number of selected rows if
+  /// there is a selection)
   int rows() const;
 
   /// returns number of cols in the data set
@@ -189,6 +289,38 @@ public:
   /// returns the min/max limits of the data
   const Limits &limits() const;
 
+  /// returns the RawData column used by aesthetic index \p aesthetic, or -1 if
+  /// this aesthetic has not been set
+  int column(int aesthetic) const;
+
+  /// use the existing RawData column \p column for the aesthetic index \p
+  /// aesthetic, and update the limits of this aesthetic from its data. Throws
+  /// std::out_of_range if the column does not exist
+  void map(int aesthetic, int column);
+
+  /// restrict this dataset to the RawData rows in \p rows (which must be in
+  /// ascending order), and update the limits of each aesthetic from the
+  /// selected rows (an empty selection has empty limits). None of the data is
+  /// copied, and a null \p rows selects every row again. Throws
+  /// std::out_of_range if a row does not exist
+  void select(std::shared_ptr<const std::vector<int>> rows);
+
+  /// restrict this dataset to the RawData rows in (*rows)[begin] to
+  /// (*rows)[end - 1], so that several datasets can share one array of rows.
+  /// See select()
+  void select(std::shared_ptr<const std::vector<int>> rows, int begin,
+              int end);
+
+  /// returns a pointer to the rows() selected RawData rows, or nullptr if
+  /// every row is selected
+  const int *selection() const {
+    return m_selection ? m_selection->data() + m_selection_begin : nullptr;
+  }
+
+  /// returns the underlying RawData, which includes any rows that are not
+  /// selected
+  const RawData &raw() const { return *m_data; }
+
   template <typename T> DataWithAesthetic &x(const std::vector<T> &data);
   DataWithAesthetic &x(float min, float max);
 
@@ -200,12 +332,34 @@ public:
 
   template <typename T> DataWithAesthetic &size(const std::vector<T> &data);
   DataWithAesthetic &size(float min, float max);
+
+  template <typename T> DataWithAesthetic &id(const std::vector<T> &data);
+
+  template <typename T> DataWithAesthetic &time(const std::vector<T> &data);
 };
 
 /// creates a new, empty dataset
 /// \return an empty DataWithAesthetic
 DataWithAesthetic create_data();
 
+/// A long-format dataset divided into one dataset per frame
+struct TimeFrames {
+  /// the time of each frame, in increasing order
+  std::vector<float> times;
+
+  /// the rows of each frame
+  std::vector<DataWithAesthetic> frames;
+};
+
+/// divides \p data into frames, one for each distinct value of its time
+/// aesthetic. Throws if there is no time aesthetic
+///
+/// The rows are sorted by time in a single counting sort pass, and each frame
+/// selects a range of the sorted rows (see DataWithAesthetic::select()), so no
+/// data is copied. Within each frame the rows keep their original order. Rows
+/// with a NaN time are dropped.
+TimeFrames split_frames(const DataWithAesthetic &data);
+
 } // namespace trase
 
 #include "Data.tcc"
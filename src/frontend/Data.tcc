@@ -35,6 +35,10 @@ namespace trase {
 
 template <typename T> void RawData::add_column(const std::vector<T> &new_col) {
 
+  if (is_view()) {
+    throw Exception("cannot add a column to a read-only view");
+  }
+
   // if columns already exist then add the extra memory
   if (m_cols > 0) {
 
@@ -77,6 +81,10 @@ void RawData::set_column(const int i, const std::vector<T> &new_col) {
     throw std::out_of_range("column index out of range");
   }
 
+  if (is_view()) {
+    throw Exception("cannot set a column of a read-only view");
+  }
+
   // check number of rows in new column match
   if (static_cast<int>(new_col.size()) != m_rows) {
     throw Exception("columns in dataset must have identical number of rows");
@@ -88,9 +96,35 @@ void RawData::set_column(const int i, const std::vector<T> &new_col) {
   }
 }
 
+template <typename Aesthetic> int DataWithAesthetic::required_column() const {
+  auto search = m_map.find(Aesthetic::index);
+  if (search == m_map.end()) {
+    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+  }
+  return search->second;
+}
+
+template <typename... Aesthetics, typename F>
+void DataWithAesthetic::visit(F &&f) const {
+  visit_columns(std::forward<F>(f), required_column<Aesthetics>()...);
+}
+
+template <typename F, typename... Columns>
+void DataWithAesthetic::visit_columns(F &&f, Columns... columns) const {
+  if (m_selection) {
+    f(IndexedColumnIterator(m_data->begin(columns), selection())...);
+  } else {
+    f(m_data->begin(columns)...);
+  }
+}
+
 template <typename Aesthetic, typename T>
 void DataWithAesthetic::set(const std::vector<T> &data) {
 
+  if (m_selection) {
+    throw Exception("cannot set the data of a dataset with a selection");
+  }
+
   auto search = m_map.find(Aesthetic::index);
 
   if (search == m_map.end()) {
@@ -143,4 +177,16 @@ DataWithAesthetic &DataWithAesthetic::size(const std::vector<T> &data) {
   return *this;
 }
 
+template <typename T>
+DataWithAesthetic &DataWithAesthetic::id(const std::vector<T> &data) {
+  set<Aesthetic::id>(data);
+  return *this;
+}
+
+template <typename T>
+DataWithAesthetic &DataWithAesthetic::time(const std::vector<T> &data) {
+  set<Aesthetic::time>(data);
+  return *this;
+}
+
 } // namespace trase
@@ -96,6 +96,9 @@ class BackendSVG;
 /// AxisDraw.hpp), and included when compiling each Backend
 ///
 class Drawable {
+  // reads and writes the complete state, see SceneFile.hpp
+  friend class SceneIO;
+
 protected:
   /// a list of Drawables that are children of this object
   std::vector<std::shared_ptr<Drawable>> m_children;
@@ -148,6 +151,9 @@ public:
   /// \see update_frame_info()
   const FrameInfo &get_frame_info() const;
 
+  /// returns the animation time span of this object
+  float time_span() const { return m_time_span; }
+
   /// returns this objects drawable area in raw pixels
   const bfloat2_t &pixels() { return m_pixels; }
 
@@ -160,11 +166,35 @@ public:
   virtual void dispatch(BackendSVG &file, float time) = 0;
   virtual void dispatch(BackendSVG &file) = 0;
 
+  /// returns a copy of this object and all of its children, placed under \p
+  /// parent in the tree structure. Any frame data is shared with this object
+  /// rather than copied
+  ///
+  /// \see Figure::clone()
+  virtual std::shared_ptr<Drawable> clone(Drawable *parent) const = 0;
+
   /// draw this object using the given AnimatedBackend
   template <typename AnimatedBackend> void draw(AnimatedBackend &backend);
 
   /// draw this object using the given Backend
   template <typename Backend> void draw(Backend &backend, float time);
+
+protected:
+  /// sets the parent of this object, called when it is cloned
+  virtual void set_parent(Drawable *parent) { m_parent = parent; }
+
+  /// implements clone() for the derived class T, by copy constructing a T and
+  /// then replacing each of its children with a clone
+  template <typename T>
+  std::shared_ptr<Drawable> clone_as(Drawable *parent) const {
+    auto copy = std::make_shared<T>(static_cast<const T &>(*this));
+    Drawable &drawable = *copy;
+    drawable.set_parent(parent);
+    for (auto &child : drawable.m_children) {
+      child = child->clone(&drawable);
+    }
+    return copy;
+  }
 };
 
 } // namespace trase
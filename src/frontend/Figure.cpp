@@ -41,7 +41,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace trase {
 
-int Figure::m_num_windows = 0;
+std::atomic<int> Figure::m_num_windows(0);
 
 Figure::Figure(const std::array<float, 2> &pixels)
     : Drawable(nullptr,
@@ -50,6 +50,27 @@ Figure::Figure(const std::array<float, 2> &pixels)
   m_pixels = m_area;
 }
 
+std::shared_ptr<Drawable> Figure::clone(Drawable *parent) const {
+  auto copy = clone_as<Figure>(parent);
+  std::static_pointer_cast<Figure>(copy)->m_id = ++m_num_windows;
+  return copy;
+}
+
+std::shared_ptr<Figure> Figure::clone() const {
+  return std::static_pointer_cast<Figure>(clone(nullptr));
+}
+
+std::shared_ptr<Figure>
+Figure::clone(const std::array<float, 2> &pixels) const {
+  auto copy = clone();
+  copy->m_area = bfloat2_t(vfloat2_t(0, 0), vfloat2_t(pixels[0], pixels[1]));
+  copy->m_pixels = copy->m_area;
+  for (auto &i : copy->m_children) {
+    i->resize(copy->m_pixels);
+  }
+  return copy;
+}
+
 std::shared_ptr<Axis> Figure::axis() noexcept {
   auto new_axis =
       std::make_shared<Axis>(this, bfloat2_t({0.1f, 0.1f}, {0.9f, 0.9f}));
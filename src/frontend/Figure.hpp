@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define FIGURE_H_
 
 #include <array>
+#include <atomic>
 #include <memory>
 
 #include "frontend/Axis.hpp"
@@ -49,11 +50,14 @@ namespace trase {
 /// Each Figure points to one or more Axis objects that are drawn within the
 /// Figure.
 class Figure : public Drawable {
+  friend class SceneIO;
+
   /// a unique id for this figure
   int m_id;
 
-  /// total number of figures currentl created
-  static int m_num_windows;
+  /// total number of figures currentl created. Atomic, as figures are
+  /// created on several threads at once (e.g. by RenderServer)
+  static std::atomic<int> m_num_windows;
 
 public:
   /// create a new figure with the given number of pixels
@@ -63,6 +67,26 @@ public:
 
   TRASE_DISPATCH_BACKENDS
 
+  std::shared_ptr<Drawable> clone(Drawable *parent) const override;
+
+  /// Create a copy of this figure, which can then be changed (e.g. its axis
+  /// limits, labels or fonts) and drawn independently of this figure
+  ///
+  /// Each Axis and plot is copied, but the data frames of each plot are shared
+  /// with this figure (see DataWithAesthetic), so cloning is cheap even for
+  /// large datasets and no transform is reapplied. The shared data must not be
+  /// modified through either figure
+  ///
+  /// \return a shared pointer to the new figure, which has a new id
+  std::shared_ptr<Figure> clone() const;
+
+  /// Create a copy of this figure (see clone()) with a different size
+  ///
+  /// \param pixels the number of pixels along the {width, height} of the new
+  /// figure
+  /// \return a shared pointer to the new figure
+  std::shared_ptr<Figure> clone(const std::array<float, 2> &pixels) const;
+
   /// Create a new axis and return a shared pointer to it
   /// \return a shared pointer to the new axis
   std::shared_ptr<Axis> axis() noexcept;
@@ -73,6 +97,9 @@ public:
   /// \return a shared pointer to the nth axis
   std::shared_ptr<Axis> axis(int n);
 
+  /// Return the number of axes in this figure
+  int number_of_axes() const { return static_cast<int>(m_children.size()); }
+
   /// Draw the Figure using the Backend provided
   ///
   /// This function takes control of the render loop and animates the
@@ -104,6 +131,22 @@ inline std::shared_ptr<Figure> figure(std::array<float, 2> pixels = {
   return std::make_shared<Figure>(pixels);
 }
 
+/// Draw several figures into a single document using the AnimatedBackend
+/// provided (e.g. a dashboard)
+///
+/// The figures are laid out in a grid with \p columns columns, in row major
+/// order. The document header, styles and scripts are written once rather than
+/// once per figure, and the figures share one animation timeline (see
+/// BackendSVG::begin_document())
+///
+/// \param backend the AnimatedBackend used to draw the figures.
+/// \param figures the figures to draw
+/// \param columns the number of figures in each row of the grid
+template <typename AnimatedBackend>
+void draw_dashboard(AnimatedBackend &backend,
+                    const std::vector<std::shared_ptr<Figure>> &figures,
+                    int columns);
+
 } // namespace trase
 
 #include "frontend/Figure.tcc"
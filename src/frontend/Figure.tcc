@@ -31,8 +31,11 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
 #include <array>
+#include <numeric>
 #include <string>
+#include <vector>
 
 #include "frontend/Figure.hpp"
 
@@ -48,6 +51,40 @@ void Figure::draw(AnimatedBackend &backend) {
   backend.finalise();
 }
 
+template <typename AnimatedBackend>
+void draw_dashboard(AnimatedBackend &backend,
+                    const std::vector<std::shared_ptr<Figure>> &figures,
+                    const int columns) {
+  if (columns < 1) {
+    throw Exception("a dashboard needs at least one column");
+  }
+
+  // each column is as wide as its widest figure, and each row as tall as its
+  // tallest figure
+  const int rows = (static_cast<int>(figures.size()) + columns - 1) / columns;
+  std::vector<float> x(columns + 1, 0.f);
+  std::vector<float> y(rows + 1, 0.f);
+  float time_span = 0.f;
+  for (size_t i = 0; i < figures.size(); ++i) {
+    const auto &pixels = figures[i]->pixels();
+    const int column = static_cast<int>(i) % columns;
+    const int row = static_cast<int>(i) / columns;
+    x[column + 1] = std::max(x[column + 1], pixels.bmax[0]);
+    y[row + 1] = std::max(y[row + 1], pixels.bmax[1]);
+    time_span = std::max(time_span, figures[i]->time_span());
+  }
+  std::partial_sum(x.begin(), x.end(), x.begin());
+  std::partial_sum(y.begin(), y.end(), y.begin());
+
+  backend.begin_document(x.back(), y.back(), "Dashboard", time_span);
+  for (size_t i = 0; i < figures.size(); ++i) {
+    backend.embed_at(vfloat2_t(x[static_cast<int>(i) % columns],
+                               y[static_cast<int>(i) / columns]));
+    figures[i]->draw(backend);
+  }
+  backend.end_document();
+}
+
 template <typename Backend> void Figure::show(Backend &backend) {
   auto name = "Figure " + std::to_string(m_id);
   backend.init(this->m_pixels.bmax[0], this->m_pixels.bmax[1], name.c_str());
@@ -44,6 +44,9 @@ class Histogram : public Plot1D {
 public:
   explicit Histogram(Axis *parent) : Plot1D(parent) {}
   TRASE_DISPATCH_BACKENDS
+  std::shared_ptr<Drawable> clone(Drawable *parent) const override {
+    return clone_plot<Histogram>(parent);
+  }
   template <typename AnimatedBackend> void draw(AnimatedBackend &backend);
   template <typename Backend> void draw(Backend &backend, float time);
 
@@ -60,17 +60,37 @@ void Histogram::draw_frames(AnimatedBackend &backend) {
   const float dx =
       (m_data[0].limits().bmax[Aesthetic::x::index] - x0) / m_data[0].rows();
 
-  for (int i = 0; i < m_data[0].rows(); ++i) {
-    for (size_t f = 0; f < m_times.size(); ++f) {
-      auto y_data = m_data[f].begin<Aesthetic::y>()[i];
-      auto y_min = m_axis->to_display<Aesthetic::y>(y_data);
-      auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
+  // the bins are exported in tiles. The heights of a tile of bins in every
+  // frame are gathered (one frame at a time) into a contiguous scratch buffer
+  // and each bin is then serialised from there
+  const int bins = m_data[0].rows();
+  const int frames = static_cast<int>(m_times.size());
+  const int tile = std::max(1, transpose_tile_floats / frames);
+  std::vector<float> scratch(static_cast<size_t>(std::min(tile, bins)) *
+                             frames);
+  const auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
+
+  for (int tile_begin = 0; tile_begin < bins; tile_begin += tile) {
+    const int tile_end = std::min(bins, tile_begin + tile);
+    for (int f = 0; f < frames; ++f) {
+      m_data[f].visit<Aesthetic::y>([&](const auto y_data) {
+        for (int i = tile_begin; i < tile_end; ++i) {
+          scratch[(i - tile_begin) * frames + f] =
+              m_axis->to_display<Aesthetic::y>(y_data[i]);
+        }
+      });
+    }
+
+    for (int i = tile_begin; i < tile_end; ++i) {
+      const float *y_min = scratch.data() + (i - tile_begin) * frames;
       auto x_min = m_axis->to_display<Aesthetic::x>(i * dx + x0);
       auto x_max = m_axis->to_display<Aesthetic::x>((i + 1.f) * dx + x0);
-      backend.add_animated_rect(bfloat2_t({x_min, y_min}, {x_max, y_max}),
-                                m_times[f]);
+      for (int f = 0; f < frames; ++f) {
+        backend.add_animated_rect(
+            bfloat2_t({x_min, y_min[f]}, {x_max, y_max}), m_times[f]);
+      }
+      backend.end_animated_rect();
     }
-    backend.end_animated_rect();
   }
 }
 
@@ -92,25 +112,28 @@ template <typename Backend> void Histogram::draw_plot(Backend &backend) {
 
   if (w2 == 0.0f) {
     // exactly on a single frame
-    auto y_data = m_data[f].begin<Aesthetic::y>();
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      auto x_min = m_axis->to_display<Aesthetic::x>(i * dx + x0);
-      auto x_max = m_axis->to_display<Aesthetic::x>((i + 1.f) * dx + x0);
-      auto y_min = m_axis->to_display<Aesthetic::y>(y_data[i]);
-      auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
-      backend.rect(bfloat2_t({x_min, y_min}, {x_max, y_max}));
-    }
+    m_data[f].visit<Aesthetic::y>([&](const auto y_data) {
+      for (int i = 0; i < m_data[0].rows(); ++i) {
+        auto x_min = m_axis->to_display<Aesthetic::x>(i * dx + x0);
+        auto x_max = m_axis->to_display<Aesthetic::x>((i + 1.f) * dx + x0);
+        auto y_min = m_axis->to_display<Aesthetic::y>(y_data[i]);
+        auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
+        backend.rect(bfloat2_t({x_min, y_min}, {x_max, y_max}));
+      }
+    });
   } else {
-    auto y0 = m_data[f - 1].begin<Aesthetic::y>();
-    auto y1 = m_data[f].begin<Aesthetic::y>();
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      auto x_min = m_axis->to_display<Aesthetic::x>(i * dx + x0);
-      auto x_max = m_axis->to_display<Aesthetic::x>((i + 1.f) * dx + x0);
-      auto y_min = w1 * m_axis->to_display<Aesthetic::y>(y1[i]) +
-                   w2 * m_axis->to_display<Aesthetic::y>(y0[i]);
-      auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
-      backend.rect(bfloat2_t({x_min, y_min}, {x_max, y_max}));
-    }
+    m_data[f - 1].visit<Aesthetic::y>([&](const auto y0) {
+      m_data[f].visit<Aesthetic::y>([&](const auto y1) {
+        for (int i = 0; i < m_data[0].rows(); ++i) {
+          auto x_min = m_axis->to_display<Aesthetic::x>(i * dx + x0);
+          auto x_max = m_axis->to_display<Aesthetic::x>((i + 1.f) * dx + x0);
+          auto y_min = w1 * m_axis->to_display<Aesthetic::y>(y1[i]) +
+                       w2 * m_axis->to_display<Aesthetic::y>(y0[i]);
+          auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
+          backend.rect(bfloat2_t({x_min, y_min}, {x_max, y_max}));
+        }
+      });
+    });
   }
 }
 
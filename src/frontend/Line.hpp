@@ -45,6 +45,9 @@ public:
   explicit Line(Axis *parent) : Plot1D(parent) {}
 
   TRASE_DISPATCH_BACKENDS
+  std::shared_ptr<Drawable> clone(Drawable *parent) const override {
+    return clone_plot<Line>(parent);
+  }
 
   template <typename AnimatedBackend> void draw(AnimatedBackend &backend);
   template <typename Backend> void draw(Backend &backend, float time);
@@ -54,6 +57,8 @@ private:
   void draw_frames(AnimatedBackend &backend);
   template <typename AnimatedBackend>
   void draw_anim_highlights(AnimatedBackend &backend);
+  template <typename AnimatedBackend>
+  void draw_detail_levels(AnimatedBackend &backend);
   template <typename Backend> void draw_plot(Backend &backend);
   template <typename Backend> void draw_highlights(Backend &backend);
 };
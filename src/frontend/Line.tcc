@@ -31,13 +31,21 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "frontend/Align.hpp"
 #include "frontend/Line.hpp"
+#include "util/Decimate.hpp"
+#include <algorithm>
+#include <vector>
 
 namespace trase {
 
 template <typename AnimatedBackend> void Line::draw(AnimatedBackend &backend) {
-  draw_frames(backend);
-  draw_anim_highlights(backend);
+  if (m_times.size() == 1 && backend.detail_levels() > 1) {
+    draw_detail_levels(backend);
+  } else {
+    draw_frames(backend);
+    draw_anim_highlights(backend);
+  }
 }
 
 template <typename Backend>
@@ -59,22 +67,56 @@ void Line::draw_frames(AnimatedBackend &backend) {
                      m_axis->to_display<Aesthetic::y>(y)};
   };
 
-  auto x = m_data[0].begin<Aesthetic::x>();
-  auto y = m_data[0].begin<Aesthetic::y>();
-  backend.move_to(to_pixel(x[0], y[0]));
-  for (int i = 1; i < m_data[0].rows(); ++i) {
-    backend.line_to(to_pixel(x[i], y[i]));
-  }
+  auto add_vertices = [&](const int rows, auto vertex) {
+    for (int i = 0; i < rows; ++i) {
+      if (i == 0) {
+        backend.move_to(vertex(i));
+      } else {
+        backend.line_to(vertex(i));
+      }
+    }
+  };
+  auto add_frame = [&](const DataWithAesthetic &data) {
+    data.visit<Aesthetic::x, Aesthetic::y>([&](auto x, auto y) {
+      add_vertices(data.rows(), [&](int i) { return to_pixel(x[i], y[i]); });
+    });
+  };
+
+  add_frame(m_data[0]);
 
-  // other frames
+  // other frames. SMIL morphs the path by vertex index, so unless the
+  // vertices of frame f match those of frame f - 1 row for row, frame f is
+  // added a second time at the start of the interval, with each vertex at
+  // the position of its matching id in frame f - 1, as draw_plot() does.
+  // Vertices that enter are not moved and vertices that exit are dropped
+  std::vector<int> previous;
   for (size_t f = 1; f < m_times.size(); ++f) {
-    auto x = m_data[f].begin<Aesthetic::x>();
-    auto y = m_data[f].begin<Aesthetic::y>();
     backend.add_animated_path(m_times[f - 1]);
-    backend.move_to(to_pixel(x[0], y[0]));
-    for (int i = 1; i < m_data[0].rows(); ++i) {
-      backend.line_to(to_pixel(x[i], y[i]));
+
+    const FrameAlignment &aligned = alignment(static_cast<int>(f));
+    const bool by_row =
+        aligned.entered.empty() && aligned.exited.empty() &&
+        std::all_of(aligned.matched.begin(), aligned.matched.end(),
+                    [](const std::pair<int, int> &m) {
+                      return m.first == m.second;
+                    });
+    if (!by_row) {
+      previous.assign(m_data[f].rows(), -1);
+      for (const auto &m : aligned.matched) {
+        previous[m.second] = m.first;
+      }
+      m_data[f - 1].visit<Aesthetic::x, Aesthetic::y>([&](auto x0, auto y0) {
+        m_data[f].visit<Aesthetic::x, Aesthetic::y>([&](auto x1, auto y1) {
+          add_vertices(m_data[f].rows(), [&](int i) {
+            const int j = previous[i];
+            return j == -1 ? to_pixel(x1[i], y1[i]) : to_pixel(x0[j], y0[j]);
+          });
+        });
+      });
+      backend.add_animated_path(m_times[f - 1]);
     }
+
+    add_frame(m_data[f]);
   }
 
   backend.end_animated_path(m_times.back());
@@ -91,18 +133,70 @@ void Line::draw_anim_highlights(AnimatedBackend &backend) {
     backend.stroke_color(RGBA(0, 0, 0, 0));
     backend.fill_color(color, m_color);
 
-    auto x = m_data[0].begin<Aesthetic::x>();
-    auto y = m_data[0].begin<Aesthetic::y>();
+    m_data[0].visit<Aesthetic::x, Aesthetic::y>([&](auto x, auto y) {
+      for (int i = 0; i < m_data[0].rows(); ++i) {
+        vfloat2_t point = {x[i], y[i]};
+        vfloat2_t point_pixel = {m_axis->to_display<Aesthetic::x>(x[i]),
+                                 m_axis->to_display<Aesthetic::y>(y[i])};
+        std::snprintf(buffer, sizeof(buffer), "(%f,%f)", point[0], point[1]);
+        backend.tooltip(
+            point_pixel + 2.f * vfloat2_t(m_line_width, -m_line_width),
+            buffer);
+        backend.circle(point_pixel, 2 * m_line_width);
+      }
+    });
+    backend.clear_tooltip();
+  }
+}
+
+template <typename AnimatedBackend>
+void Line::draw_detail_levels(AnimatedBackend &backend) {
+  std::vector<vfloat2_t> vertices(m_data[0].rows());
+  m_data[0].visit<Aesthetic::x, Aesthetic::y>([&](auto x, auto y) {
     for (int i = 0; i < m_data[0].rows(); ++i) {
-      vfloat2_t point = {x[i], y[i]};
-      vfloat2_t point_pixel = {m_axis->to_display<Aesthetic::x>(x[i]),
-                               m_axis->to_display<Aesthetic::y>(y[i])};
-      std::snprintf(buffer, sizeof(buffer), "(%f,%f)", point[0], point[1]);
-      backend.tooltip(
-          point_pixel + 2.f * vfloat2_t(m_line_width, -m_line_width), buffer);
-      backend.circle(point_pixel, 2 * m_line_width);
+      vertices[i] = {m_axis->to_display<Aesthetic::x>(x[i]),
+                     m_axis->to_display<Aesthetic::y>(y[i])};
     }
-    backend.clear_tooltip();
+  });
+
+  char buffer[100];
+  auto highlight_color = m_color;
+  highlight_color.a(0);
+
+  for (int level = 0; level < backend.detail_levels(); ++level) {
+    const auto indices =
+        decimate_polyline(vertices, backend.detail_cell_size(level));
+    backend.begin_detail_level(level);
+
+    backend.begin_path();
+    if (!indices.empty()) {
+      backend.move_to(vertices[indices[0]]);
+    }
+    for (size_t j = 1; j < indices.size(); ++j) {
+      backend.line_to(vertices[indices[j]]);
+    }
+    backend.stroke_color(m_color);
+    backend.stroke_width(m_line_width);
+    backend.stroke();
+
+    // highlighted points, as in draw_anim_highlights. Only written for the
+    // coarsest level, as there is an element for each
+    if (level == 0) {
+      backend.stroke_color(RGBA(0, 0, 0, 0));
+      backend.fill_color(highlight_color, m_color);
+      m_data[0].visit<Aesthetic::x, Aesthetic::y>([&](auto x, auto y) {
+        for (const int i : indices) {
+          std::snprintf(buffer, sizeof(buffer), "(%f,%f)", x[i], y[i]);
+          backend.tooltip(vertices[i] +
+                              2.f * vfloat2_t(m_line_width, -m_line_width),
+                          buffer);
+          backend.circle(vertices[i], 2 * m_line_width);
+        }
+      });
+      backend.clear_tooltip();
+    }
+
+    backend.end_detail_level();
   }
 }
 
@@ -120,23 +214,38 @@ template <typename Backend> void Line::draw_plot(Backend &backend) {
 
   if (w2 == 0.0f) {
     // exactly on a single frame
-    auto x = m_data[f].begin<Aesthetic::x>();
-    auto y = m_data[f].begin<Aesthetic::y>();
-    backend.move_to(to_pixel(x[0], y[0]));
-    for (int i = 1; i < m_data[0].rows(); ++i) {
-      backend.line_to(to_pixel(x[i], y[i]));
-    }
+    m_data[f].visit<Aesthetic::x, Aesthetic::y>([&](auto x, auto y) {
+      for (int i = 0; i < m_data[f].rows(); ++i) {
+        if (i == 0) {
+          backend.move_to(to_pixel(x[i], y[i]));
+        } else {
+          backend.line_to(to_pixel(x[i], y[i]));
+        }
+      }
+    });
   } else {
-    // between two frames
-    auto x0 = m_data[f - 1].begin<Aesthetic::x>();
-    auto y0 = m_data[f - 1].begin<Aesthetic::y>();
-    auto x1 = m_data[f].begin<Aesthetic::x>();
-    auto y1 = m_data[f].begin<Aesthetic::y>();
-    backend.move_to(w1 * to_pixel(x1[0], y1[0]) + w2 * to_pixel(x0[0], y0[0]));
-    for (int i = 1; i < m_data[0].rows(); ++i) {
-      backend.line_to(w1 * to_pixel(x1[i], y1[i]) +
-                      w2 * to_pixel(x0[i], y0[i]));
+    // between two frames, the vertices of frame f are interpolated from the
+    // matching vertices of frame f - 1. Vertices that enter are not moved and
+    // vertices that exit are dropped
+    std::vector<int> previous(m_data[f].rows(), -1);
+    for (const auto &m : alignment(f).matched) {
+      previous[m.second] = m.first;
     }
+    m_data[f - 1].visit<Aesthetic::x, Aesthetic::y>([&](auto x0, auto y0) {
+      m_data[f].visit<Aesthetic::x, Aesthetic::y>([&](auto x1, auto y1) {
+        for (int i = 0; i < m_data[f].rows(); ++i) {
+          const int j = previous[i];
+          const vfloat2_t p = j == -1 ? to_pixel(x1[i], y1[i])
+                                      : w1 * to_pixel(x1[i], y1[i]) +
+                                            w2 * to_pixel(x0[j], y0[j]);
+          if (i == 0) {
+            backend.move_to(p);
+          } else {
+            backend.line_to(p);
+          }
+        }
+      });
+    });
   }
 
   backend.stroke_color(m_color);
@@ -165,16 +274,17 @@ template <typename Backend> void Line::draw_highlights(Backend &backend) {
     float min_r2 = std::numeric_limits<float>::max();
     vfloat2_t min_point{};
     // exactly on a frame
-    auto x = m_data[m_frame_info.frame_above].begin<Aesthetic::x>();
-    auto y = m_data[m_frame_info.frame_above].begin<Aesthetic::y>();
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      const vfloat2_t point = {x[i], y[i]};
-      auto point_r2 = (point - pos).squaredNorm();
-      if (point_r2 < min_r2) {
-        min_point = point;
-        min_r2 = point_r2;
+    const auto &data = m_data[m_frame_info.frame_above];
+    data.visit<Aesthetic::x, Aesthetic::y>([&](auto x, auto y) {
+      for (int i = 0; i < data.rows(); ++i) {
+        const vfloat2_t point = {x[i], y[i]};
+        auto point_r2 = (point - pos).squaredNorm();
+        if (point_r2 < min_r2) {
+          min_point = point;
+          min_r2 = point_r2;
+        }
       }
-    }
+    });
 
     // define search radius
     const vfloat2_t point_pixel = {
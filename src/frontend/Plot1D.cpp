@@ -34,19 +34,47 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "frontend/Plot1D.hpp"
 #include "frontend/Axis.hpp"
 
+#include <algorithm>
 #include <numeric>
+#include <unordered_map>
 
 #include "util/Vector.hpp"
 
 namespace trase {
 
+const int Plot1D::transpose_tile_floats;
+
 Plot1D::Plot1D(Axis *parent)
     : Drawable(parent, bfloat2_t(vfloat2_t(0, 0), vfloat2_t(1, 1))),
-      m_colormap(&Colormaps::viridis), m_line_width(3.f), m_axis(parent) {}
+      m_colormap(&Colormaps::viridis), m_line_width(3.f),
+      m_untransformed_kept(false), m_lazy(false), m_axis(parent),
+      m_frames_offset(0.f) {}
+
+void Plot1D::set_parent(Drawable *parent) {
+  Drawable::set_parent(parent);
+  m_axis = dynamic_cast<Axis *>(parent);
+}
 
 void Plot1D::add_frame(const DataWithAesthetic &data, float time) {
   // add new data frame
-  m_data.push_back(m_transform(data));
+  if (m_lazy) {
+    // store the frame as it is, with the transform to apply when it is used
+    if (!m_lazy_transform) {
+      m_lazy_transform = std::make_shared<Transform>(m_transform);
+    }
+    m_pending.resize(m_data.size());
+    m_pending.push_back({data, m_lazy_transform});
+    m_data.emplace_back();
+    m_untransformed = DataWithAesthetic();
+    m_untransformed_kept = false;
+  } else {
+    m_data.push_back(m_transform(data));
+    m_untransformed_kept = !m_transform.is_identity();
+    m_untransformed = m_untransformed_kept ? data : DataWithAesthetic();
+    if (!m_pending.empty()) {
+      m_pending.emplace_back();
+    }
+  }
 
   // add new frame time
   if (time > 0) {
@@ -54,7 +82,37 @@ void Plot1D::add_frame(const DataWithAesthetic &data, float time) {
   }
 
   // update limits with new frame
-  m_limits += m_data.back().limits();
+  if (!m_lazy) {
+    update_limits(m_data.back());
+  }
+}
+
+void Plot1D::append(const DataWithAesthetic &rows) {
+  if (m_data.empty()) {
+    throw Exception("cannot append rows to a plot without frames");
+  }
+  if (!m_pending.empty() && m_pending.back().transform) {
+    m_pending.back().data.append(rows);
+    return;
+  }
+  if (!m_untransformed_kept && m_transform.is_identity()) {
+    m_data.back().append(rows);
+  } else {
+    // the whole frame is transformed again, e.g. binning the new rows alone
+    // would give a second set of bins
+    if (!m_untransformed_kept) {
+      // the latest frame was stored as it was added
+      m_untransformed = m_data.back();
+      m_untransformed_kept = true;
+    }
+    m_untransformed.append(rows);
+    m_data.back() = m_transform(m_untransformed);
+  }
+  update_limits(m_data.back());
+}
+
+void Plot1D::update_limits(const DataWithAesthetic &frame) const {
+  m_limits += frame.limits();
 
   // communicate limits to parent axis
   const float buffer = 1.05f;
@@ -62,4 +120,107 @@ void Plot1D::add_frame(const DataWithAesthetic &data, float time) {
       m_limits * Limits::vector_t::Constant(buffer);
 }
 
+void Plot1D::transform_frame(const int i) const {
+  if (i < 0 || i >= static_cast<int>(m_pending.size()) ||
+      !m_pending[i].transform) {
+    return;
+  }
+  PendingFrame &pending = m_pending[i];
+  m_data[i] = (*pending.transform)(pending.data);
+  if (i + 1 == static_cast<int>(m_data.size()) &&
+      !pending.transform->is_identity()) {
+    m_untransformed = pending.data;
+    m_untransformed_kept = true;
+  }
+  pending.data = DataWithAesthetic();
+  pending.transform.reset();
+  update_limits(m_data[i]);
+}
+
+void Plot1D::copy_pending_transforms() {
+  std::unordered_map<const Transform *, std::shared_ptr<Transform>> copies;
+  auto copy = [&](std::shared_ptr<Transform> &transform) {
+    if (transform) {
+      auto &copied = copies[transform.get()];
+      if (!copied) {
+        copied = std::make_shared<Transform>(*transform);
+      }
+      transform = copied;
+    }
+  };
+  for (auto &pending : m_pending) {
+    copy(pending.transform);
+  }
+  copy(m_lazy_transform);
+}
+
+const FrameAlignment &Plot1D::alignment(const int f) const {
+  const DataWithAesthetic &previous = m_data[f - 1];
+  const DataWithAesthetic &next = m_data[f];
+
+  // m_aligned holds the frames it was computed for, so their RawData cannot
+  // be freed and another allocated at the same address
+  const auto same = [](const DataWithAesthetic &a,
+                       const DataWithAesthetic &b) {
+    return &a.raw() == &b.raw() && a.rows() == b.rows();
+  };
+  if (m_aligned.size() != 2 || !same(m_aligned[0], previous) ||
+      !same(m_aligned[1], next)) {
+    m_alignment = align_frames(previous, next);
+    m_aligned = {previous, next};
+  }
+  return m_alignment;
+}
+
+size_t Plot1D::pending_frames() const {
+  return static_cast<size_t>(
+      std::count_if(m_pending.begin(), m_pending.end(),
+                    [](const PendingFrame &f) { return bool(f.transform); }));
+}
+
+void Plot1D::transform_frames() const {
+  for (size_t i = 0; i < m_pending.size(); ++i) {
+    transform_frame(static_cast<int>(i));
+  }
+}
+
+void Plot1D::transform_frames(const float time) const {
+  if (m_pending.empty()) {
+    return;
+  }
+
+  // find the frames either side of time, as update_frame_info() does
+  const float clipped_time = std::min(std::max(time, 0.f), m_time_span);
+  const int frame_above = std::min(
+      static_cast<int>(std::distance(
+          m_times.begin(),
+          std::lower_bound(m_times.begin(), m_times.end(), clipped_time))),
+      static_cast<int>(m_data.size()) - 1);
+
+  // the first frame sets the bins of a histogram and the size of a points
+  // plot, so it is needed for every draw
+  transform_frame(0);
+  if (frame_above > 0) {
+    transform_frame(frame_above - 1);
+  }
+  transform_frame(frame_above);
+}
+
+void Plot1D::add_frames(const DataWithAesthetic &data) {
+  const TimeFrames split = split_frames(data);
+  if (split.frames.empty()) {
+    throw Exception("dataset has no frames");
+  }
+  if (m_data.empty()) {
+    m_frames_offset = split.times[0];
+  }
+  if (!m_data.empty() && split.times[0] - m_frames_offset < m_times.back()) {
+    throw Exception("cannot add frame with time less than max frame time");
+  }
+  m_data.reserve(m_data.size() + split.frames.size());
+  for (size_t f = 0; f < split.frames.size(); ++f) {
+    add_frame(split.frames[f], split.times[f] - m_frames_offset);
+  }
+}
+
 } // namespace trase
@@ -39,6 +39,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <memory>
 #include <vector>
 
+#include "frontend/Align.hpp"
 #include "frontend/Data.hpp"
 #include "frontend/Drawable.hpp"
 #include "frontend/Transform.hpp"
@@ -52,9 +53,11 @@ namespace trase {
 class Axis;
 
 class Plot1D : public Drawable {
+  friend class SceneIO;
+
 protected:
-  /// dataset
-  std::vector<DataWithAesthetic> m_data;
+  /// dataset. A frame that was added lazily is empty until it is transformed
+  mutable std::vector<DataWithAesthetic> m_data;
 
   /// label
   std::string m_label;
@@ -67,14 +70,51 @@ protected:
   RGBA m_color;
 
   /// min/max limits of m_data across all frames
-  Limits m_limits;
+  mutable Limits m_limits;
 
   /// transform
   Transform m_transform;
 
+  /// the latest frame as it was added, kept if it was transformed by a
+  /// transform other than the identity, so that append() can transform the
+  /// whole frame again
+  mutable DataWithAesthetic m_untransformed;
+  mutable bool m_untransformed_kept;
+
+  /// a frame that was added lazily, and has not been transformed yet
+  struct PendingFrame {
+    /// the frame as it was added
+    DataWithAesthetic data;
+
+    /// the transform to apply to the frame, null if there is none pending
+    std::shared_ptr<Transform> transform;
+  };
+
+  /// the pending transform of each frame of m_data. Empty if no frame has
+  /// been added lazily, otherwise the same size as m_data
+  mutable std::vector<PendingFrame> m_pending;
+
+  /// true if new frames are transformed when they are first used
+  bool m_lazy;
+
+  /// the transform shared by the frames added lazily since the last
+  /// set_transform(), null if there are none
+  std::shared_ptr<Transform> m_lazy_transform;
+
   /// parent axis
   Axis *m_axis;
 
+  /// subtracted from the times of the frames given to add_frames()
+  float m_frames_offset;
+
+  /// the last alignment returned by alignment(), and the frames it aligns
+  mutable FrameAlignment m_alignment;
+  mutable std::vector<DataWithAesthetic> m_aligned;
+
+  /// the number of floats in the scratch buffer that draw_frames() uses to
+  /// transpose a tile of elements across all frames (sized to fit in cache)
+  static const int transpose_tile_floats = 1 << 15;
+
 public:
   explicit Plot1D(Axis *parent);
 
@@ -90,17 +130,51 @@ public:
   /// Adds a new data frame to this plot
   ///
   /// The limits of the new data frame will be added to the limits of this
-  /// plot, and the parent axis
+  /// plot, and the parent axis. In lazy mode (see set_lazy()) this is done
+  /// once the frame is transformed
   ///
   /// \param data the new data frame
   /// \param time the timestamp for this frame. This must be greater than the
   /// time for all previously added frames
   void add_frame(const DataWithAesthetic &data, float time);
 
+  /// Adds a data frame for each distinct time in the long-format dataset \p
+  /// data, which must have a time aesthetic (see split_frames()). The frames
+  /// share the data of \p data, none of it is copied
+  ///
+  /// If this plot has no data the frames are shifted in time so that the
+  /// first frame is at time 0, and the frames of every later call are shifted
+  /// by the same amount, so that several batches of the same log (e.g. with
+  /// absolute times) line up. The shifted frames must all be later than the
+  /// previously added frames
+  void add_frames(const DataWithAesthetic &data);
+
+  /// Appends the rows of \p rows to the latest data frame, e.g. to follow a
+  /// growing log file. \p rows must have every aesthetic of the latest frame
+  /// as it was added (see DataWithAesthetic::append())
+  ///
+  /// The limits of the new rows will be added to the limits of this plot, and
+  /// the parent axis. Throws if this plot has no data frames
+  ///
+  /// The result is the same as adding the latest frame with \p rows already
+  /// appended: if the transform is not the identity (e.g. the bins of a
+  /// histogram), the rows of the latest frame as it was added are kept, and
+  /// the whole frame is transformed again with the current transform. If the
+  /// latest frame has not been transformed yet, \p rows are appended to it as
+  /// they are, and transformed with the rest of the frame
+  void append(const DataWithAesthetic &rows);
+
   float get_time(const int i) const { return m_times[i]; }
 
-  const DataWithAesthetic &get_data(const int i) const { return m_data[i]; }
-  DataWithAesthetic &get_data(const int i) { return m_data[i]; }
+  /// returns data frame \p i, transforming it first if it was added lazily
+  const DataWithAesthetic &get_data(const int i) const {
+    transform_frame(i);
+    return m_data[i];
+  }
+  DataWithAesthetic &get_data(const int i) {
+    transform_frame(i);
+    return m_data[i];
+  }
   size_t data_size() const { return m_data.size(); }
 
   /// Sets the transform
@@ -108,8 +182,41 @@ public:
   /// \param transform the new transform
   ///
   /// All new data frames added to the plot will have this transform applied
-  /// before the data is stored internally
-  void set_transform(const Transform &transform) { m_transform = transform; }
+  /// before the data is stored internally. Frames that were added lazily keep
+  /// the transform that was set when they were added
+  void set_transform(const Transform &transform) {
+    m_transform = transform;
+    m_lazy_transform.reset();
+  }
+
+  /// Turns lazy mode on or off for the data frames added from now on
+  ///
+  /// In lazy mode add_frame() stores each frame as it is, and the transform
+  /// is only applied to a frame when it is first needed: by a draw at a time
+  /// that shows it, or by get_data(). The result replaces the stored frame,
+  /// so each frame is transformed at most once. This makes an expensive
+  /// transform (e.g. binning) cost in proportion to the frames that are shown
+  /// rather than to the frames that are added, e.g. when rendering a short
+  /// time window of a long animation.
+  ///
+  /// The limits of this plot and the parent axis only include the frames
+  /// that have been transformed so far, so the axis of an animation may grow
+  /// as it plays. Call transform_frames() first to avoid this
+  void set_lazy(const bool lazy) { m_lazy = lazy; }
+  bool is_lazy() const { return m_lazy; }
+
+  /// returns the number of frames that were added lazily and have not been
+  /// transformed yet
+  size_t pending_frames() const;
+
+  /// transforms every frame that was added lazily and has not been
+  /// transformed yet
+  void transform_frames() const;
+
+  /// transforms the frames needed to draw this plot at \p time, if they were
+  /// added lazily and have not been transformed yet. These are the frames
+  /// either side of \p time, and the first frame
+  void transform_frames(float time) const;
 
   void set_color(const RGBA &color) { m_color = color; }
 
@@ -127,6 +234,38 @@ public:
 
   template <typename AnimatedBackend> void draw(AnimatedBackend &backend);
   template <typename Backend> void draw(Backend &backend, float time);
+
+protected:
+  void set_parent(Drawable *parent) override;
+
+  /// implements clone() for the plot type T, as Drawable::clone_as(). The
+  /// copy gets its own copy of each transform that is still pending, so the
+  /// two plots never apply (or change the state of) the same transform
+  template <typename T>
+  std::shared_ptr<Drawable> clone_plot(Drawable *parent) const {
+    auto copy = clone_as<T>(parent);
+    static_cast<Plot1D &>(*copy).copy_pending_transforms();
+    return copy;
+  }
+
+  /// replaces each pending transform with a copy. Frames that shared a
+  /// transform share its copy
+  void copy_pending_transforms();
+
+  /// returns the alignment of frames \p f - 1 and \p f (see align_frames())
+  ///
+  /// The alignment is kept until it is asked for a different pair of frames,
+  /// or either frame changes (e.g. rows are appended), so drawing many times
+  /// between the same two frames only aligns them once
+  const FrameAlignment &alignment(int f) const;
+
+private:
+  /// adds the limits of \p frame to this plot and the parent axis
+  void update_limits(const DataWithAesthetic &frame) const;
+
+  /// transforms frame \p i, if it was added lazily and has not been
+  /// transformed yet
+  void transform_frame(int i) const;
 };
 
 } // namespace trase
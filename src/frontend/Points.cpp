@@ -0,0 +1,126 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Axis must be complete before the draw functions in Points.tcc are parsed
+#include "frontend/Axis.hpp"
+
+#include "frontend/Points.hpp"
+
+#include "util/Parallel.hpp"
+
+namespace trase {
+
+const int Points::min_points_per_thread;
+
+void Points::project(const int threads) {
+
+  const int f = m_frame_info.frame_above;
+  const float w1 = m_frame_info.w1;
+  const float w2 = m_frame_info.w2;
+
+  // between two frames, points that enter or exit grow or shrink
+  const bool between = w2 != 0.0f;
+  const FrameAlignment none;
+  const FrameAlignment &alignment = between ? this->alignment(f) : none;
+  const DataWithAesthetic &data0 = m_data[between ? f - 1 : f];
+  const DataWithAesthetic &data1 = m_data[f];
+  const int matched = between ? static_cast<int>(alignment.matched.size())
+                              : data1.rows();
+  const int entered = static_cast<int>(alignment.entered.size());
+  const int n = matched + entered + static_cast<int>(alignment.exited.size());
+
+  // the color and size of the two frames are interpolated, so both must
+  // provide them or neither
+  const bool have_color = check_aesthetic<Aesthetic::color>(data1);
+  const bool have_size = check_aesthetic<Aesthetic::size>(data1);
+  if (check_aesthetic<Aesthetic::color>(data0) != have_color ||
+      check_aesthetic<Aesthetic::size>(data0) != have_size) {
+    throw Exception("points frames provide different aesthetics");
+  }
+
+  const Axis &axis = *m_axis;
+  auto to_pixel = [&](const float x, const float y, const float c,
+                      const float s) {
+    // if color or size is not provided use the bottom of the scale
+    return Vector<float, 4>{
+        axis.to_display<Aesthetic::x>(x), axis.to_display<Aesthetic::y>(y),
+        have_color ? axis.to_display<Aesthetic::color>(c) : 0.f,
+        have_size ? axis.to_display<Aesthetic::size>(s) : 1.f};
+  };
+
+  const bfloat2_t area = m_axis->pixels();
+  const int nthreads = number_of_threads(threads, n, min_points_per_thread);
+  m_projected.resize(nthreads);
+  visit_points(data0, [&](auto x0, auto y0, auto color0, auto size0) {
+    visit_points(data1, [&](auto x1, auto y1, auto color1, auto size1) {
+      auto point0 = [&](const int i) {
+        return to_pixel(x0[i], y0[i], color0[i], size0[i]);
+      };
+      auto point1 = [&](const int i) {
+        return to_pixel(x1[i], y1[i], color1[i], size1[i]);
+      };
+
+      parallel_rows(n, nthreads, [&](const int t, const int begin,
+                                     const int end) {
+        auto &out = m_projected[t];
+        out.clear();
+        for (int k = begin; k < end; ++k) {
+          Vector<float, 4> p;
+          if (!between) {
+            p = point1(k);
+          } else if (k < matched) {
+            const auto &m = alignment.matched[k];
+            p = w1 * point1(m.second) + w2 * point0(m.first);
+          } else if (k < matched + entered) {
+            p = point1(alignment.entered[k - matched]);
+            p[3] *= w1;
+          } else {
+            p = point0(alignment.exited[k - matched - entered]);
+            p[3] *= w2;
+          }
+
+          // written so that points with a NaN position are also culled
+          const bool visible = p[0] + p[3] >= area.bmin[0] &&
+                               p[0] - p[3] <= area.bmax[0] &&
+                               p[1] + p[3] >= area.bmin[1] &&
+                               p[1] - p[3] <= area.bmax[1];
+          if (visible) {
+            out.push_back({{p[0], p[1]}, p[3], m_colormap->to_color(p[2])});
+          }
+        }
+      });
+    });
+  });
+}
+
+} // namespace trase
@@ -40,16 +40,50 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace trase {
 
+/// a point projected into pixel space, ready to be drawn (see
+/// Points::project())
+struct ProjectedPoint {
+  vfloat2_t centre;
+  float radius;
+  RGBA color;
+};
+
 class Points : public Plot1D {
+  /// the points projected by project(), with one buffer per thread
+  std::vector<std::vector<ProjectedPoint>> m_projected;
+
+  /// layers with fewer points than this are projected on a single thread
+  static const int min_points_per_thread = 1 << 14;
+
 public:
   explicit Points(Axis *parent) : Plot1D(parent) {}
   TRASE_DISPATCH_BACKENDS
+  std::shared_ptr<Drawable> clone(Drawable *parent) const override {
+    return clone_plot<Points>(parent);
+  }
   template <typename AnimatedBackend> void draw(AnimatedBackend &backend);
   template <typename Backend> void draw(Backend &backend, float time);
 
+  /// projects the points at the current time (see update_frame_info()) into
+  /// pixel space, interpolating between frames and applying the colormap.
+  /// Points that lie entirely outside the axis are culled
+  ///
+  /// The points are divided into contiguous chunks, one for each of up to \p
+  /// threads threads (or every hardware thread if \p threads <= 0), and each
+  /// chunk is projected into its own buffer (see projected()). Drawing the
+  /// buffers in order gives the same result for any number of threads
+  void project(int threads = 0);
+
+  /// returns the buffers filled by project()
+  const std::vector<std::vector<ProjectedPoint>> &projected() const {
+    return m_projected;
+  }
+
 private:
   template <typename AnimatedBackend>
   void draw_frames(AnimatedBackend &backend);
+  template <typename AnimatedBackend>
+  void draw_detail_levels(AnimatedBackend &backend);
   template <typename Backend> void draw_plot(Backend &backend);
 };
 
@@ -31,13 +31,19 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "frontend/Align.hpp"
 #include "frontend/Points.hpp"
+#include "util/Decimate.hpp"
 
 namespace trase {
 
 template <typename AnimatedBackend>
 void Points::draw(AnimatedBackend &backend) {
-  draw_frames(backend);
+  if (m_times.size() == 1 && backend.detail_levels() > 1) {
+    draw_detail_levels(backend);
+  } else {
+    draw_frames(backend);
+  }
 }
 
 template <typename Backend>
@@ -47,13 +53,22 @@ void Points::draw(Backend &backend, const float time) {
 }
 
 template <typename T> bool check_aesthetic(const DataWithAesthetic &data) {
-  bool have_aes = true;
-  try {
-    data.begin<T>();
-  } catch (Exception) {
-    have_aes = false;
+  return data.column(T::index) != -1;
+}
+
+/// calls \p f with iterators to the x, y, color and size of each row of \p
+/// data (see DataWithAesthetic::visit()). If color or size is not provided
+/// the x iterator is given instead, as a dummy that is not used
+template <typename F> void visit_points(const DataWithAesthetic &data, F &&f) {
+  const int x = data.column(Aesthetic::x::index);
+  const int y = data.column(Aesthetic::y::index);
+  if (x == -1 || y == -1) {
+    throw Exception("x and y aesthetics not provided");
   }
-  return have_aes;
+  const int color = data.column(Aesthetic::color::index);
+  const int size = data.column(Aesthetic::size::index);
+  data.visit_columns(std::forward<F>(f), x, y, color != -1 ? color : x,
+                     size != -1 ? size : x);
 }
 
 template <typename AnimatedBackend>
@@ -71,72 +86,120 @@ void Points::draw_frames(AnimatedBackend &backend) {
         have_size ? m_axis->to_display<Aesthetic::size>(s) : 1.f};
   };
 
+  // the tracks are exported in tiles. The pixels of every track in a tile are
+  // first gathered frame by frame into a contiguous scratch buffer, so that
+  // each frame is only looked up once per tile and its columns are read in
+  // order, and then each track is serialised from the buffer
+  const auto tracks = frame_tracks(m_data);
+  std::vector<Vector<float, 4>> scratch;
+  std::vector<size_t> offsets;
+
+  // each point is animated over the frames it is present in. Points that
+  // enter (or exit) grow from (or shrink to) zero size over the previous (or
+  // next) frame, and have zero size outside this range
   backend.stroke_width(0);
-  for (int i = 0; i < m_data[0].rows(); ++i) {
-    for (size_t f = 0; f < m_times.size(); ++f) {
-      auto p =
-          to_pixel(m_data[f].begin<Aesthetic::x>()[i],
-                   m_data[f].begin<Aesthetic::y>()[i],
-                   have_color ? m_data[f].begin<Aesthetic::color>()[i] : 0.f,
-                   have_size ? m_data[f].begin<Aesthetic::size>()[i] : 0.f);
-
-      backend.fill_color(m_colormap->to_color(p[2]));
-      backend.add_animated_circle({p[0], p[1]}, p[3], m_times[f]);
+  const int last = static_cast<int>(m_times.size()) - 1;
+  for (size_t tile_begin = 0; tile_begin < tracks.size();) {
+    size_t tile_end = tile_begin;
+    offsets.clear();
+    offsets.push_back(0);
+    int first_frame = last;
+    int end_frame = 0;
+    do {
+      const auto &track = tracks[tile_end++];
+      offsets.push_back(offsets.back() + track.rows.size());
+      first_frame = std::min(first_frame, track.first_frame);
+      end_frame = std::max(end_frame, track.first_frame +
+                                          static_cast<int>(track.rows.size()));
+    } while (tile_end < tracks.size() &&
+             offsets.back() * 4 < transpose_tile_floats);
+
+    scratch.resize(offsets.back());
+    for (int f = first_frame; f < end_frame; ++f) {
+      visit_points(m_data[f], [&](auto x, auto y, auto color, auto size) {
+        for (size_t t = tile_begin; t < tile_end; ++t) {
+          const auto &track = tracks[t];
+          const int j = f - track.first_frame;
+          if (j >= 0 && j < static_cast<int>(track.rows.size())) {
+            const int i = track.rows[j];
+            scratch[offsets[t - tile_begin] + j] =
+                to_pixel(x[i], y[i], color[i], size[i]);
+          }
+        }
+      });
     }
-    backend.end_animated_circle();
+
+    for (size_t t = tile_begin; t < tile_end; ++t) {
+      const int first = tracks[t].first_frame;
+      const auto *p = scratch.data() + offsets[t - tile_begin];
+      const int n = static_cast<int>(tracks[t].rows.size());
+
+      backend.fill_color(m_colormap->to_color(p[0][2]));
+      if (first > 1) {
+        backend.add_animated_circle({p[0][0], p[0][1]}, 0.f, m_times[0]);
+      }
+      if (first > 0) {
+        backend.add_animated_circle({p[0][0], p[0][1]}, 0.f,
+                                    m_times[first - 1]);
+      }
+      for (int j = 0; j < n; ++j) {
+        backend.add_animated_circle({p[j][0], p[j][1]}, p[j][3],
+                                    m_times[first + j]);
+      }
+      const int end = first + n;
+      if (end <= last) {
+        backend.add_animated_circle({p[n - 1][0], p[n - 1][1]}, 0.f,
+                                    m_times[end]);
+      }
+      if (end < last) {
+        backend.add_animated_circle({p[n - 1][0], p[n - 1][1]}, 0.f,
+                                    m_times[last]);
+      }
+      backend.end_animated_circle();
+    }
+    tile_begin = tile_end;
   }
 }
 
-template <typename Backend> void Points::draw_plot(Backend &backend) {
-
-  const int f = m_frame_info.frame_above;
-  const float w1 = m_frame_info.w1;
-  const float w2 = m_frame_info.w2;
+template <typename AnimatedBackend>
+void Points::draw_detail_levels(AnimatedBackend &backend) {
+  bool have_color = check_aesthetic<Aesthetic::color>(m_data[0]);
+  bool have_size = check_aesthetic<Aesthetic::size>(m_data[0]);
 
-  // TODO: assumption that same aesthetics are provided for each frame
-  bool have_color = check_aesthetic<Aesthetic::color>(m_data[f]);
-  bool have_size = check_aesthetic<Aesthetic::size>(m_data[f]);
+  visit_points(m_data[0], [&](auto x, auto y, auto color, auto size) {
+    std::vector<vfloat2_t> positions(m_data[0].rows());
+    for (int i = 0; i < m_data[0].rows(); ++i) {
+      positions[i] = {m_axis->to_display<Aesthetic::x>(x[i]),
+                      m_axis->to_display<Aesthetic::y>(y[i])};
+    }
 
-  backend.stroke_width(0);
+    backend.stroke_width(0);
+    for (int level = 0; level < backend.detail_levels(); ++level) {
+      backend.begin_detail_level(level);
+      for (const int i :
+           decimate_points(positions, backend.detail_cell_size(level))) {
+        // if color or size is not provided use the bottom of the scale
+        const float c =
+            have_color ? m_axis->to_display<Aesthetic::color>(color[i]) : 0.f;
+        const float r =
+            have_size ? m_axis->to_display<Aesthetic::size>(size[i]) : 1.f;
+        backend.fill_color(m_colormap->to_color(c));
+        backend.circle(positions[i], r);
+      }
+      backend.end_detail_level();
+    }
+  });
+}
 
-  auto to_pixel = [&](auto x, auto y, auto c, auto s) {
-    // if color or size is not provided use the bottom of the scale
-    return Vector<float, 4>{
-        m_axis->to_display<Aesthetic::x>(x),
-        m_axis->to_display<Aesthetic::y>(y),
-        have_color ? m_axis->to_display<Aesthetic::color>(c) : 0.f,
-        have_size ? m_axis->to_display<Aesthetic::size>(s) : 1.f};
-  };
+template <typename Backend> void Points::draw_plot(Backend &backend) {
+  project();
 
-  if (w2 == 0.0f) {
-    // exactly on a single frame
-    auto x = m_data[f].begin<Aesthetic::x>();
-    auto y = m_data[f].begin<Aesthetic::y>();
-    // if color or size not provided give a dummy iterator here, not used
-    auto color = have_color ? m_data[f].begin<Aesthetic::color>() : x;
-    auto size = have_size ? m_data[f].begin<Aesthetic::size>() : x;
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      const auto p = to_pixel(x[i], y[i], color[i], size[i]);
-      backend.fill_color(m_colormap->to_color(p[2]));
-      backend.circle({p[0], p[1]}, p[3]);
-    }
-  } else {
-    // between two frames
-    auto x0 = m_data[f - 1].begin<Aesthetic::x>();
-    auto y0 = m_data[f - 1].begin<Aesthetic::y>();
-    // if color or size not provided give a dummy iterator here, not used
-    auto color0 = have_color ? m_data[f - 1].begin<Aesthetic::color>() : x0;
-    auto size0 = have_size ? m_data[f - 1].begin<Aesthetic::size>() : x0;
-    auto x1 = m_data[f].begin<Aesthetic::x>();
-    auto y1 = m_data[f].begin<Aesthetic::y>();
-    // if color or size not provided give a dummy iterator here, not used
-    auto color1 = have_color ? m_data[f].begin<Aesthetic::color>() : x1;
-    auto size1 = have_size ? m_data[f].begin<Aesthetic::size>() : x1;
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      const auto p = w1 * to_pixel(x1[i], y1[i], color1[i], size1[i]) +
-                     w2 * to_pixel(x0[i], y0[i], color0[i], size0[i]);
-      backend.fill_color(m_colormap->to_color(p[2]));
-      backend.circle({p[0], p[1]}, p[3]);
+  // the backend is not thread safe, so the projected points are drawn here
+  backend.stroke_width(0);
+  for (const auto &buffer : m_projected) {
+    for (const auto &p : buffer) {
+      backend.fill_color(p.color);
+      backend.circle(p.centre, p.radius);
     }
   }
 }
@@ -0,0 +1,211 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "frontend/Sampling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "util/Parallel.hpp"
+
+namespace trase {
+
+namespace {
+
+// rows with a key, ordered by key and then row so that ties are deterministic
+using Candidate = std::pair<uint64_t, int>;
+
+// a counter based generator, the key of a row only depends on the seed and the
+// row index
+uint64_t splitmix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// datasets smaller than this are sampled on a single thread
+const int min_rows_per_thread = 1 << 16;
+
+// the index of each row in the RawData, so that keys are unchanged by a
+// selection
+int raw_row(const int *selection, const int i) {
+  return selection != nullptr ? selection[i] : i;
+}
+
+// adds c to the max-heap [first, first + size) of capacity n
+void offer(Candidate *first, int &size, const int n, const Candidate &c) {
+  if (size < n) {
+    first[size++] = c;
+    std::push_heap(first, first + size);
+  } else if (c < first[0]) {
+    std::pop_heap(first, first + size);
+    first[size - 1] = c;
+    std::push_heap(first, first + size);
+  }
+}
+
+DataWithAesthetic select_rows(const DataWithAesthetic &data,
+                              std::vector<int> rows) {
+  std::sort(rows.begin(), rows.end());
+  DataWithAesthetic ret(data);
+  ret.select(std::make_shared<std::vector<int>>(std::move(rows)));
+  return ret;
+}
+
+} // namespace
+
+RandomSample::RandomSample(const int size, const uint64_t seed,
+                           const int threads)
+    : m_size(size), m_seed(splitmix64(seed)), m_threads(threads) {
+  if (size <= 0) {
+    throw Exception("RandomSample size must be positive");
+  }
+}
+
+DataWithAesthetic
+RandomSample::operator()(const DataWithAesthetic &data) const {
+  const int rows = data.rows();
+  if (rows <= m_size) {
+    return data;
+  }
+  const int *selection = data.selection();
+  const int threads = number_of_threads(m_threads, rows, min_rows_per_thread);
+
+  // each thread keeps the smallest keys of its rows
+  std::vector<std::vector<Candidate>> heaps(threads,
+                                            std::vector<Candidate>(m_size));
+  std::vector<int> sizes(threads, 0);
+  parallel_rows(rows, threads, [&](const int t, const int begin,
+                                   const int end) {
+    Candidate *heap = heaps[t].data();
+    for (int i = begin; i < end; ++i) {
+      const int row = raw_row(selection, i);
+      offer(heap, sizes[t], m_size, {splitmix64(m_seed + row), row});
+    }
+  });
+
+  std::vector<Candidate> candidates;
+  for (int t = 0; t < threads; ++t) {
+    candidates.insert(candidates.end(), heaps[t].begin(),
+                      heaps[t].begin() + sizes[t]);
+  }
+  std::nth_element(candidates.begin(), candidates.begin() + m_size,
+                   candidates.end());
+  std::vector<int> sampled(m_size);
+  std::transform(candidates.begin(), candidates.begin() + m_size,
+                 sampled.begin(), [](const Candidate &c) { return c.second; });
+  return select_rows(data, std::move(sampled));
+}
+
+StratifiedSample::StratifiedSample(const int cells_x, const int cells_y,
+                                   const int per_cell, const uint64_t seed,
+                                   const int threads)
+    : m_cells_x(cells_x), m_cells_y(cells_y), m_per_cell(per_cell),
+      m_seed(splitmix64(seed)), m_threads(threads) {
+  if (cells_x <= 0 || cells_y <= 0 || per_cell <= 0) {
+    throw Exception("StratifiedSample sizes must be positive");
+  }
+}
+
+StratifiedSample::StratifiedSample(std::function<Limits()> limits,
+                                   const int cells_x, const int cells_y,
+                                   const int per_cell, const uint64_t seed,
+                                   const int threads)
+    : StratifiedSample(cells_x, cells_y, per_cell, seed, threads) {
+  m_limits = std::move(limits);
+}
+
+DataWithAesthetic
+StratifiedSample::operator()(const DataWithAesthetic &data) const {
+  const int rows = data.rows();
+  const int *selection = data.selection();
+  Limits limits = m_limits ? m_limits() : data.limits();
+  if (!(limits.bmax[Aesthetic::x::index] > limits.bmin[Aesthetic::x::index] &&
+        limits.bmax[Aesthetic::y::index] > limits.bmin[Aesthetic::y::index])) {
+    limits = data.limits();
+  }
+  const float x0 = limits.bmin[Aesthetic::x::index];
+  const float y0 = limits.bmin[Aesthetic::y::index];
+  const float x_scale = m_cells_x / (limits.bmax[Aesthetic::x::index] - x0);
+  const float y_scale = m_cells_y / (limits.bmax[Aesthetic::y::index] - y0);
+
+  const int cells = m_cells_x * m_cells_y;
+  const int threads = number_of_threads(m_threads, rows, min_rows_per_thread);
+
+  // each thread keeps a heap of the smallest keys in every cell
+  std::vector<std::vector<Candidate>> heaps(
+      threads, std::vector<Candidate>(static_cast<size_t>(cells) * m_per_cell));
+  std::vector<std::vector<int>> sizes(threads, std::vector<int>(cells, 0));
+  data.visit<Aesthetic::x, Aesthetic::y>([&](const auto x, const auto y) {
+    parallel_rows(rows, threads, [&](const int t, const int begin,
+                                     const int end) {
+      for (int i = begin; i < end; ++i) {
+        // written so that a NaN also fails the test
+        const float fx = (x[i] - x0) * x_scale;
+        const float fy = (y[i] - y0) * y_scale;
+        if (!(fx >= 0.f && fx <= m_cells_x && fy >= 0.f && fy <= m_cells_y)) {
+          continue;
+        }
+        const int cx = std::min(m_cells_x - 1, static_cast<int>(fx));
+        const int cy = std::min(m_cells_y - 1, static_cast<int>(fy));
+        const int cell = cy * m_cells_x + cx;
+        const int row = raw_row(selection, i);
+        offer(heaps[t].data() + static_cast<size_t>(cell) * m_per_cell,
+              sizes[t][cell], m_per_cell, {splitmix64(m_seed + row), row});
+      }
+    });
+  });
+
+  std::vector<int> sampled;
+  std::vector<Candidate> candidates;
+  for (int cell = 0; cell < cells; ++cell) {
+    candidates.clear();
+    for (int t = 0; t < threads; ++t) {
+      const auto first =
+          heaps[t].begin() + static_cast<size_t>(cell) * m_per_cell;
+      candidates.insert(candidates.end(), first, first + sizes[t][cell]);
+    }
+    const auto n = std::min(candidates.size(), static_cast<size_t>(m_per_cell));
+    std::nth_element(candidates.begin(), candidates.begin() + n,
+                     candidates.end());
+    for (size_t i = 0; i < n; ++i) {
+      sampled.push_back(candidates[i].second);
+    }
+  }
+  return select_rows(data, std::move(sampled));
+}
+
+} // namespace trase
@@ -0,0 +1,136 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Sampling.hpp
+/// Transforms that plot a representative subset of the rows of large datasets
+
+#ifndef SAMPLING_H_
+#define SAMPLING_H_
+
+#include <cstdint>
+#include <functional>
+
+#include "frontend/Data.hpp"
+
+namespace trase {
+
+/// keeps a uniform random sample of a fixed number of rows
+///
+/// Every row is given a pseudo-random key that depends only on the seed and
+/// the index of the row, and the rows with the smallest keys are kept. The
+/// rows are divided between several threads, but as the keys do not depend on
+/// the order in which rows are visited the sample is the same for any number
+/// of threads.
+///
+/// The result selects the sampled rows of the input (see
+/// DataWithAesthetic::select()), so every aesthetic of each row is kept and no
+/// data is copied.
+class RandomSample {
+  int m_size;
+  uint64_t m_seed;
+  int m_threads;
+
+public:
+  /// \param size the number of rows to keep
+  /// \param seed the seed for the row keys
+  /// \param threads the number of threads to use, defaults to the number of
+  /// hardware threads
+  explicit RandomSample(int size, uint64_t seed = 0, int threads = 0);
+
+  DataWithAesthetic operator()(const DataWithAesthetic &data) const;
+};
+
+/// keeps a fixed number of random rows in each cell of a grid over the x and
+/// y limits of an axis
+///
+/// Unlike RandomSample, sparse regions of the plot are not lost in a sample
+/// of a very dense dataset. Choosing the number of cells to match the pixels
+/// (or groups of pixels) of the axis gives a fixed output budget, each cell
+/// shows up to \p per_cell of its rows. The rows are chosen using the same
+/// keys as RandomSample, so the result does not depend on the number of
+/// threads. Rows outside the limits, or with a NaN x or y, are dropped.
+///
+/// The grid covers the limits returned by the function given to the
+/// constructor (e.g. the Axis::limits() of an axis), called each time the
+/// sample is taken, so a zoomed axis is sampled at the same density as the
+/// whole plot. Without it, or if it returns limits with an empty x or y range
+/// (e.g. Limits()), the limits of the data are used.
+///
+/// A copy of the sample calls the same function, which includes the
+/// transform of a plot copied by Figure::clone(): it still follows the axis
+/// of the original figure until the clone is given a new transform. To
+/// follow the axis that holds the sampled plot, capture a std::weak_ptr to it
+/// and return Limits() once it has gone, a std::shared_ptr would keep the
+/// axis (and the plot) alive forever:
+///
+///     std::weak_ptr<Axis> weak = ax;
+///     auto limits = [weak] {
+///       auto ax = weak.lock();
+///       return ax ? ax->limits() : Limits();
+///     };
+///     plot->set_transform(Transform(StratifiedSample(limits, 64, 64)));
+///
+/// Each thread holds up to \p per_cell candidates for every cell, so the
+/// memory used is proportional to the number of cells, not rows.
+///
+/// Requires x and y aesthetics.
+class StratifiedSample {
+  int m_cells_x;
+  int m_cells_y;
+  int m_per_cell;
+  uint64_t m_seed;
+  int m_threads;
+  std::function<Limits()> m_limits;
+
+public:
+  /// \param cells_x the number of grid cells along x
+  /// \param cells_y the number of grid cells along y
+  /// \param per_cell the maximum number of rows to keep in each cell
+  /// \param seed the seed for the row keys
+  /// \param threads the number of threads to use, defaults to the number of
+  /// hardware threads
+  StratifiedSample(int cells_x, int cells_y, int per_cell = 1,
+                   uint64_t seed = 0, int threads = 0);
+
+  /// \param limits returns the x and y limits covered by the grid
+  ///
+  /// The other parameters are as above
+  StratifiedSample(std::function<Limits()> limits, int cells_x, int cells_y,
+                   int per_cell = 1, uint64_t seed = 0, int threads = 0);
+
+  DataWithAesthetic operator()(const DataWithAesthetic &data) const;
+};
+
+} // namespace trase
+
+#endif // SAMPLING_H_
@@ -0,0 +1,337 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+
+#include "frontend/Streaming.hpp"
+
+namespace trase {
+
+namespace {
+
+const uint32_t partial_state_version = 1;
+
+template <typename T> void write_value(std::ostream &out, const T &value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T read_value(std::istream &in) {
+  T value;
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+    throw Exception("unexpected end of partial state");
+  }
+  return value;
+}
+
+// every partial state starts with a four character tag and a version number
+void write_tag(std::ostream &out, const char *tag) {
+  out.write(tag, 4);
+  write_value(out, partial_state_version);
+}
+
+void read_tag(std::istream &in, const char *tag) {
+  char read[4];
+  if (!in.read(read, 4) || !std::equal(read, read + 4, tag)) {
+    throw Exception(std::string("expected partial state ") +
+                    std::string(tag, 4));
+  }
+  if (read_value<uint32_t>(in) != partial_state_version) {
+    throw Exception("unsupported partial state version");
+  }
+}
+
+} // namespace
+
+StreamingBinX::StreamingBinX(const int number_of_bins, const float min,
+                             const float max)
+    : m_span(Vector<float, 1>(min), Vector<float, 1>(max)) {
+  if (number_of_bins <= 0 || !(max > min)) {
+    throw Exception("StreamingBinX requires a positive number of bins and a "
+                    "non-empty span");
+  }
+  m_counts.resize(number_of_bins, 0);
+}
+
+void StreamingBinX::consume(const DataWithAesthetic &block) {
+  if (block.rows() == 0) {
+    return;
+  }
+  const int n = static_cast<int>(m_counts.size());
+  const float min = m_span.bmin[0];
+  const float dx = m_span.delta()[0] / n;
+
+  // same bin calculation as BinX, so both give identical counts. NaN values
+  // are ignored
+  block.visit<Aesthetic::x>([&](const auto x_begin) {
+    std::for_each(x_begin, x_begin + block.rows(), [&](const float x) {
+      const float bin = std::floor((x - min) / dx);
+      if (bin >= 0.f && bin < n) {
+        ++m_counts[static_cast<int>(bin)];
+      } else if (bin < 0.f) {
+        ++m_underflow;
+      } else if (bin >= n) {
+        ++m_overflow;
+      }
+    });
+  });
+}
+
+DataWithAesthetic StreamingBinX::result() const {
+  std::vector<float> bin_y(m_counts.begin(), m_counts.end());
+  DataWithAesthetic ret;
+  ret.x(m_span.bmin[0], m_span.bmax[0]).y(bin_y);
+  ret.y(0.f, ret.limits().bmax[Aesthetic::y::index]);
+  return ret;
+}
+
+void StreamingBinX::merge(const StreamingBinX &other) {
+  if (other.m_counts.size() != m_counts.size() ||
+      other.m_span.bmin[0] != m_span.bmin[0] ||
+      other.m_span.bmax[0] != m_span.bmax[0]) {
+    throw Exception("cannot merge histograms with different bins");
+  }
+  std::transform(m_counts.begin(), m_counts.end(), other.m_counts.begin(),
+                 m_counts.begin(), std::plus<uint64_t>());
+  m_underflow += other.m_underflow;
+  m_overflow += other.m_overflow;
+}
+
+void StreamingBinX::write(std::ostream &out) const {
+  write_tag(out, "TRBX");
+  write_value(out, static_cast<uint32_t>(m_counts.size()));
+  write_value(out, m_span.bmin[0]);
+  write_value(out, m_span.bmax[0]);
+  write_value(out, m_underflow);
+  write_value(out, m_overflow);
+  out.write(reinterpret_cast<const char *>(m_counts.data()),
+            m_counts.size() * sizeof(uint64_t));
+}
+
+StreamingBinX StreamingBinX::read(std::istream &in) {
+  read_tag(in, "TRBX");
+  const auto n = read_value<uint32_t>(in);
+  const auto min = read_value<float>(in);
+  const auto max = read_value<float>(in);
+  StreamingBinX ret(static_cast<int>(n), min, max);
+  ret.m_underflow = read_value<uint64_t>(in);
+  ret.m_overflow = read_value<uint64_t>(in);
+  if (!in.read(reinterpret_cast<char *>(ret.m_counts.data()),
+               ret.m_counts.size() * sizeof(uint64_t))) {
+    throw Exception("unexpected end of partial state");
+  }
+  return ret;
+}
+
+void StreamingLimits::consume(const DataWithAesthetic &block) {
+  if (block.rows() == 0) {
+    return;
+  }
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    const int column = block.column(a);
+    if (column == -1) {
+      continue;
+    }
+    block.visit_columns(
+        [&](const auto begin) {
+          const auto min_max =
+              std::minmax_element(begin, begin + block.rows());
+          m_limits.bmin[a] = std::min(m_limits.bmin[a], *min_max.first);
+          m_limits.bmax[a] = std::max(m_limits.bmax[a], *min_max.second);
+        },
+        column);
+  }
+}
+
+void StreamingLimits::merge(const StreamingLimits &other) {
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    m_limits.bmin[a] = std::min(m_limits.bmin[a], other.m_limits.bmin[a]);
+    m_limits.bmax[a] = std::max(m_limits.bmax[a], other.m_limits.bmax[a]);
+  }
+}
+
+void StreamingLimits::write(std::ostream &out) const {
+  write_tag(out, "TRLM");
+  write_value(out, static_cast<uint32_t>(Aesthetic::N));
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    write_value(out, m_limits.bmin[a]);
+    write_value(out, m_limits.bmax[a]);
+  }
+}
+
+StreamingLimits StreamingLimits::read(std::istream &in) {
+  read_tag(in, "TRLM");
+  if (read_value<uint32_t>(in) != static_cast<uint32_t>(Aesthetic::N)) {
+    throw Exception("partial state has a different number of aesthetics");
+  }
+  StreamingLimits ret;
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    ret.m_limits.bmin[a] = read_value<float>(in);
+    ret.m_limits.bmax[a] = read_value<float>(in);
+  }
+  return ret;
+}
+
+void StreamingMoments::consume(const DataWithAesthetic &block) {
+  const int column = block.column(m_aesthetic);
+  if (column == -1) {
+    throw Exception("StreamingMoments aesthetic is not set in block");
+  }
+  if (block.rows() == 0) {
+    return;
+  }
+  // moments of this block
+  const auto n = static_cast<uint64_t>(block.rows());
+  double mean = 0;
+  double m2 = 0;
+  block.visit_columns(
+      [&](const auto begin) {
+        const auto end = begin + block.rows();
+        double sum = 0;
+        std::for_each(begin, end, [&sum](const float x) { sum += x; });
+        mean = sum / n;
+        std::for_each(begin, end, [&](const float x) {
+          const double d = x - mean;
+          m2 += d * d;
+        });
+      },
+      column);
+
+  merge(n, mean, m2);
+}
+
+void StreamingMoments::merge(const uint64_t n, const double mean,
+                             const double m2) {
+  if (n == 0) {
+    return;
+  }
+
+  // combine with the running moments (Chan et al. 1979)
+  const uint64_t count = m_count + n;
+  const double delta = mean - m_mean;
+  m_mean += delta * n / count;
+  m_m2 += m2 + delta * delta * (static_cast<double>(m_count) * n / count);
+  m_count = count;
+}
+
+void StreamingMoments::merge(const StreamingMoments &other) {
+  if (other.m_aesthetic != m_aesthetic) {
+    throw Exception("cannot merge moments of different aesthetics");
+  }
+  merge(other.m_count, other.m_mean, other.m_m2);
+}
+
+void StreamingMoments::write(std::ostream &out) const {
+  write_tag(out, "TRMO");
+  write_value(out, static_cast<int32_t>(m_aesthetic));
+  write_value(out, m_count);
+  write_value(out, m_mean);
+  write_value(out, m_m2);
+}
+
+StreamingMoments StreamingMoments::read(std::istream &in) {
+  read_tag(in, "TRMO");
+  StreamingMoments ret(read_value<int32_t>(in));
+  ret.m_count = read_value<uint64_t>(in);
+  ret.m_mean = read_value<double>(in);
+  ret.m_m2 = read_value<double>(in);
+  return ret;
+}
+
+StreamingSample::StreamingSample(const int size, const uint64_t seed)
+    : m_size(size), m_generator(seed) {
+  if (size <= 0) {
+    throw Exception("StreamingSample size must be positive");
+  }
+}
+
+void StreamingSample::consume(const DataWithAesthetic &block) {
+  std::vector<int> aesthetics;
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    if (block.column(a) != -1) {
+      aesthetics.push_back(a);
+    }
+  }
+  if (m_columns.empty()) {
+    m_aesthetics = aesthetics;
+    m_columns.resize(m_aesthetics.size());
+  } else if (aesthetics != m_aesthetics) {
+    throw Exception("all blocks must have the same aesthetics");
+  }
+
+  // the reservoir slot of each row, m_size if the row is not kept
+  const auto size = static_cast<uint64_t>(m_size);
+  std::vector<uint64_t> slots(block.rows());
+  for (int i = 0; i < block.rows(); ++i, ++m_seen) {
+    slots[i] = m_seen;
+    if (m_seen >= size) {
+      slots[i] =
+          std::uniform_int_distribution<uint64_t>(0, m_seen)(m_generator);
+      slots[i] = std::min(slots[i], size);
+    }
+  }
+
+  for (size_t j = 0; j < m_aesthetics.size(); ++j) {
+    auto &kept = m_columns[j];
+    block.visit_columns(
+        [&](const auto column) {
+          for (int i = 0; i < block.rows(); ++i) {
+            if (slots[i] == size) {
+              continue;
+            }
+            if (slots[i] == kept.size()) {
+              kept.push_back(column[i]);
+            } else {
+              kept[slots[i]] = column[i];
+            }
+          }
+        },
+        block.column(m_aesthetics[j]));
+  }
+}
+
+DataWithAesthetic StreamingSample::result() const {
+  auto raw = std::make_shared<RawData>();
+  for (const auto &column : m_columns) {
+    raw->add_column(column);
+  }
+  DataWithAesthetic ret(raw);
+  for (size_t j = 0; j < m_aesthetics.size(); ++j) {
+    ret.map(m_aesthetics[j], static_cast<int>(j));
+  }
+  return ret;
+}
+
+} // namespace trase
@@ -0,0 +1,226 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Streaming.hpp
+/// Chunked execution of transforms over data that is read in blocks of rows
+
+#ifndef STREAMING_H_
+#define STREAMING_H_
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "frontend/Data.hpp"
+#include "util/BBox.hpp"
+
+namespace trase {
+
+/// A source of data that is read one block of rows at a time
+///
+/// Every block has the same set of aesthetics. Only the current block needs to
+/// be held in memory, so a RowSource can provide far more data than would fit
+/// in a single DataWithAesthetic.
+class RowSource {
+public:
+  virtual ~RowSource() = default;
+
+  /// reads the next block of rows into \p block
+  ///
+  /// \return false if the source is exhausted, in which case \p block is left
+  /// unchanged
+  virtual bool next(DataWithAesthetic &block) = 0;
+};
+
+/// A RowSource that calls a function to generate each block
+class GeneratorSource : public RowSource {
+  std::function<bool(DataWithAesthetic &)> m_generator;
+
+public:
+  /// \param generator a function that sets its argument to the next block and
+  /// returns true, or returns false when there are no more blocks
+  explicit GeneratorSource(std::function<bool(DataWithAesthetic &)> generator)
+      : m_generator(std::move(generator)) {}
+
+  bool next(DataWithAesthetic &block) override { return m_generator(block); }
+};
+
+/// bins the x aesthetic of each block into a fixed set of bins
+///
+/// This is the streaming equivalent of BinX. As the data is not known in
+/// advance the span of the bins must be given, e.g. from a previous pass with
+/// StreamingLimits. Values outside the span are counted separately.
+///
+/// Like the other streaming accumulators, a StreamingBinX is a partial state
+/// that can be written to a stream, read back in another process and merged
+/// with the partial states computed over other shards of the data.
+class StreamingBinX {
+  bbox<float, 1> m_span;
+  std::vector<uint64_t> m_counts;
+  uint64_t m_underflow{0};
+  uint64_t m_overflow{0};
+
+public:
+  StreamingBinX(int number_of_bins, float min, float max);
+
+  /// adds the x values of \p block to the bins
+  void consume(const DataWithAesthetic &block);
+
+  /// returns the count in each bin
+  const std::vector<uint64_t> &counts() const { return m_counts; }
+
+  /// returns the number of values below the span of the bins
+  uint64_t underflow() const { return m_underflow; }
+
+  /// returns the number of values above the span of the bins
+  uint64_t overflow() const { return m_overflow; }
+
+  /// returns the histogram in the same form as BinX, ready to be plotted with
+  /// Axis::histogram() and an Identity transform
+  DataWithAesthetic result() const;
+
+  /// adds the counts of \p other, throws if the bins are different
+  void merge(const StreamingBinX &other);
+
+  /// writes the partial state to \p out
+  void write(std::ostream &out) const;
+
+  /// reads a partial state written by write(), throws if this fails
+  static StreamingBinX read(std::istream &in);
+};
+
+/// accumulates the min/max limits of every aesthetic of each block
+class StreamingLimits {
+  Limits m_limits;
+
+public:
+  /// expands the limits to include the data in \p block
+  void consume(const DataWithAesthetic &block);
+
+  /// returns the limits of all the data consumed so far, aesthetics that have
+  /// not been seen have empty limits
+  const Limits &limits() const { return m_limits; }
+
+  /// expands the limits to include those of \p other
+  void merge(const StreamingLimits &other);
+
+  /// writes the partial state to \p out
+  void write(std::ostream &out) const;
+
+  /// reads a partial state written by write(), throws if this fails
+  static StreamingLimits read(std::istream &in);
+};
+
+/// accumulates the count, mean and variance of an aesthetic
+///
+/// Each block is reduced separately (in double precision) and then combined
+/// with the running totals, so the result is accurate for very long streams.
+class StreamingMoments {
+  int m_aesthetic;
+  uint64_t m_count{0};
+  double m_mean{0};
+  double m_m2{0};
+
+public:
+  /// \param aesthetic the index of the aesthetic to accumulate
+  explicit StreamingMoments(int aesthetic = Aesthetic::x::index)
+      : m_aesthetic(aesthetic) {}
+
+  /// adds the values of \p block to the moments
+  void consume(const DataWithAesthetic &block);
+
+  /// returns the number of values consumed
+  uint64_t count() const { return m_count; }
+
+  /// returns the mean of the values consumed
+  double mean() const { return m_mean; }
+
+  /// returns the (population) variance of the values consumed
+  double variance() const { return m_count > 0 ? m_m2 / m_count : 0.0; }
+
+  /// combines the moments of \p other with these, throws if \p other
+  /// accumulates a different aesthetic
+  void merge(const StreamingMoments &other);
+
+  /// writes the partial state to \p out
+  void write(std::ostream &out) const;
+
+  /// reads a partial state written by write(), throws if this fails
+  static StreamingMoments read(std::istream &in);
+
+private:
+  void merge(uint64_t count, double mean, double m2);
+};
+
+/// keeps a uniform random sample of a fixed number of rows
+///
+/// Uses reservoir sampling, so every row consumed has the same probability of
+/// being in the sample regardless of the length of the stream.
+class StreamingSample {
+  int m_size;
+  std::mt19937_64 m_generator;
+  uint64_t m_seen{0};
+  std::vector<int> m_aesthetics;
+  std::vector<std::vector<float>> m_columns;
+
+public:
+  /// \param size the number of rows to keep
+  /// \param seed seeds the random number generator
+  explicit StreamingSample(int size, uint64_t seed = 0);
+
+  /// offers each row of \p block to the sample. Throws if \p block has
+  /// different aesthetics to the previous blocks
+  void consume(const DataWithAesthetic &block);
+
+  /// returns the number of rows consumed
+  uint64_t seen() const { return m_seen; }
+
+  /// returns the sampled rows, with the same aesthetics as the input
+  DataWithAesthetic result() const;
+};
+
+/// reads every block from \p source, passing each block to the consume()
+/// method of all the \p accumulators in turn
+///
+/// \return the number of rows read
+template <typename... Accumulators>
+uint64_t stream(RowSource &source, Accumulators &... accumulators);
+
+} // namespace trase
+
+#include "frontend/Streaming.tcc"
+
+#endif // STREAMING_H_
@@ -41,74 +41,124 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace trase {
 
+namespace {
+
+// the predicates are evaluated over blocks of rows that fit in the L1 cache.
+// Each block of a column is first gathered into a contiguous buffer, so that
+// the branch-free loops below can be vectorised by the compiler whatever the
+// stride or selection of the column
+const int filter_block_rows = 1024;
+
+void range_kernel(const float *v, const int n, const float min,
+                  const float max, uint8_t *mask) {
+  for (int i = 0; i < n; ++i) {
+    mask[i] &= static_cast<uint8_t>((v[i] >= min) & (v[i] <= max));
+  }
+}
+
+void drop_nan_kernel(const float *v, const int n, uint8_t *mask) {
+  for (int i = 0; i < n; ++i) {
+    mask[i] &= static_cast<uint8_t>(v[i] == v[i]);
+  }
+}
+
+// small sets are compared against every value, larger (sorted) sets are
+// searched
+const size_t members_linear_size = 16;
+
+void members_kernel(const float *v, const int n,
+                    const std::vector<float> &values, uint8_t *mask) {
+  if (values.size() <= members_linear_size) {
+    for (int i = 0; i < n; ++i) {
+      uint8_t found = 0;
+      for (const float value : values) {
+        found |= static_cast<uint8_t>(v[i] == value);
+      }
+      mask[i] &= found;
+    }
+  } else {
+    for (int i = 0; i < n; ++i) {
+      mask[i] &= static_cast<uint8_t>(
+          std::binary_search(values.begin(), values.end(), v[i]));
+    }
+  }
+}
+
+} // namespace
+
 BinX::BinX(const int number_of_bins) : m_number_of_bins(number_of_bins) {}
 BinX::BinX(const int number_of_bins, const float min, const float max)
     : m_number_of_bins(number_of_bins),
       m_span(Vector<float, 1>(min), Vector<float, 1>({max})) {}
 
 DataWithAesthetic BinX::operator()(const DataWithAesthetic &data) {
-  auto x_begin = data.begin<Aesthetic::x>();
-  auto x_end = data.end<Aesthetic::x>();
-
-  // if input data is empty then create an empty y aesthetic
-  if (std::distance(x_begin, x_end) == 0) {
-    std::vector<float> y;
-    return create_data().y(y);
-  }
+  std::vector<float> bin_y;
+  data.visit<Aesthetic::x>([&](const auto x_begin) {
+    auto x_end = x_begin + data.rows();
+    if (x_begin == x_end) {
+      return;
+    }
 
-  auto minmax = std::minmax_element(x_begin, x_end);
+    auto minmax = std::minmax_element(x_begin, x_end);
 
-  if (m_span.is_empty()) {
-    // increase the span slightly so round-off doesn't cause points to fall
-    // outside the domain
-    m_span.bmin[0] =
-        *minmax.first - 1e4f * std::numeric_limits<float>::epsilon();
-    m_span.bmin[1] =
-        *minmax.second + 1e4f * std::numeric_limits<float>::epsilon();
-  }
+    if (m_span.is_empty()) {
+      // increase the span slightly so round-off doesn't cause points to fall
+      // outside the domain
+      m_span.bmin[0] =
+          *minmax.first - 1e4f * std::numeric_limits<float>::epsilon();
+      m_span.bmin[1] =
+          *minmax.second + 1e4f * std::numeric_limits<float>::epsilon();
+    }
 
-  if (m_number_of_bins == -1) {
-    auto sum = std::accumulate(x_begin, x_end, 0.f);
-    auto mean = sum / data.rows();
-
-    // note: use std::transform_reduce after c++17
-    std::vector<float> diff(data.rows());
-    std::transform(x_begin, x_end, diff.begin(),
-                   [mean](float x) { return x - mean; });
-    auto sq_sum =
-        std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.f);
-    auto stdev = std::sqrt(sq_sum / data.rows());
-
-    // Scott, D. 1979.
-    // On optimal and data-based histograms.
-    // Biometrika, 66:605-610.
-    const float dx =
-        3.49f * stdev * std::pow(static_cast<float>(data.rows()), -0.33f);
-
-    // if calculated dx is too small then set number of bins to pre-determined
-    // number
-    if (dx > m_span.delta()[0] / 200.f) {
-      m_number_of_bins = static_cast<int>(std::round(m_span.delta()[0] / dx));
-    } else {
-      m_number_of_bins = 200;
+    if (m_number_of_bins == -1) {
+      auto sum = std::accumulate(x_begin, x_end, 0.f);
+      auto mean = sum / data.rows();
+
+      // note: use std::transform_reduce after c++17
+      std::vector<float> diff(data.rows());
+      std::transform(x_begin, x_end, diff.begin(),
+                     [mean](float x) { return x - mean; });
+      auto sq_sum =
+          std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.f);
+      auto stdev = std::sqrt(sq_sum / data.rows());
+
+      // Scott, D. 1979.
+      // On optimal and data-based histograms.
+      // Biometrika, 66:605-610.
+      const float dx =
+          3.49f * stdev * std::pow(static_cast<float>(data.rows()), -0.33f);
+
+      // if calculated dx is too small then set number of bins to
+      // pre-determined number
+      if (dx > m_span.delta()[0] / 200.f) {
+        m_number_of_bins =
+            static_cast<int>(std::round(m_span.delta()[0] / dx));
+      } else {
+        m_number_of_bins = 200;
+      }
     }
-  }
 
-  const float dx = m_span.delta()[0] / m_number_of_bins;
+    const float dx = m_span.delta()[0] / m_number_of_bins;
 
-  std::vector<float> bin_y(m_number_of_bins);
+    bin_y.resize(m_number_of_bins);
 
-  // zero y bin values
-  std::fill(bin_y.begin(), bin_y.end(), 0.f);
+    // zero y bin values
+    std::fill(bin_y.begin(), bin_y.end(), 0.f);
 
-  //  accumulate data into histogram
-  std::for_each(x_begin, x_end, [&](const float x) {
-    const auto i = static_cast<int>(std::floor((x - m_span.bmin[0]) / dx));
-    if (i >= 0 && i < m_number_of_bins) {
-      ++(bin_y[i]);
-    }
+    //  accumulate data into histogram
+    std::for_each(x_begin, x_end, [&](const float x) {
+      const auto i = static_cast<int>(std::floor((x - m_span.bmin[0]) / dx));
+      if (i >= 0 && i < m_number_of_bins) {
+        ++(bin_y[i]);
+      }
+    });
   });
 
+  // if input data is empty then create an empty y aesthetic
+  if (data.rows() == 0) {
+    return create_data().y(bin_y);
+  }
+
   // return new data set, making sure to set ymin to zero
   DataWithAesthetic ret;
   ret.x(m_span.bmin[0], m_span.bmax[0]).y(bin_y);
@@ -116,4 +166,63 @@ DataWithAesthetic BinX::operator()(const DataWithAesthetic &data) {
   return ret;
 }
 
+std::vector<uint8_t> Filter::mask(const DataWithAesthetic &data) const {
+  std::vector<int> columns;
+  for (const auto &p : m_predicates) {
+    const int column = data.column(p.aesthetic);
+    if (column == -1) {
+      throw Exception(aesthetic_name(p.aesthetic) +
+                      std::string(" aestheic not provided"));
+    }
+    columns.push_back(column);
+  }
+
+  const int rows = data.rows();
+  std::vector<uint8_t> mask(rows, 1);
+  std::vector<float> block(filter_block_rows);
+  for (int begin = 0; begin < rows; begin += filter_block_rows) {
+    const int n = std::min(filter_block_rows, rows - begin);
+    uint8_t *block_mask = mask.data() + begin;
+    for (size_t j = 0; j < m_predicates.size(); ++j) {
+      const auto &p = m_predicates[j];
+      data.visit_columns(
+          [&](const auto column) {
+            std::copy(column + begin, column + (begin + n), block.begin());
+          },
+          columns[j]);
+      switch (p.kind) {
+      case Kind::range:
+        range_kernel(block.data(), n, p.min, p.max, block_mask);
+        break;
+      case Kind::drop_nan:
+        drop_nan_kernel(block.data(), n, block_mask);
+        break;
+      case Kind::members:
+        members_kernel(block.data(), n, p.values, block_mask);
+        break;
+      }
+    }
+  }
+  return mask;
+}
+
+DataWithAesthetic Filter::operator()(const DataWithAesthetic &data) const {
+  const std::vector<uint8_t> selected = mask(data);
+  const int *previous = data.selection();
+
+  auto rows = std::make_shared<std::vector<int>>();
+  rows->reserve(
+      static_cast<size_t>(std::count(selected.begin(), selected.end(), 1)));
+  for (size_t i = 0; i < selected.size(); ++i) {
+    if (selected[i]) {
+      rows->push_back(previous != nullptr ? previous[i]
+                                          : static_cast<int>(i));
+    }
+  }
+
+  DataWithAesthetic ret(data);
+  ret.select(std::move(rows));
+  return ret;
+}
+
 } // namespace trase
@@ -36,7 +36,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TRANSFORM_H_
 #define TRANSFORM_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 #include "frontend/Data.hpp"
 #include "util/BBox.hpp"
@@ -64,6 +67,58 @@ public:
   DataWithAesthetic operator()(const DataWithAesthetic &data);
 };
 
+/// selects the rows that satisfy a set of predicates on their aesthetics
+///
+/// The result shares the RawData of the input and only holds the indices of
+/// the selected rows (see DataWithAesthetic::select()), so filtering a large
+/// dataset, or changing the filter, never copies the data itself. Applying a
+/// Filter to data that already has a selection selects from those rows.
+///
+/// Each predicate requires its aesthetic.
+class Filter {
+  enum class Kind { range, drop_nan, members };
+
+  struct Predicate {
+    Kind kind;
+    int aesthetic;
+    float min;
+    float max;
+    std::vector<float> values;
+  };
+
+  std::vector<Predicate> m_predicates;
+
+public:
+  /// keep the rows where \p Aesthetic is in the closed interval [min, max]
+  /// (NaN values are outside every interval)
+  template <typename Aesthetic> Filter &range(float min, float max) {
+    m_predicates.push_back({Kind::range, Aesthetic::index, min, max, {}});
+    return *this;
+  }
+
+  /// keep the rows where \p Aesthetic is not NaN
+  template <typename Aesthetic> Filter &drop_nan() {
+    m_predicates.push_back({Kind::drop_nan, Aesthetic::index, 0, 0, {}});
+    return *this;
+  }
+
+  /// keep the rows where \p Aesthetic is equal to one of \p values, for
+  /// categorical data
+  template <typename Aesthetic> Filter &members(std::vector<float> values) {
+    std::sort(values.begin(), values.end());
+    m_predicates.push_back(
+        {Kind::members, Aesthetic::index, 0, 0, std::move(values)});
+    return *this;
+  }
+
+  /// evaluates the predicates on each row of \p data, returns 1 for the rows
+  /// that satisfy every predicate and 0 for the others
+  std::vector<uint8_t> mask(const DataWithAesthetic &data) const;
+
+  /// returns \p data restricted to the rows that satisfy every predicate
+  DataWithAesthetic operator()(const DataWithAesthetic &data) const;
+};
+
 /// holds a `std::function` that maps between two DataWithAesthetic classes
 class Transform {
   std::function<DataWithAesthetic(const DataWithAesthetic &)> m_transform;
@@ -82,6 +137,9 @@ public:
   DataWithAesthetic operator()(const DataWithAesthetic &data) {
     return m_transform(data);
   }
+
+  /// returns true if this is the identity transform
+  bool is_identity() const { return m_transform.target<Identity>() != nullptr; }
 };
 
 } // namespace trase
@@ -0,0 +1,236 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "io/ColumnFile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+const char column_file_magic[4] = {'T', 'R', 'C', 'F'};
+
+// version 1 had no version field, and a uint32 number of rows
+const uint32_t column_file_version = 2;
+
+template <typename T> void write_uint(std::ostream &out, const T i) {
+  out.write(reinterpret_cast<const char *>(&i), sizeof(i));
+}
+
+template <typename T> T read_uint(std::istream &in) {
+  T i;
+  if (!in.read(reinterpret_cast<char *>(&i), sizeof(i))) {
+    throw Exception("unexpected end of column data");
+  }
+  return i;
+}
+
+} // namespace
+
+void write_columns(std::ostream &out, const DataWithAesthetic &data) {
+  std::vector<int> aesthetics;
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    if (data.column(a) != -1) {
+      aesthetics.push_back(a);
+    }
+  }
+
+  out.write(column_file_magic, sizeof(column_file_magic));
+  write_uint(out, column_file_version);
+  write_uint(out, static_cast<uint32_t>(aesthetics.size()));
+  write_uint(out, static_cast<uint64_t>(data.rows()));
+  size_t name_bytes = 0;
+  for (const int a : aesthetics) {
+    const std::string name = aesthetic_name(a);
+    write_uint(out, static_cast<uint32_t>(name.size()));
+    out.write(name.data(), name.size());
+    name_bytes += name.size();
+  }
+  const char padding[sizeof(float)] = {0};
+  out.write(padding, (sizeof(float) - name_bytes % sizeof(float)) %
+                         sizeof(float));
+
+  std::vector<float> column(data.rows());
+  for (const int a : aesthetics) {
+    data.visit_columns(
+        [&](const auto begin) {
+          std::copy(begin, begin + data.rows(), column.begin());
+        },
+        data.column(a));
+    out.write(reinterpret_cast<const char *>(column.data()),
+              column.size() * sizeof(float));
+  }
+}
+
+ColumnFileHeader read_column_header(std::istream &in) {
+  char magic[sizeof(column_file_magic)];
+  if (!in.read(magic, sizeof(magic)) ||
+      !std::equal(magic, magic + sizeof(magic), column_file_magic)) {
+    throw Exception("data is not in the column file format");
+  }
+  if (read_uint<uint32_t>(in) != column_file_version) {
+    throw Exception("column data has an unsupported version");
+  }
+
+  const uint32_t cols = read_uint<uint32_t>(in);
+  if (cols > Aesthetic::N) {
+    throw Exception("column data has more columns than aesthetics");
+  }
+  // the offset in bytes of every value must fit in an int64
+  const uint64_t rows = read_uint<uint64_t>(in);
+  if (rows > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) /
+                 (Aesthetic::N * sizeof(float))) {
+    throw Exception("column data has too many rows");
+  }
+  ColumnFileHeader header;
+  header.rows = static_cast<int64_t>(rows);
+  header.data_offset = 3 * sizeof(uint32_t) + sizeof(uint64_t);
+
+  // a name that is longer than every aesthetic name is not read, so that a
+  // corrupt length cannot allocate arbitrary amounts of memory
+  size_t max_name_bytes = 0;
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    max_name_bytes =
+        std::max(max_name_bytes, std::strlen(aesthetic_name(a)));
+  }
+
+  header.aesthetics.resize(cols);
+  size_t name_bytes = 0;
+  for (auto &a : header.aesthetics) {
+    const uint32_t length = read_uint<uint32_t>(in);
+    if (length > max_name_bytes) {
+      throw Exception("column name is not an aesthetic");
+    }
+    std::string name(length, ' ');
+    if (!in.read(&name[0], name.size())) {
+      throw Exception("unexpected end of column data");
+    }
+    a = aesthetic_index(name);
+    if (a == -1) {
+      throw Exception("column name " + name + " is not an aesthetic");
+    }
+    name_bytes += name.size();
+    header.data_offset += sizeof(uint32_t) + name.size();
+  }
+
+  char padding[sizeof(float)];
+  const size_t padding_bytes =
+      (sizeof(float) - name_bytes % sizeof(float)) % sizeof(float);
+  if (!in.read(padding, padding_bytes)) {
+    throw Exception("unexpected end of column data");
+  }
+  header.data_offset += padding_bytes;
+  return header;
+}
+
+DataWithAesthetic read_columns(std::istream &in) {
+  const ColumnFileHeader header = read_column_header(in);
+  if (header.rows > std::numeric_limits<int>::max()) {
+    throw Exception("column data has too many rows for a single dataset");
+  }
+
+  // each column is read in chunks, and only grown as its data arrives, so a
+  // header claiming more rows than the data holds (e.g. in a request to
+  // RenderServer) cannot allocate more memory than was actually sent
+  const size_t chunk_rows = 1 << 16;
+  const auto rows = static_cast<size_t>(header.rows);
+  auto raw = std::make_shared<RawData>();
+  std::vector<float> column;
+  for (size_t j = 0; j < header.aesthetics.size(); ++j) {
+    column.clear();
+    while (column.size() < rows) {
+      const size_t start = column.size();
+      column.resize(start + std::min(chunk_rows, rows - start));
+      if (!in.read(reinterpret_cast<char *>(column.data() + start),
+                   (column.size() - start) * sizeof(float))) {
+        throw Exception("unexpected end of column data");
+      }
+    }
+    raw->add_column(column);
+  }
+
+  DataWithAesthetic data(raw);
+  for (size_t j = 0; j < header.aesthetics.size(); ++j) {
+    data.map(header.aesthetics[j], static_cast<int>(j));
+  }
+  return data;
+}
+
+ColumnFileSource::ColumnFileSource(std::istream &in, const int block_rows)
+    : m_in(in), m_header(read_column_header(in)), m_block_rows(block_rows),
+      m_next_row(0) {
+  if (block_rows <= 0) {
+    throw Exception("block size must be positive");
+  }
+  // the stream might not start at the beginning of the column file
+  m_data_start = static_cast<std::streamoff>(m_in.tellg());
+}
+
+bool ColumnFileSource::next(DataWithAesthetic &block) {
+  if (m_next_row >= m_header.rows) {
+    return false;
+  }
+  const int rows = static_cast<int>(
+      std::min<int64_t>(m_block_rows, m_header.rows - m_next_row));
+
+  auto raw = std::make_shared<RawData>();
+  std::vector<float> column(rows);
+  for (size_t j = 0; j < m_header.aesthetics.size(); ++j) {
+    const std::streamoff offset =
+        (static_cast<std::streamoff>(j) * m_header.rows + m_next_row) *
+        static_cast<std::streamoff>(sizeof(float));
+    if (!m_in.seekg(m_data_start + offset) ||
+        !m_in.read(reinterpret_cast<char *>(column.data()),
+                   column.size() * sizeof(float))) {
+      throw Exception("unexpected end of column data");
+    }
+    raw->add_column(column);
+  }
+  m_next_row += rows;
+
+  block = DataWithAesthetic(raw);
+  for (size_t j = 0; j < m_header.aesthetics.size(); ++j) {
+    block.map(m_header.aesthetics[j], static_cast<int>(j));
+  }
+  return true;
+}
+
+} // namespace trase
@@ -0,0 +1,107 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file ColumnFile.hpp
+/// A simple binary format for a set of named data columns
+///
+/// The format is (the number of rows is uint64, all other integers are uint32,
+/// all data is float32, all in native byte order):
+///
+///     "TRCF" magic | version (2) | number of columns | number of rows
+///     for each column: name length | name (e.g. "x", "color")
+///     zero padding to align the data to 4 bytes
+///     for each column: rows * float32
+///
+/// Each column name is the name of the Aesthetic that it is used for.
+
+#ifndef COLUMN_FILE_H_
+#define COLUMN_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "frontend/Data.hpp"
+#include "frontend/Streaming.hpp"
+
+namespace trase {
+
+/// writes every aesthetic of \p data to \p out in the column file format
+void write_columns(std::ostream &out, const DataWithAesthetic &data);
+
+/// reads a dataset in the column file format from \p in. Throws if the data is
+/// not in the column file format, if a column name is not an aesthetic, or if
+/// there are more rows than fit in a dataset (read these with a RowSource)
+DataWithAesthetic read_columns(std::istream &in);
+
+/// the information stored at the start of a column file
+struct ColumnFileHeader {
+  /// the number of rows in each column, which can be more than fit in a
+  /// single dataset (see ColumnFileSource)
+  int64_t rows;
+
+  /// the aesthetic index of each column
+  std::vector<int> aesthetics;
+
+  /// the offset in bytes from the start of the file to the first column
+  size_t data_offset;
+};
+
+/// reads the header of a column file from \p in, leaving \p in at the start of
+/// the first column. Throws if the data is not in the column file format
+ColumnFileHeader read_column_header(std::istream &in);
+
+/// A RowSource that reads a column file from a (seekable) stream, one block of
+/// rows at a time
+class ColumnFileSource : public RowSource {
+  std::istream &m_in;
+  ColumnFileHeader m_header;
+  std::streamoff m_data_start;
+  int m_block_rows;
+  int64_t m_next_row;
+
+public:
+  /// reads the column file header from \p in, throws if this fails
+  ///
+  /// \param in the stream to read, must remain valid while this source is used
+  /// \param block_rows the number of rows in each block
+  ColumnFileSource(std::istream &in, int block_rows);
+
+  bool next(DataWithAesthetic &block) override;
+};
+
+} // namespace trase
+
+#endif // COLUMN_FILE_H_
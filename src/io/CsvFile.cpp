@@ -0,0 +1,157 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "io/CsvFile.hpp"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+// splits a line into comma separated fields, with surrounding whitespace
+// removed
+void split_line(const std::string &line, std::vector<std::string> &fields) {
+  fields.clear();
+  std::string::size_type begin = 0;
+  while (true) {
+    auto end = line.find(',', begin);
+    if (end == std::string::npos) {
+      end = line.size();
+    }
+    const auto first = line.find_first_not_of(" \t\r", begin);
+    const auto last = line.find_last_not_of(" \t\r", end == 0 ? 0 : end - 1);
+    if (first == std::string::npos || first >= end || last < first) {
+      fields.emplace_back();
+    } else {
+      fields.emplace_back(line, first, last - first + 1);
+    }
+    if (end == line.size()) {
+      return;
+    }
+    begin = end + 1;
+  }
+}
+
+} // namespace
+
+std::vector<int> read_csv_header(const std::string &line) {
+  std::vector<std::string> fields;
+  split_line(line, fields);
+
+  std::vector<int> aesthetics;
+  for (const auto &name : fields) {
+    const int a = aesthetic_index(name);
+    if (a == -1) {
+      throw Exception("csv column name " + name + " is not an aesthetic");
+    }
+    aesthetics.push_back(a);
+  }
+  return aesthetics;
+}
+
+bool read_csv_line(const std::string &line, const size_t columns,
+                   std::vector<float> &values, const int line_number) {
+  if (line.find_first_not_of(" \t\r") == std::string::npos) {
+    return false;
+  }
+
+  // parse each field in place, rather than splitting the line into strings
+  size_t n = 0;
+  std::string::size_type begin = 0;
+  while (begin <= line.size()) {
+    auto end = line.find(',', begin);
+    if (end == std::string::npos) {
+      end = line.size();
+    }
+    if (++n > columns) {
+      break;
+    }
+    const auto first = line.find_first_not_of(" \t\r", begin);
+    const auto last = line.find_last_not_of(" \t\r", end == 0 ? 0 : end - 1);
+    char *parsed = nullptr;
+    float value = 0;
+    if (first != std::string::npos && first < end && last >= first) {
+      value = std::strtof(line.c_str() + first, &parsed);
+    }
+    if (parsed != line.c_str() + last + 1) {
+      throw Exception("invalid value " + line.substr(begin, end - begin) +
+                      " on csv line " + std::to_string(line_number));
+    }
+    values.push_back(value);
+    begin = end + 1;
+  }
+  if (n != columns) {
+    throw Exception("wrong number of values on csv line " +
+                    std::to_string(line_number));
+  }
+  return true;
+}
+
+DataWithAesthetic read_csv(std::istream &in) {
+  std::string line;
+  if (!std::getline(in, line)) {
+    throw Exception("csv data has no header line");
+  }
+  const std::vector<int> aesthetics = read_csv_header(line);
+
+  std::vector<std::vector<float>> columns(aesthetics.size());
+  std::vector<float> values;
+  int line_number = 1;
+  while (std::getline(in, line)) {
+    ++line_number;
+    values.clear();
+    if (!read_csv_line(line, columns.size(), values, line_number)) {
+      continue;
+    }
+    for (size_t j = 0; j < values.size(); ++j) {
+      columns[j].push_back(values[j]);
+    }
+  }
+
+  auto raw = std::make_shared<RawData>();
+  for (const auto &column : columns) {
+    raw->add_column(column);
+  }
+  DataWithAesthetic data(raw);
+  for (size_t j = 0; j < aesthetics.size(); ++j) {
+    data.map(aesthetics[j], static_cast<int>(j));
+  }
+  return data;
+}
+
+} // namespace trase
@@ -0,0 +1,69 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file CsvFile.hpp
+/// Reads a dataset from comma separated values
+
+#ifndef CSV_FILE_H_
+#define CSV_FILE_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "frontend/Data.hpp"
+
+namespace trase {
+
+/// reads a dataset from comma separated values in \p in
+///
+/// The first line is a header naming the Aesthetic that each column is used
+/// for (e.g. "x,y,color"), every following non-empty line holds one float per
+/// column. Throws if a column name is not an aesthetic, or if a value cannot be
+/// read
+DataWithAesthetic read_csv(std::istream &in);
+
+/// parses the header \p line of csv data (see read_csv()), and returns the
+/// index of the Aesthetic of each column. Throws if a column name is not an
+/// aesthetic
+std::vector<int> read_csv_header(const std::string &line);
+
+/// parses \p line of csv data with \p columns columns, and appends its values
+/// to \p values. Returns false if the line is blank. Throws if a value cannot
+/// be read, using \p line_number in the message
+bool read_csv_line(const std::string &line, size_t columns,
+                   std::vector<float> &values, int line_number);
+
+} // namespace trase
+
+#endif // CSV_FILE_H_
@@ -0,0 +1,228 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file FileFollower.cpp
+
+#include "io/FileFollower.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "io/CsvFile.hpp"
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+// the most bytes read from the file before they are parsed, so that following
+// a large existing file does not need a copy of all of it in memory
+const size_t read_chunk_bytes = 1u << 20;
+
+std::string error_string() { return std::strerror(errno); }
+
+} // namespace
+
+FileFollower::FileFollower(const std::string &path)
+    : FileFollower(path, true, {}) {}
+
+FileFollower::FileFollower(const std::string &path,
+                           std::vector<int> aesthetics)
+    : FileFollower(path, false, std::move(aesthetics)) {
+  if (m_aesthetics.empty()) {
+    throw Exception("a binary log needs at least one column");
+  }
+  for (const int a : m_aesthetics) {
+    if (a < 0 || a >= Aesthetic::N) {
+      throw Exception("invalid aesthetic index " + std::to_string(a));
+    }
+  }
+}
+
+FileFollower::FileFollower(const std::string &path, const bool csv,
+                           std::vector<int> aesthetics)
+    : m_path(path), m_fd(-1), m_inotify(-1), m_csv(csv),
+      m_aesthetics(std::move(aesthetics)), m_offset(0), m_line_number(0) {
+  m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (m_fd == -1) {
+    throw Exception("unable to open " + path + ": " + error_string());
+  }
+  m_inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotify == -1 ||
+      ::inotify_add_watch(m_inotify, path.c_str(), IN_MODIFY) == -1) {
+    const std::string error = error_string();
+    ::close(m_fd);
+    if (m_inotify != -1) {
+      ::close(m_inotify);
+    }
+    throw Exception("unable to watch " + path + ": " + error);
+  }
+}
+
+FileFollower::~FileFollower() {
+  ::close(m_inotify);
+  ::close(m_fd);
+}
+
+DataWithAesthetic FileFollower::read() {
+  struct stat st;
+  if (::fstat(m_fd, &st) == -1) {
+    throw Exception("unable to stat " + m_path + ": " + error_string());
+  }
+  if (st.st_size < m_offset) {
+    throw Exception(m_path + " has been truncated");
+  }
+
+  std::vector<std::vector<float>> columns(m_aesthetics.size());
+  while (m_offset < st.st_size) {
+    const size_t n = std::min(read_chunk_bytes,
+                              static_cast<size_t>(st.st_size - m_offset));
+    const size_t old_size = m_pending.size();
+    m_pending.resize(old_size + n);
+    const ssize_t r = ::pread(m_fd, &m_pending[old_size], n, m_offset);
+    if (r <= 0) {
+      m_pending.resize(old_size);
+      if (r == -1 && errno == EINTR) {
+        continue;
+      }
+      if (r == 0) {
+        break;
+      }
+      throw Exception("unable to read " + m_path + ": " + error_string());
+    }
+    m_pending.resize(old_size + static_cast<size_t>(r));
+    m_offset += r;
+    parse(columns);
+  }
+
+  if (columns.empty() || columns[0].empty()) {
+    return DataWithAesthetic();
+  }
+  auto raw = std::make_shared<RawData>();
+  for (const auto &column : columns) {
+    raw->add_column(column);
+  }
+  DataWithAesthetic data(raw);
+  for (size_t j = 0; j < m_aesthetics.size(); ++j) {
+    data.map(m_aesthetics[j], static_cast<int>(j));
+  }
+  return data;
+}
+
+void FileFollower::parse(std::vector<std::vector<float>> &columns) {
+  if (!m_csv) {
+    const size_t cols = m_aesthetics.size();
+    const size_t record = cols * sizeof(float);
+    const size_t records = m_pending.size() / record;
+    std::vector<float> values(cols);
+    for (size_t i = 0; i < records; ++i) {
+      std::memcpy(values.data(), &m_pending[i * record], record);
+      for (size_t j = 0; j < cols; ++j) {
+        columns[j].push_back(values[j]);
+      }
+    }
+    m_pending.erase(0, records * record);
+    return;
+  }
+
+  std::string line;
+  std::vector<float> values;
+  std::string::size_type begin = 0;
+  for (auto end = m_pending.find('\n'); end != std::string::npos;
+       begin = end + 1, end = m_pending.find('\n', begin)) {
+    line.assign(m_pending, begin, end - begin);
+    ++m_line_number;
+    if (m_aesthetics.empty()) {
+      m_aesthetics = read_csv_header(line);
+      columns.resize(m_aesthetics.size());
+      continue;
+    }
+    values.clear();
+    if (read_csv_line(line, m_aesthetics.size(), values, m_line_number)) {
+      for (size_t j = 0; j < values.size(); ++j) {
+        columns[j].push_back(values[j]);
+      }
+    }
+  }
+  m_pending.erase(0, begin);
+}
+
+int FileFollower::poll(Plot1D &plot) {
+  const DataWithAesthetic rows = read();
+  if (rows.rows() == 0) {
+    return 0;
+  }
+  if (plot.data_size() == 0) {
+    plot.add_frame(rows, 0.f);
+  } else {
+    plot.append(rows);
+  }
+  return rows.rows();
+}
+
+bool FileFollower::wait(const int timeout_ms, const int batch_ms) {
+  pollfd fd{m_inotify, POLLIN, 0};
+  const int r = ::poll(&fd, 1, timeout_ms);
+  if (r == -1 && errno != EINTR) {
+    throw Exception("unable to wait for " + m_path + ": " + error_string());
+  }
+  if (r <= 0) {
+    return false;
+  }
+  drain();
+
+  // the writer is probably still going, give it time to finish the burst
+  if (batch_ms > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(batch_ms));
+    drain();
+  }
+  return true;
+}
+
+void FileFollower::drain() {
+  // large enough for many events, aligned as the kernel requires
+  alignas(inotify_event) char buffer[4096];
+  while (::read(m_inotify, buffer, sizeof(buffer)) > 0) {
+  }
+}
+
+} // namespace trase
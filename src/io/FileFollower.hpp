@@ -0,0 +1,130 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file FileFollower.hpp
+/// Reads the rows appended to a growing file, like `tail -f`
+
+#ifndef FILE_FOLLOWER_H_
+#define FILE_FOLLOWER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frontend/Data.hpp"
+#include "frontend/Plot1D.hpp"
+
+namespace trase {
+
+/// Follows an append-only file and reads the rows that are added to it
+///
+/// The file is either csv data (see read_csv()), or a binary log of records,
+/// each holding one float32 (in native byte order) per column. Each read only
+/// parses the bytes appended since the previous read; a partial line or record
+/// at the end of the file is kept until the rest of it has been written.
+///
+/// wait() uses inotify to sleep until the file is modified, and then waits a
+/// little longer so that a burst of writes is read (and plotted) in one go.
+/// Linux only.
+class FileFollower {
+  std::string m_path;
+  int m_fd;
+  int m_inotify;
+  bool m_csv;
+
+  /// the aesthetic index of each column, empty until the csv header is read
+  std::vector<int> m_aesthetics;
+
+  /// the offset of the first byte that has not been read
+  int64_t m_offset;
+
+  /// bytes that have been read but are not yet a complete line or record
+  std::string m_pending;
+
+  /// the number of csv lines parsed, for error messages
+  int m_line_number;
+
+public:
+  /// follows the csv file \p path, whose first line names the aesthetic of
+  /// each column. Throws if the file cannot be opened
+  explicit FileFollower(const std::string &path);
+
+  /// follows the binary log \p path, in which each record holds a value for
+  /// each of the aesthetic indices \p aesthetics. Throws if the file cannot be
+  /// opened
+  FileFollower(const std::string &path, std::vector<int> aesthetics);
+
+  ~FileFollower();
+
+  FileFollower(const FileFollower &) = delete;
+  FileFollower &operator=(const FileFollower &) = delete;
+
+  /// returns the complete rows appended to the file since the last call (or
+  /// since it was opened), without blocking. If there are none this is an
+  /// empty dataset. Throws if the file has been truncated, or if the data
+  /// cannot be parsed
+  DataWithAesthetic read();
+
+  /// reads the rows appended to the file (see read()) and adds them to the
+  /// latest frame of \p plot, or as its first frame if it has none
+  ///
+  /// \return the number of rows added
+  int poll(Plot1D &plot);
+
+  /// waits for the file to be modified
+  ///
+  /// \param timeout_ms the longest time to wait, in milliseconds (-1 waits
+  /// forever)
+  /// \param batch_ms once the file has been modified, how long to wait for
+  /// further writes before returning
+  /// \return true if the file was modified
+  bool wait(int timeout_ms, int batch_ms = 20);
+
+  /// returns the inotify file descriptor, which becomes readable when the file
+  /// is modified (e.g. to wait for several files with poll()). Call wait(0, 0)
+  /// to clear it
+  int notify_fd() const { return m_inotify; }
+
+private:
+  FileFollower(const std::string &path, bool csv, std::vector<int> aesthetics);
+
+  /// parses the complete lines or records in m_pending into \p columns
+  void parse(std::vector<std::vector<float>> &columns);
+
+  /// reads every pending inotify event
+  void drain();
+};
+
+} // namespace trase
+
+#endif // FILE_FOLLOWER_H_
@@ -0,0 +1,473 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file JsonLines.cpp
+
+#include "io/JsonLines.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "util/Exception.hpp"
+#include "util/Parallel.hpp"
+
+namespace trase {
+
+namespace {
+
+// the fewest bytes worth giving a thread of their own
+const size_t min_bytes_per_thread = 1u << 16;
+
+#if defined(__SSE2__)
+
+// returns a mask with a bit set for each of the 16 bytes at p that is c
+inline unsigned match(const __m128i bytes, const char c) {
+  return static_cast<unsigned>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(c))));
+}
+
+inline __m128i load(const char *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+#endif
+
+// returns the first quote or backslash in [p, end), or end
+const char *find_quote(const char *p, const char *end) {
+#if defined(__SSE2__)
+  for (; end - p >= 16; p += 16) {
+    const __m128i bytes = load(p);
+    const unsigned mask = match(bytes, '"') | match(bytes, '\\');
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+  while (p != end && *p != '"' && *p != '\\') {
+    ++p;
+  }
+  return p;
+}
+
+// returns the first quote, brace or bracket in [p, end), or end
+const char *find_nesting(const char *p, const char *end) {
+#if defined(__SSE2__)
+  for (; end - p >= 16; p += 16) {
+    const __m128i bytes = load(p);
+    const unsigned mask = match(bytes, '"') | match(bytes, '{') |
+                          match(bytes, '}') | match(bytes, '[') |
+                          match(bytes, ']');
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+  while (p != end && *p != '"' && *p != '{' && *p != '}' && *p != '[' &&
+         *p != ']') {
+    ++p;
+  }
+  return p;
+}
+
+// returns the number of lines in [p, end), counting a last line that has no
+// newline
+size_t count_lines(const char *p, const char *end) {
+  if (p == end) {
+    return 0;
+  }
+  const size_t unterminated = end[-1] == '\n' ? 0 : 1;
+  size_t n = 0;
+#if defined(__SSE2__)
+  for (; end - p >= 16; p += 16) {
+    n += static_cast<size_t>(__builtin_popcount(match(load(p), '\n')));
+  }
+#endif
+  n += static_cast<size_t>(std::count(p, end, '\n'));
+  return n + unterminated;
+}
+
+bool is_space(const char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+const char *skip_space(const char *p, const char *end) {
+  while (p != end && is_space(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+[[noreturn]] void fail(const size_t line_number, const std::string &what) {
+  throw Exception("invalid JSON on line " + std::to_string(line_number) +
+                  ": " + what);
+}
+
+// returns the end of the string that starts with the quote at p
+const char *skip_string(const char *p, const char *end,
+                        const size_t line_number) {
+  ++p;
+  while (true) {
+    p = find_quote(p, end);
+    if (p == end) {
+      fail(line_number, "unterminated string");
+    }
+    if (*p == '"') {
+      return p + 1;
+    }
+    // skip the escaped character, which may be a quote
+    p += 2;
+    if (p > end) {
+      fail(line_number, "unterminated string");
+    }
+  }
+}
+
+// returns the end of the value that starts at p, without parsing it
+const char *skip_value(const char *p, const char *end,
+                       const size_t line_number) {
+  if (*p == '"') {
+    return skip_string(p, end, line_number);
+  }
+  if (*p == '{' || *p == '[') {
+    int depth = 1;
+    ++p;
+    while (depth > 0) {
+      p = find_nesting(p, end);
+      if (p == end) {
+        fail(line_number, "unterminated object or array");
+      }
+      if (*p == '"') {
+        p = skip_string(p, end, line_number);
+        continue;
+      }
+      depth += *p == '{' || *p == '[' ? 1 : -1;
+      ++p;
+    }
+    return p;
+  }
+  // a number or literal
+  while (p != end && *p != ',' && *p != '}' && *p != ']' && !is_space(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+bool is_digit(const char c) { return c >= '0' && c <= '9'; }
+
+// parses the JSON number at p into value, and returns its end, or nullptr if
+// p is not a number
+const char *parse_number(const char *p, const char *end, float &value) {
+  static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                  1e18, 1e19, 1e20, 1e21, 1e22};
+  const bool negative = p != end && *p == '-';
+  if (negative) {
+    ++p;
+  }
+
+  // the first 19 significant digits, which fit in 64 bits, are plenty for a
+  // float
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  const char *begin = p;
+  for (; p != end && is_digit(*p); ++p) {
+    if (digits < 19) {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+      digits += mantissa != 0;
+    } else {
+      ++exponent;
+    }
+  }
+  if (p == begin) {
+    return nullptr;
+  }
+  if (p != end && *p == '.') {
+    begin = ++p;
+    for (; p != end && is_digit(*p); ++p) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        digits += mantissa != 0;
+        --exponent;
+      }
+    }
+    if (p == begin) {
+      return nullptr;
+    }
+  }
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    const bool negative_exponent = p != end && *p == '-';
+    if (p != end && (*p == '-' || *p == '+')) {
+      ++p;
+    }
+    begin = p;
+    int e = 0;
+    for (; p != end && is_digit(*p); ++p) {
+      e = std::min(e * 10 + (*p - '0'), 100000);
+    }
+    if (p == begin) {
+      return nullptr;
+    }
+    exponent += negative_exponent ? -e : e;
+  }
+
+  double v = static_cast<double>(mantissa);
+  if (mantissa != 0 && exponent != 0) {
+    if (exponent > 0 && exponent <= 22) {
+      v *= powers[exponent];
+    } else if (exponent < 0 && exponent >= -22) {
+      v /= powers[-exponent];
+    } else {
+      v *= std::pow(10.0, exponent);
+    }
+  }
+  value = static_cast<float>(negative ? -v : v);
+  return p;
+}
+
+// parses the JSON object on the line [p, end) into row, which has a value
+// for each of keys. Returns false if the line is blank
+bool parse_line(const char *p, const char *end,
+                const std::vector<std::string> &keys, float *row,
+                const size_t line_number) {
+  p = skip_space(p, end);
+  if (p == end) {
+    return false;
+  }
+  if (*p != '{') {
+    fail(line_number, "expected an object");
+  }
+  p = skip_space(p + 1, end);
+
+  unsigned found = 0;
+  const unsigned all = (1u << keys.size()) - 1;
+  while (p == end || *p != '}') {
+    if (p == end || *p != '"') {
+      fail(line_number, "expected a key");
+    }
+    const char *key = p + 1;
+    p = skip_string(p, end, line_number);
+    const size_t key_size = static_cast<size_t>(p - 1 - key);
+    p = skip_space(p, end);
+    if (p == end || *p != ':') {
+      fail(line_number, "expected a colon");
+    }
+    p = skip_space(p + 1, end);
+    if (p == end) {
+      fail(line_number, "expected a value");
+    }
+
+    size_t j = 0;
+    while (j < keys.size() &&
+           ((found & (1u << j)) != 0 || keys[j].size() != key_size ||
+            std::memcmp(keys[j].data(), key, key_size) != 0)) {
+      ++j;
+    }
+    if (j < keys.size()) {
+      p = parse_number(p, end, row[j]);
+      if (p == nullptr) {
+        fail(line_number, "field \"" + keys[j] + "\" is not a number");
+      }
+      found |= 1u << j;
+
+      // the same key may be mapped to several aesthetics
+      for (size_t k = j + 1; k < keys.size(); ++k) {
+        if (keys[k] == keys[j]) {
+          row[k] = row[j];
+          found |= 1u << k;
+        }
+      }
+      if (found == all) {
+        return true;
+      }
+    } else {
+      const char *value = p;
+      p = skip_value(p, end, line_number);
+      if (p == value) {
+        fail(line_number, "expected a value");
+      }
+    }
+
+    p = skip_space(p, end);
+    if (p != end && *p == ',') {
+      p = skip_space(p + 1, end);
+    } else if (p == end || *p != '}') {
+      fail(line_number, "expected a comma or closing brace");
+    }
+  }
+  for (size_t j = 0; j < keys.size(); ++j) {
+    if ((found & (1u << j)) == 0) {
+      fail(line_number, "no field \"" + keys[j] + "\"");
+    }
+  }
+  return true;
+}
+
+// the lines of the input parsed by one thread
+struct Chunk {
+  const char *begin;
+  const char *end;
+
+  // the number of lines before this chunk
+  size_t first_line;
+
+  // the number of lines in this chunk, and the number that were not blank
+  size_t lines;
+  size_t rows;
+
+  std::exception_ptr error;
+};
+
+} // namespace
+
+DataWithAesthetic
+read_json_lines(const char *data, const size_t size,
+                const std::map<std::string, std::string> &fields,
+                const int threads) {
+  if (fields.empty()) {
+    throw Exception("no fields to read from JSON lines");
+  }
+  std::vector<int> aesthetics;
+  std::vector<std::string> keys;
+  for (const auto &field : fields) {
+    const int a = aesthetic_index(field.first);
+    if (a == -1) {
+      throw Exception(field.first + " is not an aesthetic");
+    }
+    aesthetics.push_back(a);
+    keys.push_back(field.second);
+  }
+  const size_t cols = keys.size();
+
+  // split the input at the first newline after every nth of it
+  const int n = number_of_threads(
+      threads,
+      static_cast<int>(std::min<size_t>(size / min_bytes_per_thread, INT_MAX)),
+      1);
+  std::vector<Chunk> chunks(n);
+  const char *const end = data + size;
+  const char *begin = data;
+  for (int t = 0; t < n; ++t) {
+    const char *chunk_end = end;
+    if (t + 1 < n) {
+      chunk_end = std::max(begin, data + size / n * (t + 1));
+      chunk_end = std::find(chunk_end, end, '\n');
+      chunk_end = chunk_end == end ? end : chunk_end + 1;
+    }
+    chunks[t] = {begin, chunk_end, 0, 0, 0, nullptr};
+    begin = chunk_end;
+  }
+
+  // count the lines first, so that each thread knows where its rows go
+  parallel_rows(n, n, [&](int, int first, int last) {
+    for (int t = first; t < last; ++t) {
+      chunks[t].lines = count_lines(chunks[t].begin, chunks[t].end);
+    }
+  });
+  size_t lines = 0;
+  for (auto &chunk : chunks) {
+    chunk.first_line = lines;
+    lines += chunk.lines;
+  }
+
+  std::vector<float> matrix(lines * cols);
+  parallel_rows(n, n, [&](int, int first, int last) {
+    for (int t = first; t < last; ++t) {
+      Chunk &chunk = chunks[t];
+      float *row = matrix.data() + chunk.first_line * cols;
+      size_t line_number = chunk.first_line;
+      try {
+        for (const char *p = chunk.begin; p != chunk.end;) {
+          const char *eol = static_cast<const char *>(
+              std::memchr(p, '\n', static_cast<size_t>(chunk.end - p)));
+          eol = eol == nullptr ? chunk.end : eol;
+          if (parse_line(p, eol, keys, row, ++line_number)) {
+            row += cols;
+            ++chunk.rows;
+          }
+          p = eol == chunk.end ? eol : eol + 1;
+        }
+      } catch (...) {
+        chunk.error = std::current_exception();
+      }
+    }
+  });
+
+  // report the error on the earliest line, and close the gaps left by blank
+  // lines
+  size_t rows = 0;
+  for (const auto &chunk : chunks) {
+    if (chunk.error) {
+      std::rethrow_exception(chunk.error);
+    }
+    if (rows != chunk.first_line) {
+      std::copy_n(matrix.begin() + chunk.first_line * cols, chunk.rows * cols,
+                  matrix.begin() + rows * cols);
+    }
+    rows += chunk.rows;
+  }
+  if (rows == 0) {
+    return DataWithAesthetic();
+  }
+  matrix.resize(rows * cols);
+
+  DataWithAesthetic result(
+      std::make_shared<RawData>(static_cast<int>(cols), std::move(matrix)));
+  for (size_t j = 0; j < cols; ++j) {
+    result.map(aesthetics[j], static_cast<int>(j));
+  }
+  return result;
+}
+
+DataWithAesthetic
+read_json_lines(std::istream &in,
+                const std::map<std::string, std::string> &fields,
+                const int threads) {
+  const std::string buffer{std::istreambuf_iterator<char>(in),
+                           std::istreambuf_iterator<char>()};
+  return read_json_lines(buffer.data(), buffer.size(), fields, threads);
+}
+
+} // namespace trase
@@ -0,0 +1,80 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file JsonLines.hpp
+/// Reads a dataset from JSON lines, one object per line
+
+#ifndef JSON_LINES_H_
+#define JSON_LINES_H_
+
+#include <cstddef>
+#include <istream>
+#include <map>
+#include <string>
+
+#include "frontend/Data.hpp"
+
+namespace trase {
+
+/// reads a dataset from the \p size bytes of JSON lines at \p data
+///
+/// Each non-blank line is a JSON object, such as a metric emitted by a
+/// service. \p fields maps the name of an Aesthetic (e.g. "x") to the key of
+/// the top-level field whose numeric value is used for it (e.g. "time"); each
+/// field becomes a column of the dataset, and every other field is skipped
+/// without being parsed. Keys are compared byte for byte, without decoding
+/// escape sequences, and the first field with a matching key is used. A key
+/// may be given for several aesthetics, which then all take its value. Once
+/// every field has been found the rest of the line is not read.
+///
+/// The input is split into chunks of whole lines that are parsed on up to
+/// \p threads threads (or one per hardware thread if this is <= 0), and the
+/// values are written straight into the rows of the dataset. Strings and
+/// nested values are skipped with SSE2 where it is available.
+///
+/// Throws if a name in \p fields is not an aesthetic, if a line is not an
+/// object, or if it has no numeric value for one of the fields
+DataWithAesthetic
+read_json_lines(const char *data, size_t size,
+                const std::map<std::string, std::string> &fields,
+                int threads = 0);
+
+/// reads all of \p in and parses it as JSON lines (see above)
+DataWithAesthetic
+read_json_lines(std::istream &in,
+                const std::map<std::string, std::string> &fields,
+                int threads = 0);
+
+} // namespace trase
+
+#endif // JSON_LINES_H_
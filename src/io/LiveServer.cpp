@@ -0,0 +1,732 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file LiveServer.cpp
+
+#include "io/LiveServer.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "frontend/Histogram.hpp"
+#include "frontend/Line.hpp"
+#include "frontend/Points.hpp"
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+// the longest request header that is read before the connection is dropped
+const size_t max_request_bytes = 1u << 13;
+
+// the most connections served at once, each has its own thread
+const size_t max_connections = 64;
+
+// a comment is sent on an idle event stream this often, which detects clients
+// that have gone away
+const std::chrono::seconds keepalive(15);
+
+// the most events, and bytes of events, kept for clients that are behind
+const size_t max_tail_events = 1024;
+const size_t max_tail_bytes = 1u << 26;
+
+// once the latest frame of a plot has this many rows events, they are
+// replaced by a single frame event in the state sent to new clients
+const size_t max_rows_events = 64;
+
+const char *const page = R"html(<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<title>trase</title>
+</head>
+<body style="margin:0">
+<canvas id="figure"></canvas>
+<script>
+var canvas = document.getElementById('figure');
+var ctx = canvas.getContext('2d');
+var names = ['x', 'y', 'color', 'size'];
+var axes = [];
+var queued = false;
+
+function decode(text) {
+  var bytes = atob(text);
+  var view = new DataView(new ArrayBuffer(bytes.length));
+  for (var i = 0; i < bytes.length; ++i) {
+    view.setUint8(i, bytes.charCodeAt(i));
+  }
+  var values = new Float32Array(bytes.length / 4);
+  for (var i = 0; i < values.length; ++i) {
+    values[i] = view.getFloat32(4 * i, true);
+  }
+  return values;
+}
+
+function append(a, b) {
+  var c = new Float32Array(a.length + b.length);
+  c.set(a);
+  c.set(b, a.length);
+  return c;
+}
+
+function ratio(v, lim) { return (v - lim[0]) / ((lim[1] - lim[0]) || 1); }
+function scale(v, lim, a, b) { return a + ratio(v, lim) * (b - a); }
+function label(v) { return Number(v.toPrecision(3)).toString(); }
+
+function colormap(map, t) {
+  t = Math.min(Math.max(t, 0), 1) * (map.length - 1);
+  var i = Math.min(Math.floor(t), map.length - 2);
+  var w = t - i;
+  var c = [0, 1, 2].map(function(k) {
+    return Math.round((1 - w) * map[i][k] + w * map[i + 1][k]);
+  });
+  return 'rgb(' + c.join(',') + ')';
+}
+
+function draw_plot(axis, plot) {
+  var c = plot.columns, b = axis.box, lim = axis.limits;
+  if (!c.y || (!c.x && plot.geometry !== 'histogram')) return;
+  function px(v) { return scale(v, lim.x, b[0], b[2]); }
+  function py(v) { return scale(v, lim.y, b[3], b[1]); }
+  ctx.fillStyle = ctx.strokeStyle = plot.color;
+  if (plot.geometry === 'line') {
+    ctx.lineWidth = plot.line_width;
+    ctx.beginPath();
+    for (var i = 0; i < plot.rows; ++i) {
+      if (i === 0) ctx.moveTo(px(c.x[i]), py(c.y[i]));
+      else ctx.lineTo(px(c.x[i]), py(c.y[i]));
+    }
+    ctx.stroke();
+  } else if (plot.geometry === 'histogram') {
+    var dx = (plot.xlim[1] - plot.xlim[0]) / plot.rows;
+    for (var i = 0; i < plot.rows; ++i) {
+      var x0 = px(plot.xlim[0] + i * dx), x1 = px(plot.xlim[0] + (i + 1) * dx);
+      ctx.fillRect(x0, py(c.y[i]), x1 - x0, py(0) - py(c.y[i]));
+    }
+  } else {
+    for (var i = 0; i < plot.rows; ++i) {
+      var r = 1;
+      if (c.size && lim.size) {
+        r += ratio(c.size[i], lim.size) * 0.05 * (b[3] - b[1]);
+      }
+      if (c.color && lim.color) {
+        ctx.fillStyle = colormap(plot.colormap, ratio(c.color[i], lim.color));
+      }
+      ctx.beginPath();
+      ctx.arc(px(c.x[i]), py(c.y[i]), r, 0, 2 * Math.PI);
+      ctx.fill();
+    }
+  }
+}
+
+function draw() {
+  queued = false;
+  ctx.clearRect(0, 0, canvas.width, canvas.height);
+  ctx.font = '12px sans-serif';
+  axes.forEach(function(axis) {
+    var b = axis.box, lim = axis.limits;
+    ctx.strokeStyle = ctx.fillStyle = '#000';
+    ctx.lineWidth = 1;
+    ctx.strokeRect(b[0], b[1], b[2] - b[0], b[3] - b[1]);
+    ctx.textAlign = 'center';
+    ctx.fillText(axis.title, (b[0] + b[2]) / 2, b[1] - 8);
+    ctx.fillText(axis.xlabel, (b[0] + b[2]) / 2, b[3] + 32);
+    ctx.save();
+    ctx.translate(b[0] - 32, (b[1] + b[3]) / 2);
+    ctx.rotate(-Math.PI / 2);
+    ctx.fillText(axis.ylabel, 0, 0);
+    ctx.restore();
+    if (!lim.x || !lim.y) return;
+    ctx.fillText(label(lim.x[0]), b[0], b[3] + 16);
+    ctx.fillText(label(lim.x[1]), b[2], b[3] + 16);
+    ctx.textAlign = 'right';
+    ctx.fillText(label(lim.y[0]), b[0] - 4, b[3]);
+    ctx.fillText(label(lim.y[1]), b[0] - 4, b[1] + 12);
+    ctx.save();
+    ctx.beginPath();
+    ctx.rect(b[0], b[1], b[2] - b[0], b[3] - b[1]);
+    ctx.clip();
+    axis.plots.forEach(function(plot) { draw_plot(axis, plot); });
+    ctx.restore();
+  });
+}
+
+var source = new EventSource('events');
+function on(type, handle) {
+  source.addEventListener(type, function(e) {
+    handle(JSON.parse(e.data));
+    if (!queued) {
+      queued = true;
+      requestAnimationFrame(draw);
+    }
+  });
+}
+on('figure', function(d) {
+  canvas.width = d.width;
+  canvas.height = d.height;
+  axes = [];
+});
+on('axis', function(d) {
+  d.limits = {};
+  d.plots = [];
+  axes[d.axis] = d;
+});
+on('plot', function(d) {
+  d.rows = 0;
+  d.columns = {};
+  axes[d.axis].plots[d.plot] = d;
+});
+on('limits', function(d) { axes[d.axis].limits = d; });
+on('frame', function(d) {
+  var plot = axes[d.axis].plots[d.plot];
+  plot.rows = d.rows;
+  plot.columns = {};
+  if (d.xlim) plot.xlim = d.xlim;
+  names.forEach(function(k) {
+    if (d[k] !== undefined) plot.columns[k] = decode(d[k]);
+  });
+});
+on('rows', function(d) {
+  var plot = axes[d.axis].plots[d.plot];
+  plot.rows += d.rows;
+  names.forEach(function(k) {
+    if (d[k] !== undefined && plot.columns[k]) {
+      plot.columns[k] = append(plot.columns[k], decode(d[k]));
+    }
+  });
+});
+</script>
+</body>
+</html>
+)html";
+
+bool write_all(const int fd, const void *buffer, size_t n) {
+  auto p = static_cast<const char *>(buffer);
+  while (n > 0) {
+    // MSG_NOSIGNAL so a client disconnecting does not raise SIGPIPE
+    const ssize_t r = ::send(fd, p, n, MSG_NOSIGNAL);
+    if (r <= 0) {
+      return false;
+    }
+    p += r;
+    n -= static_cast<size_t>(r);
+  }
+  return true;
+}
+
+bool write_all(const int fd, const std::string &s) {
+  return write_all(fd, s.data(), s.size());
+}
+
+bool write_response(const int fd, const std::string &status,
+                    const std::string &type, const std::string &body) {
+  std::ostringstream header;
+  header << "HTTP/1.1 " << status << "\r\nContent-Type: " << type
+         << "\r\nContent-Length: " << body.size()
+         << "\r\nConnection: close\r\n\r\n";
+  return write_all(fd, header.str()) && write_all(fd, body);
+}
+
+/// reads the header of an HTTP request (the request line and header fields),
+/// or returns an empty string if this fails
+std::string read_request(const int fd) {
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos) {
+    if (request.size() > max_request_bytes) {
+      return "";
+    }
+    const ssize_t r = ::recv(fd, buffer, sizeof(buffer), 0);
+    if (r <= 0) {
+      return "";
+    }
+    request.append(buffer, static_cast<size_t>(r));
+  }
+  return request.substr(0, request.find("\r\n\r\n"));
+}
+
+/// returns the value of the header field \p name (in lower case) of \p
+/// request, or an empty string if there is no such field
+std::string header_field(const std::string &request, const std::string &name) {
+  size_t line = request.find("\r\n");
+  while (line != std::string::npos) {
+    line += 2;
+    const size_t end = std::min(request.find("\r\n", line), request.size());
+    const size_t colon = request.find(':', line);
+    if (colon < end && colon - line == name.size() &&
+        std::equal(name.begin(), name.end(), request.begin() + line,
+                   [](const char a, const char b) {
+                     return a == std::tolower(static_cast<unsigned char>(b));
+                   })) {
+      const size_t first = request.find_first_not_of(" \t", colon + 1);
+      const size_t last = request.find_last_not_of(" \t", end - 1);
+      return first < end ? request.substr(first, last + 1 - first) : "";
+    }
+    line = request.find("\r\n", line);
+  }
+  return "";
+}
+
+std::string json_string(const std::string &s) {
+  std::string out = "\"";
+  for (const char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escape[8];
+      std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+      out += escape;
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+/// writes the range of aesthetic \p a in \p limits as a JSON array, or null
+/// if the range is empty
+void write_range(std::ostream &out, const Limits &limits, const int a) {
+  if (!(limits.bmin[a] <= limits.bmax[a])) {
+    out << "null";
+    return;
+  }
+  out << '[' << limits.bmin[a] << ',' << limits.bmax[a] << ']';
+}
+
+/// writes the values in [begin, end) as base64 encoded little-endian floats
+template <typename Iterator>
+void write_base64(std::ostream &out, Iterator begin, const Iterator &end) {
+  const char *const digits =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string bytes;
+  bytes.reserve(4 * static_cast<size_t>(end - begin));
+  for (; begin != end; ++begin) {
+    uint32_t u;
+    const float f = *begin;
+    std::memcpy(&u, &f, sizeof(u));
+    for (int i = 0; i < 4; ++i) {
+      bytes += static_cast<char>((u >> (8 * i)) & 0xffu);
+    }
+  }
+
+  std::string text;
+  text.reserve((bytes.size() + 2) / 3 * 4);
+  for (size_t i = 0; i < bytes.size(); i += 3) {
+    const size_t n = std::min<size_t>(3, bytes.size() - i);
+    uint32_t group = 0;
+    for (size_t j = 0; j < 3; ++j) {
+      const auto byte = j < n ? static_cast<unsigned char>(bytes[i + j]) : 0u;
+      group = (group << 8u) | byte;
+    }
+    for (size_t j = 0; j < 4; ++j) {
+      text += j <= n ? digits[(group >> (18 - 6 * j)) & 0x3fu] : '=';
+    }
+  }
+  out << '"' << text << '"';
+}
+
+/// writes the rows from \p first onwards of each column of \p data that the
+/// page draws
+void write_columns(std::ostream &out, const DataWithAesthetic &data,
+                   const int first) {
+  out << ",\"rows\":" << data.rows() - first;
+  for (const int a : {Aesthetic::x::index, Aesthetic::y::index,
+                      Aesthetic::color::index, Aesthetic::size::index}) {
+    const int column = data.column(a);
+    if (column != -1) {
+      out << ",\"" << aesthetic_name(a) << "\":";
+      data.visit_columns(
+          [&](const auto begin) {
+            write_base64(out, begin + first, begin + data.rows());
+          },
+          column);
+    }
+  }
+}
+
+std::shared_ptr<const std::string> event(const char *type,
+                                         const std::string &data) {
+  return std::make_shared<const std::string>(std::string("event: ") + type +
+                                             "\ndata: " + data + "\n\n");
+}
+
+std::string geometry(Plot1D &plot) {
+  if (dynamic_cast<Points *>(&plot) != nullptr) {
+    return "points";
+  }
+  if (dynamic_cast<Histogram *>(&plot) != nullptr) {
+    return "histogram";
+  }
+  return "line";
+}
+
+} // namespace
+
+LiveServer::LiveServer(std::shared_ptr<Figure> figure, const int port,
+                       const std::string &address)
+    : m_figure(std::move(figure)), m_address(address), m_port(port),
+      m_fd(-1), m_stop(false), m_first_event(0), m_event_bytes(0) {
+  std::ostringstream data;
+  data << "{\"width\":" << m_figure->pixels().bmax[0]
+       << ",\"height\":" << m_figure->pixels().bmax[1] << '}';
+  m_figure_event = event("figure", data.str());
+}
+
+LiveServer::~LiveServer() { stop(); }
+
+void LiveServer::start() {
+  if (m_fd != -1) {
+    throw Exception("live server is already running");
+  }
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(m_port));
+  if (::inet_pton(AF_INET, m_address.c_str(), &addr.sin_addr) != 1) {
+    throw Exception("invalid IPv4 address: " + m_address);
+  }
+
+  m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (m_fd == -1) {
+    throw Exception("unable to create socket: " +
+                    std::string(std::strerror(errno)));
+  }
+  const int reuse = 1;
+  ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  socklen_t length = sizeof(addr);
+  if (::bind(m_fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) ==
+          -1 ||
+      ::listen(m_fd, SOMAXCONN) == -1 ||
+      ::getsockname(m_fd, reinterpret_cast<sockaddr *>(&addr), &length) ==
+          -1) {
+    const std::string error = std::strerror(errno);
+    ::close(m_fd);
+    m_fd = -1;
+    throw Exception("unable to listen on " + m_address + ":" +
+                    std::to_string(m_port) + ": " + error);
+  }
+  m_port = ntohs(addr.sin_port);
+
+  m_stop = false;
+  m_acceptor = std::thread([this]() { accept_connections(); });
+}
+
+void LiveServer::stop() {
+  if (m_fd == -1) {
+    return;
+  }
+  m_stop = true;
+
+  // wakes up the acceptor blocked in accept()
+  ::shutdown(m_fd, SHUT_RDWR);
+  m_acceptor.join();
+
+  // wakes up the connections waiting for a request or for new events
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &connection : m_connections) {
+      ::shutdown(connection->fd, SHUT_RDWR);
+    }
+    m_published_cv.notify_all();
+  }
+  for (const auto &connection : m_connections) {
+    connection->thread.join();
+    ::close(connection->fd);
+  }
+  m_connections.clear();
+
+  ::close(m_fd);
+  m_fd = -1;
+}
+
+int LiveServer::publish() {
+  // the changes are made to a copy of the published state, which replaces it
+  // at the same time as the events are published
+  std::vector<PublishedAxis> state = m_published;
+  std::vector<Event> events;
+  for (int a = 0; a < m_figure->number_of_axes(); ++a) {
+    Axis &axis = *m_figure->axis(a);
+    if (a == static_cast<int>(state.size())) {
+      const bfloat2_t &box = axis.pixels();
+      std::ostringstream data;
+      data << "{\"axis\":" << a << ",\"box\":[" << box.bmin[0] << ','
+           << box.bmin[1] << ',' << box.bmax[0] << ',' << box.bmax[1]
+           << "],\"title\":" << json_string(axis.get_title())
+           << ",\"xlabel\":" << json_string(axis.get_xlabel())
+           << ",\"ylabel\":" << json_string(axis.get_ylabel()) << '}';
+      events.push_back(event("axis", data.str()));
+      state.push_back({Limits(), {}, events.back(), nullptr});
+    }
+    PublishedAxis &published = state[a];
+
+    for (int p = 0; p < axis.number_of_plots(); ++p) {
+      Plot1D &plot = *axis.plot(p);
+      if (p == static_cast<int>(published.plots.size())) {
+        std::ostringstream data;
+        data << "{\"axis\":" << a << ",\"plot\":" << p
+             << ",\"geometry\":\"" << geometry(plot)
+             << "\",\"label\":" << json_string(plot.get_label())
+             << ",\"color\":\"" << plot.get_color().to_rgb_string()
+             << "\",\"line_width\":" << plot.get_line_width()
+             << ",\"colormap\":[";
+        const int samples = 9;
+        for (int i = 0; i < samples; ++i) {
+          const RGBA c = plot.get_colormap().to_color(i / (samples - 1.f));
+          data << (i ? "," : "") << '[' << c.r() << ',' << c.g() << ','
+               << c.b() << ']';
+        }
+        data << "]}";
+        events.push_back(event("plot", data.str()));
+        published.plots.push_back({0, 0, events.back(), {}});
+      }
+      PublishedPlot &sent = published.plots[p];
+      if (plot.data_size() == 0) {
+        continue;
+      }
+
+      // only the latest frame is sent, as the page only shows the latest
+      const size_t last = plot.data_size() - 1;
+      const DataWithAesthetic &data = plot.get_data(static_cast<int>(last));
+      const auto frame_event = [&]() {
+        std::ostringstream out;
+        out << "{\"axis\":" << a << ",\"plot\":" << p
+            << ",\"time\":" << plot.get_time(static_cast<int>(last));
+        if (geometry(plot) == "histogram") {
+          out << ",\"xlim\":";
+          write_range(out, data.limits(), Aesthetic::x::index);
+        }
+        write_columns(out, data, 0);
+        return event("frame", out.str() + "}");
+      };
+      if (plot.data_size() > sent.frames || data.rows() < sent.rows) {
+        events.push_back(frame_event());
+        sent.frame = {events.back()};
+      } else if (data.rows() > sent.rows) {
+        std::ostringstream out;
+        out << "{\"axis\":" << a << ",\"plot\":" << p;
+        write_columns(out, data, sent.rows);
+        events.push_back(event("rows", out.str() + "}"));
+        sent.frame.push_back(events.back());
+        if (sent.frame.size() > max_rows_events) {
+          sent.frame = {frame_event()};
+        }
+      }
+      sent.frames = plot.data_size();
+      sent.rows = data.rows();
+    }
+
+    const Limits &limits = axis.limits();
+    bool changed = false;
+    for (const int i : {Aesthetic::x::index, Aesthetic::y::index,
+                        Aesthetic::color::index, Aesthetic::size::index}) {
+      changed = changed || limits.bmin[i] != published.limits.bmin[i] ||
+                limits.bmax[i] != published.limits.bmax[i];
+    }
+    if (changed) {
+      std::ostringstream data;
+      data << "{\"axis\":" << a;
+      for (const int i : {Aesthetic::x::index, Aesthetic::y::index,
+                          Aesthetic::color::index, Aesthetic::size::index}) {
+        data << ",\"" << aesthetic_name(i) << "\":";
+        write_range(data, limits, i);
+      }
+      data << '}';
+      events.push_back(event("limits", data.str()));
+      published.limits = limits;
+      published.limits_event = events.back();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_published.swap(state);
+  for (const auto &e : events) {
+    m_events.push_back(e);
+    m_event_bytes += e->size();
+  }
+  while (!m_events.empty() && (m_events.size() > max_tail_events ||
+                               m_event_bytes > max_tail_bytes)) {
+    m_event_bytes -= m_events.front()->size();
+    m_events.pop_front();
+    ++m_first_event;
+  }
+  if (!events.empty()) {
+    m_published_cv.notify_all();
+  }
+  return static_cast<int>(events.size());
+}
+
+std::vector<LiveServer::Event> LiveServer::state_events() const {
+  std::vector<Event> events = {m_figure_event};
+  for (const auto &axis : m_published) {
+    events.push_back(axis.axis);
+    for (const auto &plot : axis.plots) {
+      events.push_back(plot.plot);
+      events.insert(events.end(), plot.frame.begin(), plot.frame.end());
+    }
+    if (axis.limits_event) {
+      events.push_back(axis.limits_event);
+    }
+  }
+  return events;
+}
+
+void LiveServer::accept_connections() {
+  while (!m_stop) {
+    const int fd = ::accept(m_fd, nullptr, nullptr);
+    if (fd == -1) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      return;
+    }
+
+    // a client that never finishes its request does not hold a thread forever
+    timeval timeout{5, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto i = m_connections.begin(); i != m_connections.end();) {
+      if ((*i)->done) {
+        (*i)->thread.join();
+        ::close((*i)->fd);
+        i = m_connections.erase(i);
+      } else {
+        ++i;
+      }
+    }
+    if (m_connections.size() >= max_connections) {
+      write_response(fd, "503 Service Unavailable", "text/plain",
+                     "too many connections\n");
+      ::close(fd);
+      continue;
+    }
+    m_connections.emplace_back(new Connection{fd, {false}, {}});
+    Connection &connection = *m_connections.back();
+    connection.thread = std::thread([this, &connection]() {
+      serve_connection(connection);
+      connection.done = true;
+    });
+  }
+}
+
+void LiveServer::serve_connection(Connection &connection) {
+  const std::string request = read_request(connection.fd);
+  if (request.empty()) {
+    return;
+  }
+  std::istringstream in(request.substr(0, request.find("\r\n")));
+  std::string method, target;
+  in >> method >> target;
+  target = target.substr(0, target.find('?'));
+
+  // a web page from another origin can reach a server on a loopback address
+  // by pointing its own host name at it (DNS rebinding), the Host it sends
+  // is then its own name
+  const std::string host = header_field(request, "host");
+  const std::string port = ":" + std::to_string(m_port);
+  if (host != "127.0.0.1" + port && host != "localhost" + port &&
+      host != m_address + port) {
+    write_response(connection.fd, "403 Forbidden", "text/plain",
+                   "unknown host\n");
+  } else if (method != "GET") {
+    write_response(connection.fd, "405 Method Not Allowed", "text/plain",
+                   "method not allowed\n");
+  } else if (target == "/") {
+    write_response(connection.fd, "200 OK", "text/html; charset=utf-8",
+                   page);
+  } else if (target == "/events") {
+    serve_events(connection.fd);
+  } else {
+    write_response(connection.fd, "404 Not Found", "text/plain",
+                   "not found\n");
+  }
+}
+
+void LiveServer::serve_events(const int fd) {
+  if (!write_all(fd, "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                     "Cache-Control: no-cache\r\n\r\n")) {
+    return;
+  }
+  // the sequence number of the next event to send, the state is sent first
+  // and whenever the client has fallen behind the events that are kept
+  uint64_t next = 0;
+  bool send_state = true;
+  std::vector<Event> events;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stop) {
+    const uint64_t end = m_first_event + m_events.size();
+    if (send_state || next < m_first_event) {
+      events = state_events();
+      send_state = false;
+    } else if (next == end) {
+      const bool published = m_published_cv.wait_for(lock, keepalive, [&]() {
+        return m_stop || next < m_first_event + m_events.size();
+      });
+      if (!published) {
+        lock.unlock();
+        if (!write_all(fd, ": keepalive\n\n")) {
+          return;
+        }
+        lock.lock();
+      }
+      continue;
+    } else {
+      const auto first = static_cast<ptrdiff_t>(next - m_first_event);
+      events.assign(m_events.begin() + first, m_events.end());
+    }
+    next = end;
+    lock.unlock();
+    for (const auto &e : events) {
+      if (!write_all(fd, *e)) {
+        return;
+      }
+    }
+    lock.lock();
+  }
+}
+
+} // namespace trase
@@ -0,0 +1,195 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file LiveServer.hpp
+/// Serves a live view of a figure to web browsers over HTTP
+
+#ifndef LIVE_SERVER_H_
+#define LIVE_SERVER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frontend/Figure.hpp"
+
+namespace trase {
+
+/// Serves a figure to web browsers, and pushes each new frame to them as it is
+/// added
+///
+/// `GET /` returns a page that draws the figure on a canvas, and `GET /events`
+/// is a stream of Server-Sent Events that describes the figure. A client that
+/// connects is first sent the current state of the figure (each axis and
+/// plot, the latest frame of each plot and the axis limits), and then each new
+/// event as it is published. The page shows the latest frame of each plot.
+///
+/// Only a bounded tail of recent events is kept, so the memory used does not
+/// grow with the length of a simulation. A client that falls further behind
+/// than the tail is sent the current state again.
+///
+/// Frames are only sent once: publish() compares the figure with what has
+/// already been published, and sends the axes, plots and frames that are new,
+/// the rows that have been appended to the latest frame of a plot, and the
+/// axis limits that have changed. The columns of each frame are sent as
+/// base64 encoded little-endian float32 arrays.
+///
+/// The event types, each with a JSON object as its data, are
+/// - figure: {width, height}, always the first event
+/// - axis: {axis, box: [x0, y0, x1, y1] in pixels, title, xlabel, ylabel}
+/// - plot: {axis, plot, geometry, label, color, colormap}
+/// - limits: {axis, x: [min, max], y, color, size}
+/// - frame: {axis, plot, time, rows, x, y, color, size}, replaces the rows of
+///   the plot (histograms also have xlim: [min, max])
+/// - rows: {axis, plot, rows, x, y, color, size}, appends to the rows of the
+///   plot
+///
+/// The server listens on a loopback address by default, and serves each
+/// connection on its own thread, up to 64 at once (later connections are
+/// refused with 503 until one closes). Requests must have a Host of
+/// `127.0.0.1:<port>`, `localhost:<port>` or `<address>:<port>`, others are
+/// refused with 403, so that other web pages cannot read the figure through
+/// DNS rebinding.
+class LiveServer {
+  std::shared_ptr<Figure> m_figure;
+  std::string m_address;
+  int m_port;
+  int m_fd;
+  std::atomic<bool> m_stop;
+  std::thread m_acceptor;
+
+  using Event = std::shared_ptr<const std::string>;
+
+  /// what publish() has sent of each plot
+  struct PublishedPlot {
+    size_t frames;
+    int rows;
+
+    /// the plot event
+    Event plot;
+
+    /// the frame event of the latest frame, then the rows events since
+    std::vector<Event> frame;
+  };
+
+  /// what publish() has sent of each axis
+  struct PublishedAxis {
+    Limits limits;
+    std::vector<PublishedPlot> plots;
+
+    /// the axis event, and the latest limits event (if any)
+    Event axis;
+    Event limits_event;
+  };
+
+  /// the figure event
+  Event m_figure_event;
+
+  /// the state of the figure that has been published, which is sent to each
+  /// new client. Only changed by publish(), which replaces it while holding
+  /// m_mutex, so it must be read with m_mutex held from any other thread
+  std::vector<PublishedAxis> m_published;
+
+  struct Connection {
+    int fd;
+    std::atomic<bool> done;
+    std::thread thread;
+  };
+
+  /// the latest events published, guarded by m_mutex
+  std::deque<Event> m_events;
+
+  /// the number of events published before m_events.front(), guarded by
+  /// m_mutex
+  uint64_t m_first_event;
+
+  /// the total size of m_events, guarded by m_mutex
+  size_t m_event_bytes;
+
+  /// the connections currently being served, guarded by m_mutex
+  std::list<std::unique_ptr<Connection>> m_connections;
+
+  std::mutex m_mutex;
+  std::condition_variable m_published_cv;
+
+public:
+  /// \param figure the figure to serve
+  /// \param port the TCP port to listen on, or 0 for any free port
+  /// \param address the IPv4 address to listen on
+  explicit LiveServer(std::shared_ptr<Figure> figure, int port = 0,
+                      const std::string &address = "127.0.0.1");
+
+  /// stops the server
+  ~LiveServer();
+
+  LiveServer(const LiveServer &) = delete;
+  LiveServer &operator=(const LiveServer &) = delete;
+
+  /// binds the socket and starts accepting connections. Returns immediately
+  void start();
+
+  /// closes every connection and stops accepting new ones
+  void stop();
+
+  /// returns the port the server is listening on (only known after start()
+  /// if the server was given port 0)
+  int port() const { return m_port; }
+
+  /// sends the changes to the figure since the last call to all clients
+  ///
+  /// This reads the figure, so it must not be called at the same time as the
+  /// figure is changed (e.g. call it after adding frames, on the same thread)
+  ///
+  /// \return the number of events published
+  int publish();
+
+private:
+  void accept_connections();
+  void serve_connection(Connection &connection);
+  void serve_events(int fd);
+
+  /// returns the events that describe the published state, in order.
+  /// m_mutex must be held
+  std::vector<Event> state_events() const;
+};
+
+} // namespace trase
+
+#endif // LIVE_SERVER_H_
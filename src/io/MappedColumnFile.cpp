@@ -0,0 +1,122 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "io/MappedColumnFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util/Exception.hpp"
+
+namespace trase {
+
+MappedColumnFileSource::MappedColumnFileSource(const std::string &filename,
+                                               const int block_rows)
+    : m_block_rows(block_rows), m_next_row(0) {
+  if (block_rows <= 0) {
+    throw Exception("block size must be positive");
+  }
+  {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+      throw Exception("unable to open " + filename);
+    }
+    m_header = read_column_header(in);
+  }
+
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw Exception("unable to open " + filename + ": " +
+                    std::strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw Exception("unable to stat " + filename);
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  const size_t expected = m_header.data_offset +
+                          m_header.aesthetics.size() *
+                              static_cast<size_t>(m_header.rows) *
+                              sizeof(float);
+  if (size < expected) {
+    close(fd);
+    throw Exception("unexpected end of column data in " + filename);
+  }
+
+  void *base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    throw Exception("unable to map " + filename + ": " + std::strerror(errno));
+  }
+  m_mapping = std::make_shared<ShmMapping>(base, size);
+
+  // the blocks are read in order
+  madvise(base, size, MADV_SEQUENTIAL);
+}
+
+bool MappedColumnFileSource::next(DataWithAesthetic &block) {
+  if (m_next_row >= m_header.rows) {
+    return false;
+  }
+  const int rows = static_cast<int>(
+      std::min<int64_t>(m_block_rows, m_header.rows - m_next_row));
+
+  const auto data = reinterpret_cast<const float *>(m_mapping->base() +
+                                                    m_header.data_offset);
+  std::vector<ColumnView> columns;
+  for (size_t j = 0; j < m_header.aesthetics.size(); ++j) {
+    columns.push_back(
+        {data + j * static_cast<size_t>(m_header.rows) +
+             static_cast<size_t>(m_next_row),
+         1});
+  }
+  m_next_row += rows;
+
+  block = DataWithAesthetic(
+      std::make_shared<RawData>(rows, std::move(columns), m_mapping));
+  for (size_t j = 0; j < m_header.aesthetics.size(); ++j) {
+    block.map(m_header.aesthetics[j], static_cast<int>(j));
+  }
+  return true;
+}
+
+} // namespace trase
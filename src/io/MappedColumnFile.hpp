@@ -0,0 +1,74 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file MappedColumnFile.hpp
+/// Zero-copy streaming of column files using a read-only memory mapping
+
+#ifndef MAPPED_COLUMN_FILE_H_
+#define MAPPED_COLUMN_FILE_H_
+
+#include <memory>
+#include <string>
+
+#include "frontend/Streaming.hpp"
+#include "io/ColumnFile.hpp"
+#include "io/SharedMemory.hpp"
+
+namespace trase {
+
+/// A RowSource that maps a column file into memory, and returns each block of
+/// rows as a read-only view onto the mapping
+///
+/// No data is copied, the operating system pages the file in as the blocks are
+/// read, so files much larger than the available memory can be processed. The
+/// mapping is kept alive by the blocks that point into it.
+class MappedColumnFileSource : public RowSource {
+  std::shared_ptr<ShmMapping> m_mapping;
+  ColumnFileHeader m_header;
+  int m_block_rows;
+  int64_t m_next_row;
+
+public:
+  /// maps the column file \p filename, throws if it cannot be opened or is not
+  /// a complete column file
+  ///
+  /// \param filename the column file to read
+  /// \param block_rows the number of rows in each block
+  MappedColumnFileSource(const std::string &filename, int block_rows);
+
+  bool next(DataWithAesthetic &block) override;
+};
+
+} // namespace trase
+
+#endif // MAPPED_COLUMN_FILE_H_
@@ -0,0 +1,440 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file NpyFile.cpp
+
+#include "io/NpyFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "io/SharedMemory.hpp"
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+bool little_endian() {
+  const uint16_t one = 1;
+  unsigned char first;
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+// bounds checked access to little-endian integers in a file
+struct Bytes {
+  const char *data;
+  size_t size;
+  const std::string &name;
+
+  uint64_t read(const uint64_t offset, const int bytes) const {
+    if (offset > size || size - offset < static_cast<size_t>(bytes)) {
+      throw Exception("unexpected end of " + name);
+    }
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+      value = value << 8 | static_cast<unsigned char>(data[offset + i]);
+    }
+    return value;
+  }
+};
+
+// returns the position of the value of the entry \p key in the Python dict
+// literal \p dict
+size_t find_value(const std::string &dict, const std::string &key) {
+  auto i = dict.find("'" + key + "'");
+  if (i == std::string::npos) {
+    throw Exception("npy header has no " + key);
+  }
+  i = dict.find(':', i);
+  i = dict.find_first_not_of(' ', i == std::string::npos ? i : i + 1);
+  if (i == std::string::npos) {
+    throw Exception("npy header has no value for " + key);
+  }
+  return i;
+}
+
+std::shared_ptr<ShmMapping> map_file(const std::string &filename) {
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw Exception("unable to open " + filename + ": " +
+                    std::strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw Exception("unable to stat " + filename);
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  if (size == 0) {
+    close(fd);
+    throw Exception(filename + " is empty");
+  }
+  void *base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    throw Exception("unable to map " + filename + ": " + std::strerror(errno));
+  }
+  return std::make_shared<ShmMapping>(base, size);
+}
+
+// converts column j of an array of T to float, into every stride'th element
+// of out
+template <typename T>
+void convert_column(const char *elements, const NpyHeader &header,
+                    const bool swap, const int64_t rows, const int64_t cols,
+                    const int64_t j, float *out, const size_t stride) {
+  char bytes[sizeof(T)];
+  T value;
+  for (int64_t i = 0; i < rows; ++i) {
+    const int64_t index = header.fortran_order ? j * rows + i : i * cols + j;
+    std::memcpy(bytes, elements + index * static_cast<int64_t>(sizeof(T)),
+                sizeof(T));
+    if (swap) {
+      std::reverse(bytes, bytes + sizeof(T));
+    }
+    std::memcpy(&value, bytes, sizeof(T));
+    out[i * stride] = static_cast<float>(value);
+  }
+}
+
+using ColumnConverter = void (*)(const char *, const NpyHeader &, bool,
+                                 int64_t, int64_t, int64_t, float *, size_t);
+
+ColumnConverter column_converter(const NpyHeader &header) {
+  if (header.kind == 'f') {
+    return header.item_size == 4 ? convert_column<float>
+                                 : convert_column<double>;
+  }
+  const bool sign = header.kind == 'i';
+  switch (header.item_size) {
+  case 1:
+    return sign ? convert_column<int8_t> : convert_column<uint8_t>;
+  case 2:
+    return sign ? convert_column<int16_t> : convert_column<uint16_t>;
+  case 4:
+    return sign ? convert_column<int32_t> : convert_column<uint32_t>;
+  default:
+    return sign ? convert_column<int64_t> : convert_column<uint64_t>;
+  }
+}
+
+// returns the columns of the .npy data in the size bytes at offset in mapping
+DataWithAesthetic read_array(const std::shared_ptr<ShmMapping> &mapping,
+                             const size_t offset, const size_t size,
+                             const std::vector<int> &aesthetics,
+                             const std::string &name) {
+  const char *data = mapping->base() + offset;
+  const NpyHeader header = read_npy_header(data, size);
+  if (header.shape.empty() || header.shape.size() > 2) {
+    throw Exception("the array in " + name +
+                    " must have one or two dimensions");
+  }
+  const int64_t rows = header.shape[0];
+  const int64_t cols = header.shape.size() == 2 ? header.shape[1] : 1;
+  if (rows > INT_MAX || cols > INT_MAX) {
+    throw Exception("the array in " + name + " is too large");
+  }
+  if (static_cast<int64_t>(aesthetics.size()) != cols) {
+    throw Exception("the array in " + name + " has " + std::to_string(cols) +
+                    " columns, but " + std::to_string(aesthetics.size()) +
+                    " aesthetics were given");
+  }
+  std::vector<int> used;
+  for (size_t j = 0; j < aesthetics.size(); ++j) {
+    if (aesthetics[j] < -1 || aesthetics[j] >= Aesthetic::N) {
+      throw Exception("invalid aesthetic index " +
+                      std::to_string(aesthetics[j]));
+    }
+    if (aesthetics[j] != -1) {
+      used.push_back(static_cast<int>(j));
+    }
+  }
+  if (used.empty()) {
+    throw Exception("no columns of " + name + " are used");
+  }
+  const uint64_t bytes = static_cast<uint64_t>(rows) *
+                         static_cast<uint64_t>(cols) *
+                         static_cast<uint64_t>(header.item_size);
+  if (bytes > size - header.data_offset) {
+    throw Exception("unexpected end of array data in " + name);
+  }
+
+  const char *elements = data + header.data_offset;
+  const bool swap = header.item_size > 1 &&
+                    (header.byte_order == '<') != little_endian();
+  // ColumnIterator offsets are ints, so the last element of each column (at
+  // rows * stride) must be within INT_MAX of its first
+  const auto fits = [&](const int64_t stride) {
+    return rows * stride <= static_cast<int64_t>(INT_MAX);
+  };
+  std::shared_ptr<RawData> raw;
+  if (header.kind == 'f' && header.item_size == 4 && !swap &&
+      reinterpret_cast<uintptr_t>(elements) % alignof(float) == 0 &&
+      (header.fortran_order || fits(cols))) {
+    const auto base = reinterpret_cast<const float *>(elements);
+    std::vector<ColumnView> columns;
+    for (const int j : used) {
+      if (header.fortran_order) {
+        columns.push_back({base + j * rows, 1});
+      } else {
+        columns.push_back({base + j, static_cast<int>(cols)});
+      }
+    }
+    raw = std::make_shared<RawData>(static_cast<int>(rows), std::move(columns),
+                                    mapping);
+  } else if (!fits(static_cast<int64_t>(used.size()))) {
+    // too large for a row major matrix, each column is copied into its own
+    // array instead
+    auto arrays = std::make_shared<std::vector<std::vector<float>>>(
+        used.size(), std::vector<float>(static_cast<size_t>(rows)));
+    std::vector<ColumnView> columns;
+    for (size_t k = 0; k < used.size(); ++k) {
+      column_converter(header)(elements, header, swap, rows, cols, used[k],
+                               (*arrays)[k].data(), 1);
+      columns.push_back({(*arrays)[k].data(), 1});
+    }
+    raw = std::make_shared<RawData>(static_cast<int>(rows), std::move(columns),
+                                    arrays);
+  } else {
+    std::vector<float> matrix(static_cast<size_t>(rows) * used.size());
+    for (size_t k = 0; k < used.size(); ++k) {
+      column_converter(header)(elements, header, swap, rows, cols, used[k],
+                               &matrix[k], used.size());
+    }
+    raw = std::make_shared<RawData>(static_cast<int>(used.size()),
+                                    std::move(matrix));
+  }
+
+  DataWithAesthetic result(raw);
+  for (size_t k = 0; k < used.size(); ++k) {
+    result.map(aesthetics[used[k]], static_cast<int>(k));
+  }
+  return result;
+}
+
+} // namespace
+
+NpyHeader read_npy_header(const char *data, const size_t size) {
+  const std::string name = "npy header";
+  const Bytes bytes{data, size, name};
+  if (size < 10 || std::memcmp(data, "\x93NUMPY", 6) != 0) {
+    throw Exception("not a npy file");
+  }
+  const int major = static_cast<unsigned char>(data[6]);
+  size_t prefix;
+  size_t length;
+  if (major == 1) {
+    prefix = 10;
+    length = bytes.read(8, 2);
+  } else if (major == 2 || major == 3) {
+    prefix = 12;
+    length = bytes.read(8, 4);
+  } else {
+    throw Exception("unsupported npy version " + std::to_string(major));
+  }
+  if (length > size - prefix) {
+    throw Exception("unexpected end of npy header");
+  }
+  const std::string dict(data + prefix, length);
+
+  NpyHeader header;
+  header.data_offset = prefix + length;
+
+  auto i = find_value(dict, "descr");
+  const char quote = dict[i];
+  const auto end = dict.find(quote, i + 1);
+  if ((quote != '\'' && quote != '"') || end == std::string::npos ||
+      end - i < 4) {
+    throw Exception("npy arrays of records are not supported");
+  }
+  const std::string descr = dict.substr(i + 1, end - i - 1);
+  header.byte_order = descr[0];
+  if (header.byte_order == '=') {
+    header.byte_order = little_endian() ? '<' : '>';
+  }
+  header.kind = descr[1];
+  header.item_size = std::atoi(descr.c_str() + 2);
+  const int s = header.item_size;
+  const bool supported =
+      (header.byte_order == '<' || header.byte_order == '>' ||
+       header.byte_order == '|') &&
+      ((header.kind == 'f' && (s == 4 || s == 8)) ||
+       ((header.kind == 'i' || header.kind == 'u') &&
+        (s == 1 || s == 2 || s == 4 || s == 8)) ||
+       (header.kind == 'b' && s == 1));
+  if (!supported) {
+    throw Exception("unsupported npy element type " + descr);
+  }
+  if (header.kind == 'b') {
+    header.kind = 'u';
+  }
+
+  i = find_value(dict, "fortran_order");
+  header.fortran_order = dict.compare(i, 4, "True") == 0;
+
+  i = find_value(dict, "shape");
+  const auto close = dict.find(')', i);
+  if (dict[i] != '(' || close == std::string::npos) {
+    throw Exception("invalid npy shape");
+  }
+  for (++i; i < close;) {
+    i = dict.find_first_not_of(" ,", i);
+    if (i >= close) {
+      break;
+    }
+    char *parsed = nullptr;
+    const long long n = std::strtoll(dict.c_str() + i, &parsed, 10);
+    if (parsed == dict.c_str() + i || n < 0) {
+      throw Exception("invalid npy shape");
+    }
+    header.shape.push_back(n);
+    i = static_cast<size_t>(parsed - dict.c_str());
+    // Python 2 long integers end with an L
+    if (dict[i] == 'L') {
+      ++i;
+    }
+  }
+  return header;
+}
+
+DataWithAesthetic read_npy(const std::string &filename,
+                           const std::vector<int> &aesthetics) {
+  const auto mapping = map_file(filename);
+  return read_array(mapping, 0, mapping->size(), aesthetics, filename);
+}
+
+DataWithAesthetic read_npz(const std::string &filename,
+                           const std::string &member,
+                           const std::vector<int> &aesthetics) {
+  const auto mapping = map_file(filename);
+  const Bytes zip{mapping->base(), mapping->size(), filename};
+
+  // the end of central directory record is at the end of the file, followed
+  // by a comment of up to 64k
+  if (zip.size < 22) {
+    throw Exception(filename + " is not a npz file");
+  }
+  const uint64_t last = zip.size - 22;
+  uint64_t eocd = last + 1;
+  for (uint64_t p = last + 1; p-- > 0 && last - p <= 0xffff;) {
+    if (zip.read(p, 4) == 0x06054b50) {
+      eocd = p;
+      break;
+    }
+  }
+  if (eocd > last) {
+    throw Exception(filename + " is not a npz file");
+  }
+  uint64_t entries = zip.read(eocd + 10, 2);
+  uint64_t directory = zip.read(eocd + 16, 4);
+  if ((entries == 0xffff || directory == 0xffffffff) && eocd >= 20 &&
+      zip.read(eocd - 20, 4) == 0x07064b50) {
+    const uint64_t eocd64 = zip.read(eocd - 12, 8);
+    if (zip.read(eocd64, 4) != 0x06064b50) {
+      throw Exception("invalid zip64 directory in " + filename);
+    }
+    entries = zip.read(eocd64 + 32, 8);
+    directory = zip.read(eocd64 + 48, 8);
+  }
+
+  uint64_t p = directory;
+  for (uint64_t e = 0; e < entries; ++e) {
+    if (zip.read(p, 4) != 0x02014b50) {
+      throw Exception("invalid zip directory in " + filename);
+    }
+    const uint64_t name_length = zip.read(p + 28, 2);
+    const uint64_t extra_length = zip.read(p + 30, 2);
+    const uint64_t comment_length = zip.read(p + 32, 2);
+    if (p + 46 > zip.size || name_length > zip.size - (p + 46)) {
+      throw Exception("unexpected end of " + filename);
+    }
+    const std::string name(zip.data + p + 46, name_length);
+    if (name != member && name != member + ".npy") {
+      p += 46 + name_length + extra_length + comment_length;
+      continue;
+    }
+
+    if (zip.read(p + 10, 2) != 0) {
+      throw Exception(name + " in " + filename +
+                      " is compressed, save it with numpy.savez");
+    }
+    uint64_t size = zip.read(p + 24, 4);
+    uint64_t local = zip.read(p + 42, 4);
+
+    // sizes and offsets too large for 32 bits are in the zip64 extra field
+    for (uint64_t x = p + 46 + name_length;
+         x + 4 <= p + 46 + name_length + extra_length;) {
+      const uint64_t id = zip.read(x, 2);
+      const uint64_t length = zip.read(x + 2, 2);
+      if (id == 1) {
+        uint64_t field = x + 4;
+        if (size == 0xffffffff) {
+          size = zip.read(field, 8);
+          field += 8;
+        }
+        if (zip.read(p + 20, 4) == 0xffffffff) {
+          field += 8;
+        }
+        if (local == 0xffffffff) {
+          local = zip.read(field, 8);
+        }
+      }
+      x += 4 + length;
+    }
+
+    if (zip.read(local, 4) != 0x04034b50) {
+      throw Exception("invalid zip entry for " + name + " in " + filename);
+    }
+    const uint64_t offset =
+        local + 30 + zip.read(local + 26, 2) + zip.read(local + 28, 2);
+    if (offset > zip.size || size > zip.size - offset) {
+      throw Exception("unexpected end of " + filename);
+    }
+    return read_array(mapping, offset, size, aesthetics,
+                      name + " in " + filename);
+  }
+  throw Exception("no array named " + member + " in " + filename);
+}
+
+} // namespace trase
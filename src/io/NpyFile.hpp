@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file NpyFile.hpp
+/// Zero-copy reading of NumPy .npy files and .npz archives
+///
+/// A .npy file is a short header, describing the type and shape of an array,
+/// followed by the elements of the array. A .npz file is a zip archive of .npy
+/// files, one for each array.
+
+#ifndef NPY_FILE_H_
+#define NPY_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frontend/Data.hpp"
+
+namespace trase {
+
+/// the header at the start of a .npy file
+struct NpyHeader {
+  /// '<' (little-endian), '>' (big-endian) or '|' (single bytes)
+  char byte_order;
+
+  /// 'f' (floating point), 'i' (signed), 'u' (unsigned) or 'b' (bool)
+  char kind;
+
+  /// the number of bytes in each element
+  int item_size;
+
+  /// true if the array is stored in column major order
+  bool fortran_order;
+
+  /// the size of each dimension of the array
+  std::vector<int64_t> shape;
+
+  /// the offset in bytes from the start of the file to the first element
+  size_t data_offset;
+};
+
+/// parses the header of the .npy data in the \p size bytes at \p data. Throws
+/// if this is not a .npy header, or if the elements are not numbers
+NpyHeader read_npy_header(const char *data, size_t size);
+
+/// maps the .npy file \p filename into memory and returns the columns of its
+/// array as a dataset
+///
+/// The array is a vector, which is a single column, or a matrix with a column
+/// for each element of its second dimension. Each column j is used for the
+/// aesthetic index aesthetics[j], or is skipped if that is -1.
+///
+/// An array of native-endian float32 is not copied: the columns are read-only
+/// views onto the mapping (strided in C order, contiguous in Fortran order),
+/// which is kept alive by the dataset. The used columns of any other
+/// float, int, unsigned or bool array are converted to float32, as are those
+/// of a C order array with more than INT_MAX elements (the most a strided
+/// column can span).
+///
+/// Throws if the file cannot be read, if the array is not a vector or a
+/// matrix, or if \p aesthetics does not have one entry per column
+DataWithAesthetic read_npy(const std::string &filename,
+                           const std::vector<int> &aesthetics);
+
+/// maps the .npz archive \p filename into memory and returns the columns of
+/// the array \p member (e.g. "positions", or "positions.npy"), as read_npy()
+/// does for a .npy file
+///
+/// Only members that are stored without compression (as by numpy.savez(),
+/// rather than numpy.savez_compressed()) can be read. A float32 member is only
+/// a view onto the mapping if its data is aligned to 4 bytes in the archive,
+/// otherwise it is copied.
+DataWithAesthetic read_npz(const std::string &filename,
+                           const std::string &member,
+                           const std::vector<int> &aesthetics);
+
+} // namespace trase
+
+#endif // NPY_FILE_H_
@@ -0,0 +1,123 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "io/PlotSpec.hpp"
+
+#include <sstream>
+
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+float parse_pixels(const std::string &key, const std::string &value) {
+  std::istringstream ss(value);
+  float pixels;
+  if (!(ss >> pixels) || pixels <= 0.f) {
+    throw Exception("invalid value for " + key + ": " + value);
+  }
+  return pixels;
+}
+
+} // namespace
+
+PlotSpec parse_plot_spec(const std::string &text) {
+  PlotSpec spec;
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    const auto equals = line.find('=');
+    if (equals == std::string::npos) {
+      throw Exception("expected key=value in plot spec, got: " + line);
+    }
+    const std::string key = line.substr(0, equals);
+    const std::string value = line.substr(equals + 1);
+
+    if (key == "geometry") {
+      if (value != "line" && value != "points" && value != "histogram") {
+        throw Exception("unknown geometry " + value);
+      }
+      spec.geometry = value;
+    } else if (key == "width") {
+      spec.width = parse_pixels(key, value);
+    } else if (key == "height") {
+      spec.height = parse_pixels(key, value);
+    } else if (key == "title") {
+      spec.title = value;
+    } else if (key == "xlabel") {
+      spec.xlabel = value;
+    } else if (key == "ylabel") {
+      spec.ylabel = value;
+    } else if (key == "label") {
+      spec.label = value;
+    } else if (key == "legend") {
+      spec.legend = value == "true" || value == "1";
+    } else {
+      throw Exception("unknown key in plot spec: " + key);
+    }
+  }
+  return spec;
+}
+
+std::shared_ptr<Figure> make_figure(const PlotSpec &spec,
+                                    const DataWithAesthetic &data) {
+  auto fig = figure({{spec.width, spec.height}});
+  auto ax = fig->axis();
+
+  std::shared_ptr<Plot1D> plot;
+  if (spec.geometry == "points") {
+    plot = ax->points(data);
+  } else if (spec.geometry == "histogram") {
+    plot = ax->histogram(data);
+  } else {
+    plot = ax->line(data);
+  }
+  plot->set_label(spec.label);
+
+  ax->title(spec.title.c_str());
+  ax->xlabel(spec.xlabel.c_str());
+  ax->ylabel(spec.ylabel.c_str());
+  if (spec.legend) {
+    ax->legend();
+  }
+  return fig;
+}
+
+} // namespace trase
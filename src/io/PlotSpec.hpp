@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file PlotSpec.hpp
+/// A small text description of a single-axis figure
+
+#ifndef PLOT_SPEC_H_
+#define PLOT_SPEC_H_
+
+#include <memory>
+#include <string>
+
+#include "frontend/Data.hpp"
+#include "frontend/Figure.hpp"
+
+namespace trase {
+
+/// Describes a figure with a single axis and a single plot
+///
+/// A PlotSpec is written as one `key=value` pair per line, lines starting with
+/// '#' are ignored, e.g.
+///
+///     geometry=points
+///     width=400
+///     title=particle positions
+///     legend=true
+///
+/// The available keys are the members of this struct.
+struct PlotSpec {
+  /// one of "line", "points" or "histogram"
+  std::string geometry{"line"};
+  float width{800.f};
+  float height{600.f};
+  std::string title;
+  std::string xlabel;
+  std::string ylabel;
+  std::string label;
+  bool legend{false};
+};
+
+/// parses a PlotSpec from its text description. Throws on unknown keys or
+/// invalid values
+PlotSpec parse_plot_spec(const std::string &text);
+
+/// creates a new Figure described by \p spec, plotting \p data
+std::shared_ptr<Figure> make_figure(const PlotSpec &spec,
+                                    const DataWithAesthetic &data);
+
+} // namespace trase
+
+#endif // PLOT_SPEC_H_
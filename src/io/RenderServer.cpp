@@ -0,0 +1,434 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "io/RenderServer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef TRASE_BACKEND_GL
+#include "backend/BackendGL.hpp"
+#endif
+#include "backend/BackendSVG.hpp"
+#include "frontend/Figure.hpp"
+#include "io/ColumnFile.hpp"
+#include "io/PlotSpec.hpp"
+#include "util/Exception.hpp"
+#include "util/Png.hpp"
+
+namespace trase {
+
+namespace {
+
+const uint32_t request_magic = 0x54525251; // "TRRQ"
+const uint32_t status_ok = 0;
+const uint32_t status_error = 1;
+
+// limit on the size of the spec of a single request, to stop a bad client
+// from making the server allocate arbitrary amounts of memory (the payload is
+// limited by RenderServer::m_max_payload_bytes)
+const uint32_t max_spec_bytes = 1u << 16;
+
+// a client that stops in the middle of a request does not hold a worker for
+// longer than this
+const timeval request_timeout = {5, 0};
+
+sockaddr_un socket_address(const std::string &path) {
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    throw Exception("socket path is too long: " + path);
+  }
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  return addr;
+}
+
+// returns false if the peer closed the connection before all bytes were read
+bool read_all(const int fd, void *buffer, size_t n) {
+  auto p = static_cast<char *>(buffer);
+  while (n > 0) {
+    const ssize_t r = ::read(fd, p, n);
+    if (r <= 0) {
+      return false;
+    }
+    p += r;
+    n -= static_cast<size_t>(r);
+  }
+  return true;
+}
+
+bool write_all(const int fd, const void *buffer, size_t n) {
+  auto p = static_cast<const char *>(buffer);
+  while (n > 0) {
+    // MSG_NOSIGNAL so a client disconnecting does not raise SIGPIPE
+    const ssize_t r = ::send(fd, p, n, MSG_NOSIGNAL);
+    if (r <= 0) {
+      return false;
+    }
+    p += r;
+    n -= static_cast<size_t>(r);
+  }
+  return true;
+}
+
+template <typename T> bool read_value(const int fd, T &value) {
+  return read_all(fd, &value, sizeof(T));
+}
+
+template <typename T> bool write_value(const int fd, const T &value) {
+  return write_all(fd, &value, sizeof(T));
+}
+
+bool write_response(const int fd, const uint32_t status,
+                    const std::string &body) {
+  return write_value(fd, status) &&
+         write_value(fd, static_cast<uint64_t>(body.size())) &&
+         write_all(fd, body.data(), body.size());
+}
+
+std::string render(const uint32_t format, const std::string &spec_text,
+                   const std::string &payload) {
+  if (format != static_cast<uint32_t>(RenderFormat::svg) &&
+      format != static_cast<uint32_t>(RenderFormat::png)) {
+    throw Exception("render server only supports svg and png output");
+  }
+  std::istringstream in(payload);
+  const DataWithAesthetic data = read_columns(in);
+  auto fig = make_figure(parse_plot_spec(spec_text), data);
+
+  std::ostringstream out;
+  if (format == static_cast<uint32_t>(RenderFormat::png)) {
+#ifdef TRASE_BACKEND_GL
+    BackendGL backend;
+    backend.offscreen();
+    fig->draw(backend, 0.f);
+    write_png(out, backend.image_width(), backend.image_height(),
+              backend.image().data());
+#else
+    throw Exception("png output needs trase to be built with OpenGL");
+#endif
+  } else {
+    BackendSVG backend(out);
+    fig->draw(backend);
+  }
+  return out.str();
+}
+
+} // namespace
+
+RenderServer::RenderServer(const std::string &socket_path, const int threads,
+                           const uint64_t max_payload_bytes)
+    : m_path(socket_path), m_threads(threads),
+      m_max_payload_bytes(max_payload_bytes), m_fd(-1), m_stop(false),
+      m_wake{-1, -1} {
+  if (m_threads <= 0) {
+    m_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+RenderServer::~RenderServer() { stop(); }
+
+void RenderServer::start() {
+  if (m_fd != -1) {
+    throw Exception("render server is already running");
+  }
+  const sockaddr_un addr = socket_address(m_path);
+
+  m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (m_fd == -1) {
+    throw Exception("unable to create socket: " +
+                    std::string(std::strerror(errno)));
+  }
+  ::unlink(m_path.c_str());
+  if (::bind(m_fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) ==
+          -1 ||
+      ::listen(m_fd, SOMAXCONN) == -1 || ::pipe(m_wake) == -1) {
+    const std::string error = std::strerror(errno);
+    ::close(m_fd);
+    m_fd = -1;
+    throw Exception("unable to listen on " + m_path + ": " + error);
+  }
+
+  // the poller only accepts when poll() says a client is waiting, and must
+  // not block if it has gone away since
+  ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+  ::fcntl(m_wake[1], F_SETFL, ::fcntl(m_wake[1], F_GETFL) | O_NONBLOCK);
+
+  m_stop = false;
+  m_poller = std::thread([this]() { poll_connections(); });
+  for (int i = 0; i < m_threads; ++i) {
+    m_workers.emplace_back([this]() { serve(); });
+  }
+}
+
+void RenderServer::stop() {
+  if (m_fd == -1) {
+    return;
+  }
+
+  // wakes up the poller, the idle workers and the workers waiting for a
+  // client
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    for (const int fd : m_connections) {
+      ::shutdown(fd, SHUT_RDWR);
+    }
+    m_ready_cv.notify_all();
+  }
+  wake_poller();
+  m_poller.join();
+  for (auto &worker : m_workers) {
+    worker.join();
+  }
+  m_workers.clear();
+
+  for (const int fd : m_connections) {
+    ::close(fd);
+  }
+  m_connections.clear();
+  m_ready.clear();
+  m_idle.clear();
+
+  ::close(m_wake[0]);
+  ::close(m_wake[1]);
+  ::close(m_fd);
+  m_fd = -1;
+  ::unlink(m_path.c_str());
+}
+
+void RenderServer::wake_poller() {
+  const char byte = 0;
+  // if the pipe is full the poller is already going to wake up
+  if (::write(m_wake[1], &byte, 1) == -1) {
+    return;
+  }
+}
+
+void RenderServer::poll_connections() {
+  // the connections waiting for a request
+  std::vector<int> idle;
+  std::vector<pollfd> fds;
+  while (!m_stop) {
+    fds.assign({{m_fd, POLLIN, 0}, {m_wake[0], POLLIN, 0}});
+    for (const int fd : idle) {
+      fds.push_back({fd, POLLIN, 0});
+    }
+    if (::poll(fds.data(), fds.size(), -1) == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+
+    if (fds[1].revents != 0) {
+      char buffer[64];
+      if (::read(m_wake[0], buffer, sizeof(buffer)) <= 0) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(m_mutex);
+      idle.insert(idle.end(), m_idle.begin(), m_idle.end());
+      m_idle.clear();
+    }
+
+    // queue the connections with a request (or that have been closed, which
+    // the worker finds out when it reads the request)
+    std::vector<int> ready;
+    for (size_t i = 2; i < fds.size(); ++i) {
+      if (fds[i].revents != 0) {
+        ready.push_back(fds[i].fd);
+      }
+    }
+    if (!ready.empty()) {
+      idle.erase(std::remove_if(idle.begin(), idle.end(),
+                                [&](const int fd) {
+                                  return std::find(ready.begin(), ready.end(),
+                                                   fd) != ready.end();
+                                }),
+                 idle.end());
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_ready.insert(m_ready.end(), ready.begin(), ready.end());
+      m_ready_cv.notify_all();
+    }
+
+    if (fds[0].revents != 0) {
+      const int fd = ::accept(m_fd, nullptr, nullptr);
+      if (fd == -1) {
+        if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN ||
+            errno == EWOULDBLOCK) {
+          continue;
+        }
+        return;
+      }
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &request_timeout,
+                   sizeof(request_timeout));
+
+      // registered before it is served, so that stop() always shuts it down
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_stop) {
+        ::close(fd);
+        return;
+      }
+      m_connections.insert(fd);
+      idle.push_back(fd);
+    }
+  }
+}
+
+void RenderServer::serve() {
+  while (true) {
+    int fd;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_ready_cv.wait(lock, [this]() { return m_stop || !m_ready.empty(); });
+      if (m_stop) {
+        return;
+      }
+      fd = m_ready.front();
+      m_ready.pop_front();
+    }
+
+    const bool keep = serve_request(fd);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop) {
+      // closed by stop()
+      return;
+    }
+    if (keep) {
+      m_idle.push_back(fd);
+      wake_poller();
+    } else {
+      m_connections.erase(fd);
+      ::close(fd);
+    }
+  }
+}
+
+bool RenderServer::serve_request(const int fd) {
+  uint32_t magic, format, spec_size;
+  uint64_t payload_size;
+  if (!read_value(fd, magic)) {
+    return false;
+  }
+  if (magic != request_magic) {
+    write_response(fd, status_error, "invalid request");
+    return false;
+  }
+  if (!read_value(fd, format) || !read_value(fd, spec_size) ||
+      spec_size > max_spec_bytes) {
+    return false;
+  }
+  std::string spec(spec_size, ' ');
+  if (!read_all(fd, &spec[0], spec.size()) ||
+      !read_value(fd, payload_size)) {
+    return false;
+  }
+  if (payload_size > m_max_payload_bytes) {
+    write_response(fd, status_error, "request payload is too large");
+    return false;
+  }
+  std::string payload(payload_size, ' ');
+  if (!read_all(fd, &payload[0], payload.size())) {
+    return false;
+  }
+
+  uint32_t status = status_ok;
+  std::string body;
+  try {
+    body = render(format, spec, payload);
+  } catch (std::exception &e) {
+    status = status_error;
+    body = e.what();
+  }
+  return write_response(fd, status, body);
+}
+
+std::string render_remote(const std::string &socket_path,
+                          const std::string &spec,
+                          const DataWithAesthetic &data,
+                          const RenderFormat format) {
+  const sockaddr_un addr = socket_address(socket_path);
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1) {
+    throw Exception("unable to create socket: " +
+                    std::string(std::strerror(errno)));
+  }
+  if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) ==
+      -1) {
+    const std::string error = std::strerror(errno);
+    ::close(fd);
+    throw Exception("unable to connect to " + socket_path + ": " + error);
+  }
+
+  std::ostringstream columns;
+  write_columns(columns, data);
+  const std::string payload = columns.str();
+
+  uint32_t status;
+  uint64_t size;
+  std::string body;
+  bool ok = write_value(fd, request_magic) &&
+            write_value(fd, static_cast<uint32_t>(format)) &&
+            write_value(fd, static_cast<uint32_t>(spec.size())) &&
+            write_all(fd, spec.data(), spec.size()) &&
+            write_value(fd, static_cast<uint64_t>(payload.size())) &&
+            write_all(fd, payload.data(), payload.size()) &&
+            read_value(fd, status) && read_value(fd, size);
+  if (ok) {
+    body.resize(size);
+    ok = read_all(fd, &body[0], body.size());
+  }
+  ::close(fd);
+
+  if (!ok) {
+    throw Exception("connection to render server " + socket_path + " failed");
+  }
+  if (status != status_ok) {
+    throw Exception("render server error: " + body);
+  }
+  return body;
+}
+
+} // namespace trase
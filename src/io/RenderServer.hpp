@@ -0,0 +1,153 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file RenderServer.hpp
+/// A long-lived local render service listening on a Unix domain socket
+
+#ifndef RENDER_SERVER_H_
+#define RENDER_SERVER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frontend/Data.hpp"
+
+namespace trase {
+
+/// the output formats that can be requested from a RenderServer
+enum class RenderFormat : unsigned int { svg = 0, png = 1, pdf = 2 };
+
+/// Renders figures for clients connecting over a Unix domain socket
+///
+/// Each request contains a PlotSpec (as text), the requested RenderFormat and
+/// the data to plot in the column file format (see ColumnFile.hpp). The
+/// response is the rendered figure, or an error message. A connection may be
+/// used for any number of requests.
+///
+/// One thread waits for requests on every open connection, and queues each
+/// connection that has one. A fixed number of worker threads serve the queued
+/// requests, one request at a time, so the number of figures rendered
+/// concurrently is bounded regardless of the number of clients, and idle
+/// connections do not hold a worker.
+///
+/// RenderFormat::svg is always supported. RenderFormat::png is rendered with
+/// BackendGL off-screen, so it needs trase to be built with the OpenGL
+/// backend and off-screen support. Requests for other formats get an error
+/// response.
+class RenderServer {
+  std::string m_path;
+  int m_threads;
+  uint64_t m_max_payload_bytes;
+  int m_fd;
+  std::atomic<bool> m_stop;
+  std::thread m_poller;
+  std::vector<std::thread> m_workers;
+
+  /// a pipe written to wake up the poller, when a connection is handed back
+  /// to it or the server stops
+  int m_wake[2];
+
+  /// every open connection, shut down by stop(), guarded by m_mutex
+  std::set<int> m_connections;
+
+  /// connections with a request to be served, guarded by m_mutex
+  std::deque<int> m_ready;
+
+  /// connections handed back to the poller to wait for their next request,
+  /// guarded by m_mutex
+  std::vector<int> m_idle;
+
+  std::mutex m_mutex;
+  std::condition_variable m_ready_cv;
+
+public:
+  /// \param socket_path the filesystem path of the socket
+  /// \param threads the number of worker threads (default: one per core)
+  /// \param max_payload_bytes the largest data payload accepted in a request,
+  /// larger requests close the connection
+  explicit RenderServer(const std::string &socket_path, int threads = 0,
+                        uint64_t max_payload_bytes = 1ull << 28);
+
+  /// stops the server
+  ~RenderServer();
+
+  RenderServer(const RenderServer &) = delete;
+  RenderServer &operator=(const RenderServer &) = delete;
+
+  /// binds the socket (replacing any stale socket file) and starts the poller
+  /// and worker threads. Returns immediately
+  void start();
+
+  /// stops accepting connections, waits for the workers to finish their
+  /// current request and removes the socket file
+  void stop();
+
+  /// returns the number of worker threads
+  int threads() const { return m_threads; }
+
+private:
+  void poll_connections();
+  void serve();
+
+  /// reads and answers a single request on \p fd
+  ///
+  /// \return false if the connection should be closed
+  bool serve_request(int fd);
+
+  /// wakes up the poller blocked in poll()
+  void wake_poller();
+};
+
+/// sends a render request to the RenderServer listening on \p socket_path
+///
+/// \param socket_path the filesystem path of the server socket
+/// \param spec the PlotSpec text describing the figure
+/// \param data the data to plot
+/// \param format the requested output format
+/// \return the bytes of the rendered figure. Throws with the server's error
+/// message if the request fails
+std::string render_remote(const std::string &socket_path,
+                          const std::string &spec,
+                          const DataWithAesthetic &data,
+                          RenderFormat format = RenderFormat::svg);
+
+} // namespace trase
+
+#endif // RENDER_SERVER_H_
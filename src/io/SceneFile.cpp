@@ -0,0 +1,439 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "io/SceneFile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "frontend/Histogram.hpp"
+#include "frontend/Line.hpp"
+#include "frontend/Points.hpp"
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+const char scene_magic[4] = {'T', 'R', 'S', 'C'};
+const uint32_t scene_version = 1;
+
+// the type of each plot
+enum PlotType : uint32_t { line = 0, points = 1, histogram = 2 };
+
+// writes values to a stream, every value is padded to a multiple of 4 bytes so
+// that the float data in the file is aligned
+class SceneWriter {
+  std::ostream &m_out;
+
+public:
+  explicit SceneWriter(std::ostream &out) : m_out(out) {}
+
+  template <typename T> void value(const T &v) {
+    static_assert(sizeof(T) % 4 == 0, "scene values must be 4 byte multiples");
+    m_out.write(reinterpret_cast<const char *>(&v), sizeof(T));
+  }
+
+  void bytes(const char *v, const size_t n) { m_out.write(v, n); }
+
+  void floats(const float *v, const size_t n) {
+    m_out.write(reinterpret_cast<const char *>(v), n * sizeof(float));
+  }
+
+  void string(const std::string &s) {
+    value(static_cast<uint32_t>(s.size()));
+    m_out.write(s.data(), s.size());
+    const char padding[4] = {0};
+    m_out.write(padding, (4 - s.size() % 4) % 4);
+  }
+
+  void times(const std::vector<float> &t) {
+    value(static_cast<uint32_t>(t.size()));
+    floats(t.data(), t.size());
+  }
+
+  void box(const bfloat2_t &b) {
+    value(b.bmin);
+    value(b.bmax);
+  }
+};
+
+// reads values from a buffer, checking that they are within the buffer
+class SceneReader {
+  const char *m_data;
+  size_t m_size;
+  size_t m_pos;
+
+public:
+  SceneReader(const char *data, const size_t size)
+      : m_data(data), m_size(size), m_pos(0) {}
+
+  // returns a pointer to the next n bytes, and moves past them
+  const char *take(const size_t n) {
+    if (n > m_size - m_pos) {
+      throw Exception("unexpected end of scene data");
+    }
+    const char *p = m_data + m_pos;
+    m_pos += (n + 3) / 4 * 4;
+    if (m_pos > m_size) {
+      m_pos = m_size;
+    }
+    return p;
+  }
+
+  // returns the number of bytes that have not been read
+  size_t remaining() const { return m_size - m_pos; }
+
+  template <typename T> T value() {
+    T v;
+    std::memcpy(&v, take(sizeof(T)), sizeof(T));
+    return v;
+  }
+
+  const float *floats(const size_t n) {
+    return reinterpret_cast<const float *>(take(n * sizeof(float)));
+  }
+
+  std::string string() {
+    const auto n = value<uint32_t>();
+    return std::string(take(n), n);
+  }
+
+  std::vector<float> times() {
+    const auto n = value<uint32_t>();
+    const float *t = floats(n);
+    return std::vector<float>(t, t + n);
+  }
+
+  bfloat2_t box() {
+    bfloat2_t b;
+    b.bmin = value<vfloat2_t>();
+    b.bmax = value<vfloat2_t>();
+    return b;
+  }
+};
+
+} // namespace
+
+/// Has access to the internals of the Drawable tree, to read and write it
+class SceneIO {
+public:
+  static void write(SceneWriter &out, const Figure &fig);
+  static std::shared_ptr<Figure> read(SceneReader &in,
+                                      const std::shared_ptr<const void> &owner);
+
+private:
+  static void write(SceneWriter &out, const Drawable &drawable);
+  static void write(SceneWriter &out, const Axis &axis);
+  static void write(SceneWriter &out, const Plot1D &plot);
+  static void write(SceneWriter &out, const DataWithAesthetic &data);
+
+  static void read(SceneReader &in, Drawable &drawable);
+  static void read(SceneReader &in, Axis &axis,
+                   const std::shared_ptr<const void> &owner);
+  static void read(SceneReader &in, Plot1D &plot,
+                   const std::shared_ptr<const void> &owner);
+  static DataWithAesthetic read_data(SceneReader &in,
+                                     const std::shared_ptr<const void> &owner);
+};
+
+void SceneIO::write(SceneWriter &out, const Drawable &drawable) {
+  out.box(drawable.m_area);
+  out.value(drawable.m_time_span);
+  out.times(drawable.m_times);
+}
+
+void SceneIO::read(SceneReader &in, Drawable &drawable) {
+  drawable.m_area = in.box();
+  drawable.m_time_span = in.value<float>();
+  drawable.m_times = in.times();
+  if (drawable.m_times.empty()) {
+    throw Exception("scene has a drawable without frame times");
+  }
+}
+
+void SceneIO::write(SceneWriter &out, const Figure &fig) {
+  out.bytes(scene_magic, sizeof(scene_magic));
+  out.value(scene_version);
+  write(out, static_cast<const Drawable &>(fig));
+  out.value(static_cast<uint32_t>(fig.m_children.size()));
+  for (const auto &child : fig.m_children) {
+    write(out, dynamic_cast<const Axis &>(*child));
+  }
+}
+
+std::shared_ptr<Figure>
+SceneIO::read(SceneReader &in, const std::shared_ptr<const void> &owner) {
+  const char *magic = in.take(sizeof(scene_magic));
+  if (!std::equal(magic, magic + sizeof(scene_magic), scene_magic)) {
+    throw Exception("data is not a trase scene");
+  }
+  if (in.value<uint32_t>() != scene_version) {
+    throw Exception("unsupported scene version");
+  }
+
+  auto fig = std::make_shared<Figure>(std::array<float, 2>{{0.f, 0.f}});
+  read(in, static_cast<Drawable &>(*fig));
+  fig->m_pixels = fig->m_area;
+
+  const auto n = in.value<uint32_t>();
+  for (uint32_t i = 0; i < n; ++i) {
+    auto axis = std::make_shared<Axis>(fig.get(), bfloat2_t());
+    fig->m_children.push_back(axis);
+    read(in, *axis, owner);
+    axis->resize(fig->m_pixels);
+  }
+  return fig;
+}
+
+void SceneIO::write(SceneWriter &out, const Axis &axis) {
+  write(out, static_cast<const Drawable &>(axis));
+  out.value(axis.m_limits.bmin);
+  out.value(axis.m_limits.bmax);
+  out.value(static_cast<int32_t>(axis.m_sig_digits));
+  out.value(static_cast<int32_t>(axis.m_nx_ticks));
+  out.value(static_cast<int32_t>(axis.m_ny_ticks));
+  out.value(axis.m_tick_len);
+  out.value(axis.m_line_width);
+  out.value(axis.m_font_size);
+  out.string(axis.m_font_face);
+  out.string(axis.m_xlabel);
+  out.string(axis.m_ylabel);
+  out.string(axis.m_title);
+  out.value(static_cast<uint32_t>(axis.m_legend));
+
+  out.value(static_cast<uint32_t>(axis.m_children.size()));
+  for (const auto &child : axis.m_children) {
+    const Plot1D &plot = dynamic_cast<const Plot1D &>(*child);
+    PlotType type = line;
+    if (dynamic_cast<const Points *>(&plot) != nullptr) {
+      type = points;
+    } else if (dynamic_cast<const Histogram *>(&plot) != nullptr) {
+      type = histogram;
+    }
+    out.value(static_cast<uint32_t>(type));
+    write(out, plot);
+  }
+}
+
+void SceneIO::read(SceneReader &in, Axis &axis,
+                   const std::shared_ptr<const void> &owner) {
+  read(in, static_cast<Drawable &>(axis));
+  axis.m_limits.bmin = in.value<Limits::vector_t>();
+  axis.m_limits.bmax = in.value<Limits::vector_t>();
+  axis.m_sig_digits = in.value<int32_t>();
+  axis.m_nx_ticks = in.value<int32_t>();
+  axis.m_ny_ticks = in.value<int32_t>();
+  axis.m_tick_len = in.value<float>();
+  axis.m_line_width = in.value<float>();
+  axis.m_font_size = in.value<float>();
+  axis.m_font_face = in.string();
+  axis.m_xlabel = in.string();
+  axis.m_ylabel = in.string();
+  axis.m_title = in.string();
+  axis.m_legend = in.value<uint32_t>() != 0;
+
+  const auto n = in.value<uint32_t>();
+  for (uint32_t i = 0; i < n; ++i) {
+    std::shared_ptr<Plot1D> plot;
+    switch (in.value<uint32_t>()) {
+    case line:
+      plot = std::make_shared<Line>(&axis);
+      break;
+    case points:
+      plot = std::make_shared<Points>(&axis);
+      break;
+    case histogram:
+      plot = std::make_shared<Histogram>(&axis);
+      break;
+    default:
+      throw Exception("scene contains an unknown plot type");
+    }
+    axis.m_children.push_back(plot);
+    read(in, *plot, owner);
+  }
+}
+
+void SceneIO::write(SceneWriter &out, const Plot1D &plot) {
+  // frames added lazily are stored transformed
+  plot.transform_frames();
+  write(out, static_cast<const Drawable &>(plot));
+  out.string(plot.m_label);
+  out.value(plot.m_line_width);
+  out.value(static_cast<int32_t>(plot.m_color.r()));
+  out.value(static_cast<int32_t>(plot.m_color.g()));
+  out.value(static_cast<int32_t>(plot.m_color.b()));
+  out.value(static_cast<int32_t>(plot.m_color.a()));
+  out.value(plot.m_limits.bmin);
+  out.value(plot.m_limits.bmax);
+
+  // viridis is the only colormap, so the colormap is not stored
+  out.value(static_cast<uint32_t>(plot.m_data.size()));
+  for (const auto &data : plot.m_data) {
+    write(out, data);
+  }
+}
+
+void SceneIO::read(SceneReader &in, Plot1D &plot,
+                   const std::shared_ptr<const void> &owner) {
+  read(in, static_cast<Drawable &>(plot));
+  plot.m_label = in.string();
+  plot.m_line_width = in.value<float>();
+  const auto r = in.value<int32_t>();
+  const auto g = in.value<int32_t>();
+  const auto b = in.value<int32_t>();
+  const auto a = in.value<int32_t>();
+  plot.m_color = RGBA(r, g, b, a);
+  plot.m_limits.bmin = in.value<Limits::vector_t>();
+  plot.m_limits.bmax = in.value<Limits::vector_t>();
+
+  // the plot is drawn with a data frame for each frame time
+  const auto n = in.value<uint32_t>();
+  if (n == 0) {
+    throw Exception("scene has a plot without data");
+  }
+  if (n != plot.m_times.size()) {
+    throw Exception("scene has a plot with a data frame count that does not "
+                    "match its frame times");
+  }
+  for (uint32_t i = 0; i < n; ++i) {
+    plot.m_data.push_back(read_data(in, owner));
+  }
+}
+
+void SceneIO::write(SceneWriter &out, const DataWithAesthetic &data) {
+  // only the selected rows are stored
+  out.value(static_cast<int32_t>(data.rows()));
+  out.value(static_cast<int32_t>(data.cols()));
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    out.value(static_cast<int32_t>(data.column(a)));
+  }
+  out.value(data.m_limits.bmin);
+  out.value(data.m_limits.bmax);
+
+  // each column is stored contiguously
+  std::vector<float> column(data.rows());
+  for (int j = 0; j < data.cols(); ++j) {
+    data.visit_columns(
+        [&](const auto begin) {
+          std::copy(begin, begin + data.rows(), column.begin());
+        },
+        j);
+    out.floats(column.data(), column.size());
+  }
+}
+
+DataWithAesthetic
+SceneIO::read_data(SceneReader &in, const std::shared_ptr<const void> &owner) {
+  const auto rows = in.value<int32_t>();
+  const auto cols = in.value<int32_t>();
+  if (rows < 0 || cols < 0) {
+    throw Exception("scene data has a negative size");
+  }
+  int32_t map[Aesthetic::N];
+  for (auto &column : map) {
+    column = in.value<int32_t>();
+    if (column < -1 || column >= cols) {
+      throw Exception("scene data maps an aesthetic to a missing column");
+    }
+  }
+  Limits limits;
+  limits.bmin = in.value<Limits::vector_t>();
+  limits.bmax = in.value<Limits::vector_t>();
+
+  const size_t column_bytes = static_cast<size_t>(rows) * sizeof(float);
+  if (column_bytes * static_cast<size_t>(cols) > in.remaining()) {
+    throw Exception("unexpected end of scene data");
+  }
+
+  // columns after the last one used by an aesthetic are never read, so they
+  // are skipped rather than given a view each (there can be any number of
+  // them in a frame without rows)
+  int used = 0;
+  for (const int column : map) {
+    used = std::max(used, column + 1);
+  }
+  std::vector<ColumnView> columns;
+  for (int j = 0; j < used; ++j) {
+    columns.push_back({in.floats(static_cast<size_t>(rows)), 1});
+  }
+  in.take(column_bytes * static_cast<size_t>(cols - used));
+
+  DataWithAesthetic data(std::make_shared<RawData>(rows, columns, owner));
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    if (map[a] != -1) {
+      data.m_map[a] = map[a];
+    }
+  }
+  data.m_limits = limits;
+  return data;
+}
+
+void save_figure(std::ostream &out, const Figure &fig) {
+  SceneWriter writer(out);
+  SceneIO::write(writer, fig);
+}
+
+void save_figure(const std::string &filename, const Figure &fig) {
+  std::ofstream out(filename, std::ios::binary);
+  if (!out) {
+    throw Exception("unable to open " + filename);
+  }
+  save_figure(out, fig);
+  if (!out) {
+    throw Exception("unable to write " + filename);
+  }
+}
+
+std::shared_ptr<Figure> load_figure(std::istream &in) {
+  // the plot data are views onto this buffer, which is aligned for floats
+  auto buffer = std::make_shared<std::vector<float>>();
+  std::vector<char> bytes{std::istreambuf_iterator<char>(in),
+                          std::istreambuf_iterator<char>()};
+  buffer->resize((bytes.size() + sizeof(float) - 1) / sizeof(float));
+  std::memcpy(buffer->data(), bytes.data(), bytes.size());
+  return load_figure(reinterpret_cast<const char *>(buffer->data()),
+                     bytes.size(), buffer);
+}
+
+std::shared_ptr<Figure> load_figure(const char *data, const size_t size,
+                                    std::shared_ptr<const void> owner) {
+  SceneReader reader(data, size);
+  return SceneIO::read(reader, owner);
+}
+
+} // namespace trase
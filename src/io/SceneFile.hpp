@@ -0,0 +1,75 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file SceneFile.hpp
+/// Saving and loading of complete Figure trees in a compact binary format
+
+#ifndef SCENE_FILE_H_
+#define SCENE_FILE_H_
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "frontend/Figure.hpp"
+
+namespace trase {
+
+/// writes the Figure \p fig, its axes, plots, frame times and data to \p out
+///
+/// The figure can be loaded again (in another process) with load_figure() or
+/// map_figure() and drawn using any backend. The data stored for each plot is
+/// the output of its Transform, the Transform itself is not stored (plots in
+/// a loaded figure use the Identity transform).
+void save_figure(std::ostream &out, const Figure &fig);
+
+/// writes the Figure \p fig to the file \p filename, see save_figure()
+void save_figure(const std::string &filename, const Figure &fig);
+
+/// reads a Figure written by save_figure() from \p in. Throws if the data is
+/// not a valid scene
+std::shared_ptr<Figure> load_figure(std::istream &in);
+
+/// reads a Figure written by save_figure() from the \p size bytes at \p data,
+/// which must be aligned to 4 bytes
+///
+/// The data of each plot is not copied, it is a read-only view onto \p data.
+/// These views hold a copy of \p owner, which must keep \p data alive.
+std::shared_ptr<Figure> load_figure(const char *data, size_t size,
+                                    std::shared_ptr<const void> owner);
+
+} // namespace trase
+
+#endif // SCENE_FILE_H_
@@ -0,0 +1,432 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "io/SharedMemory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <iterator>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+const uint32_t shm_magic = 0x74727368; // "trsh"
+const uint32_t shm_version = 4;
+
+// the number of consumers that can have a segment open at once
+const int shm_max_consumers = 16;
+
+// stored in ShmHeader::consumers while a dead consumer's leases are removed
+const int32_t shm_reclaiming = -1;
+
+// all slots (and the matrix following each slot header) are aligned to this
+const size_t shm_align = 64;
+
+struct ShmHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slots;
+  uint32_t max_values;
+  uint64_t slot_bytes;
+  std::atomic<uint64_t> published;
+
+  // the pid of the process that owns each consumer record, 0 if it is free
+  std::atomic<int32_t> consumers[shm_max_consumers];
+};
+
+struct ShmSlot {
+  // non-zero while the producer is writing to the slot
+  std::atomic<uint32_t> writing;
+
+  // the number of frames read from this slot that each consumer still holds
+  std::atomic<uint32_t> leases[shm_max_consumers];
+
+  int32_t rows;
+  int32_t cols;
+  float time;
+  uint64_t sequence;
+  int32_t map[Aesthetic::N];
+};
+
+size_t round_up(const size_t n) {
+  return (n + shm_align - 1) / shm_align * shm_align;
+}
+
+const size_t header_bytes = round_up(sizeof(ShmHeader));
+const size_t slot_header_bytes = round_up(sizeof(ShmSlot));
+
+ShmHeader *header(const ShmMapping &mapping) {
+  return reinterpret_cast<ShmHeader *>(mapping.base());
+}
+
+ShmSlot *slot(const ShmMapping &mapping, const uint64_t sequence) {
+  const ShmHeader *h = header(mapping);
+  const size_t offset =
+      header_bytes + static_cast<size_t>(sequence % h->slots) * h->slot_bytes;
+  return reinterpret_cast<ShmSlot *>(mapping.base() + offset);
+}
+
+float *slot_matrix(ShmSlot *s) {
+  return reinterpret_cast<float *>(reinterpret_cast<char *>(s) +
+                                   slot_header_bytes);
+}
+
+// removes the leases of consumer record \p c if the process that owns it no
+// longer exists (e.g. it crashed while holding frames), and frees the record.
+// Returns true if the record was reclaimed
+bool reclaim_if_dead(const ShmMapping &mapping, const int c) {
+  ShmHeader *h = header(mapping);
+  int32_t pid = h->consumers[c].load(std::memory_order_acquire);
+  if (pid <= 0 || kill(pid, 0) == 0 || errno != ESRCH) {
+    return false;
+  }
+  // only one process removes the leases, the record cannot be taken by a new
+  // consumer until this is done
+  if (!h->consumers[c].compare_exchange_strong(pid, shm_reclaiming)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < h->slots; ++i) {
+    slot(mapping, i)->leases[c].store(0, std::memory_order_relaxed);
+  }
+  h->consumers[c].store(0, std::memory_order_release);
+  return true;
+}
+
+// returns true if no consumer holds a lease on \p s, reclaiming the leases of
+// consumers that no longer exist
+bool unleased(const ShmMapping &mapping, ShmSlot *s) {
+  for (int c = 0; c < shm_max_consumers; ++c) {
+    if (s->leases[c].load() != 0 && !reclaim_if_dead(mapping, c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// copies every column of the view \p frame into a dataset that owns its data
+DataWithAesthetic copy_frame(const DataWithAesthetic &frame) {
+  const RawData &raw = frame.raw();
+  const int rows = raw.rows();
+  const int cols = raw.cols();
+  std::vector<float> matrix(static_cast<size_t>(rows) * cols);
+  for (int j = 0; j < cols; ++j) {
+    const ColumnIterator col = raw.begin(j);
+    for (int i = 0; i < rows; ++i) {
+      matrix[static_cast<size_t>(i) * cols + j] = col[i];
+    }
+  }
+  DataWithAesthetic copy(std::make_shared<RawData>(cols, std::move(matrix)));
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    if (frame.column(a) != -1) {
+      copy.map(a, frame.column(a));
+    }
+  }
+  return copy;
+}
+
+} // namespace
+
+// a consumer record in the segment header, freed once the consumer and every
+// frame it has read are destroyed
+struct ShmRegistration {
+  std::shared_ptr<ShmMapping> mapping;
+  int index;
+  ~ShmRegistration() {
+    header(*mapping)->consumers[index].store(0, std::memory_order_release);
+  }
+};
+
+namespace {
+
+// holds a consumer lease on a slot, and the consumer record it belongs to
+struct ShmLease {
+  std::shared_ptr<ShmRegistration> registration;
+  ShmSlot *slot;
+  ~ShmLease() {
+    slot->leases[registration->index].fetch_sub(1, std::memory_order_release);
+  }
+};
+
+} // namespace
+
+ShmMapping::~ShmMapping() { munmap(m_base, m_size); }
+
+ShmProducer::ShmProducer(const std::string &name, const int slots,
+                         const int max_values)
+    : m_name(name), m_next(0) {
+  if (slots <= 0 || max_values <= 0) {
+    throw Exception("shared memory ring must have at least one slot and value");
+  }
+
+  const size_t slot_bytes =
+      slot_header_bytes +
+      round_up(static_cast<size_t>(max_values) * sizeof(float));
+  const size_t size = header_bytes + static_cast<size_t>(slots) * slot_bytes;
+
+  shm_unlink(m_name.c_str());
+  const int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    throw Exception("could not create shared memory segment " + m_name);
+  }
+  if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+    close(fd);
+    shm_unlink(m_name.c_str());
+    throw Exception("could not resize shared memory segment " + m_name);
+  }
+  void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(m_name.c_str());
+    throw Exception("could not map shared memory segment " + m_name);
+  }
+  m_mapping.reset(new ShmMapping(base, size));
+
+  // a new segment is zero filled, so all slots start unleased and all
+  // consumer records start free
+  ShmHeader *h = header(*m_mapping);
+  h->slots = static_cast<uint32_t>(slots);
+  h->max_values = static_cast<uint32_t>(max_values);
+  h->slot_bytes = slot_bytes;
+  h->version = shm_version;
+  h->published.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  h->magic = shm_magic;
+}
+
+ShmProducer::~ShmProducer() { shm_unlink(m_name.c_str()); }
+
+bool ShmProducer::publish(const DataWithAesthetic &data, const float time) {
+  ShmHeader *h = header(*m_mapping);
+
+  // find the aesthetics provided by this frame
+  std::vector<int> aesthetics;
+  for (int a = 0; a < Aesthetic::N; ++a) {
+    if (data.column(a) != -1) {
+      aesthetics.push_back(a);
+    }
+  }
+  const int cols = static_cast<int>(aesthetics.size());
+  const int rows = data.rows();
+  if (static_cast<size_t>(rows) * cols > h->max_values) {
+    throw Exception("frame is too large for the shared memory slots");
+  }
+
+  // mark the slot as being written before looking for leases. A consumer
+  // takes its lease before looking at the mark (both sequentially
+  // consistent), so either it sees the mark or the slot is found leased
+  ShmSlot *s = slot(*m_mapping, m_next);
+  s->writing.store(1);
+  if (!unleased(*m_mapping, s)) {
+    s->writing.store(0, std::memory_order_release);
+    return false;
+  }
+
+  float *matrix = slot_matrix(s);
+  for (int j = 0; j < cols; ++j) {
+    data.visit_columns(
+        [&](const auto col) {
+          for (int i = 0; i < rows; ++i) {
+            matrix[i * cols + j] = col[i];
+          }
+        },
+        data.column(aesthetics[j]));
+  }
+  std::fill(std::begin(s->map), std::end(s->map), -1);
+  for (int j = 0; j < cols; ++j) {
+    s->map[aesthetics[j]] = j;
+  }
+  s->rows = rows;
+  s->cols = cols;
+  s->time = time;
+  s->sequence = m_next;
+
+  s->writing.store(0, std::memory_order_release);
+  h->published.store(++m_next, std::memory_order_release);
+  return true;
+}
+
+ShmConsumer::ShmConsumer(const std::string &name)
+    : m_next(0), m_dropped(0), m_last_view(nullptr) {
+  const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd == -1) {
+    throw Exception("could not open shared memory segment " + name);
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 ||
+      static_cast<size_t>(st.st_size) < header_bytes + slot_header_bytes) {
+    close(fd);
+    throw Exception("shared memory segment " + name + " is not initialised");
+  }
+  const auto size = static_cast<size_t>(st.st_size);
+  void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    throw Exception("could not map shared memory segment " + name);
+  }
+  auto mapping = std::make_shared<ShmMapping>(base, size);
+
+  ShmHeader *h = header(*mapping);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (h->magic != shm_magic || h->version != shm_version ||
+      header_bytes + h->slots * h->slot_bytes > size) {
+    throw Exception("shared memory segment " + name + " has the wrong format");
+  }
+
+  // take a free consumer record, freeing those of consumers that have died
+  const auto pid = static_cast<int32_t>(getpid());
+  for (int c = 0; c < shm_max_consumers; ++c) {
+    reclaim_if_dead(*mapping, c);
+    int32_t unused = 0;
+    if (h->consumers[c].compare_exchange_strong(unused, pid)) {
+      m_registration = std::shared_ptr<ShmRegistration>(
+          new ShmRegistration{std::move(mapping), c});
+      return;
+    }
+  }
+  throw Exception("shared memory segment " + name + " has too many consumers");
+}
+
+bool ShmConsumer::next(DataWithAesthetic &data, float &time) {
+  return read(data, time, false);
+}
+
+bool ShmConsumer::read(DataWithAesthetic &data, float &time, const bool copy) {
+  const ShmMapping &mapping = *m_registration->mapping;
+  ShmHeader *h = header(mapping);
+  const int c = m_registration->index;
+
+  while (true) {
+    const uint64_t published = h->published.load(std::memory_order_acquire);
+    if (m_next >= published) {
+      return false;
+    }
+
+    // frames older than one trip round the ring have been overwritten
+    if (published - m_next > h->slots) {
+      m_dropped += published - h->slots - m_next;
+      m_next = published - h->slots;
+    }
+
+    // take a lease on the slot, unless the producer is writing to it
+    ShmSlot *s = slot(mapping, m_next);
+    s->leases[c].fetch_add(1);
+    if (s->writing.load()) {
+      s->leases[c].fetch_sub(1, std::memory_order_release);
+      ++m_dropped;
+      ++m_next;
+      continue;
+    }
+    auto lease = std::shared_ptr<ShmLease>(new ShmLease{m_registration, s});
+
+    if (s->sequence != m_next) {
+      // overwritten by a newer frame before we got the lease
+      ++m_dropped;
+      ++m_next;
+      continue;
+    }
+
+    const float *matrix = slot_matrix(s);
+    if (copy) {
+      // the lease is released as soon as the matrix is copied
+      data = DataWithAesthetic(std::make_shared<RawData>(
+          s->cols, std::vector<float>(matrix, matrix + s->rows * s->cols)));
+    } else {
+      std::vector<ColumnView> columns(s->cols);
+      for (int j = 0; j < s->cols; ++j) {
+        columns[j] = {matrix + j, s->cols};
+      }
+      data = DataWithAesthetic(
+          std::make_shared<RawData>(s->rows, std::move(columns), lease));
+    }
+    for (int a = 0; a < Aesthetic::N; ++a) {
+      if (s->map[a] != -1) {
+        data.map(a, s->map[a]);
+      }
+    }
+    time = s->time;
+    ++m_next;
+    return true;
+  }
+}
+
+int ShmConsumer::poll(Plot1D &plot, const bool latest_as_view) {
+  DataWithAesthetic data;
+  float time;
+  if (!latest_as_view) {
+    int n = 0;
+    while (read(data, time, true)) {
+      plot.add_frame(data, time);
+      ++n;
+    }
+    return n;
+  }
+
+  if (!read(data, time, false)) {
+    return 0;
+  }
+
+  // the frame that the last poll added as a view is no longer the latest, so
+  // it is replaced by a copy and its slot released
+  if (m_last_view != nullptr && plot.data_size() > 0) {
+    DataWithAesthetic &last = plot.get_data(plot.data_size() - 1);
+    const RawData &raw = last.raw();
+    if (raw.is_view() && raw.cols() > 0 && &*raw.begin(0) == m_last_view) {
+      last = copy_frame(last);
+    }
+  }
+
+  int n = 1;
+  DataWithAesthetic next;
+  float next_time;
+  while (read(next, next_time, false)) {
+    plot.add_frame(copy_frame(data), time);
+    data = next;
+    time = next_time;
+    ++n;
+  }
+  plot.add_frame(data, time);
+  m_last_view = data.cols() > 0 ? &*data.raw().begin(0) : nullptr;
+  return n;
+}
+
+} // namespace trase
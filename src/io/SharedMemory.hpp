@@ -0,0 +1,169 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file SharedMemory.hpp
+/// Transport of data frames between processes using POSIX shared memory
+
+#ifndef SHARED_MEMORY_H_
+#define SHARED_MEMORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "frontend/Data.hpp"
+#include "frontend/Plot1D.hpp"
+
+namespace trase {
+
+/// a memory mapping (of a shared memory segment or a file), unmapped on
+/// destruction
+class ShmMapping {
+  void *m_base;
+  size_t m_size;
+
+public:
+  ShmMapping(void *base, size_t size) : m_base(base), m_size(size) {}
+  ~ShmMapping();
+  ShmMapping(const ShmMapping &) = delete;
+  ShmMapping &operator=(const ShmMapping &) = delete;
+
+  /// returns a pointer to the start of the mapped memory
+  char *base() const { return static_cast<char *>(m_base); }
+
+  /// returns the number of bytes mapped
+  size_t size() const { return m_size; }
+};
+
+/// Publishes data frames into a named ring of slots in shared memory
+///
+/// Each slot holds the row major matrix of a single frame, along with its time
+/// and the column used for each aesthetic. A ShmConsumer in another process
+/// maps the same segment and uses the slots directly as RawData, so frame data
+/// is written once by the producer and never copied by the consumer.
+///
+/// A slot is only reused once every frame read from it has been released by
+/// its consumers, if the next slot is still in use publish() returns false and
+/// the caller can decide to drop the frame or retry later. Each consumer has a
+/// record in the segment holding the pid of its process, so the slots held by
+/// a consumer whose process has exited (e.g. crashed) are reclaimed when the
+/// producer next needs them.
+class ShmProducer {
+  std::string m_name;
+  std::unique_ptr<ShmMapping> m_mapping;
+  uint64_t m_next;
+
+public:
+  /// creates the named segment \p name (e.g. "/trase_sim"), replacing any
+  /// existing segment with the same name
+  ///
+  /// \param name the name of the segment, see `shm_open`
+  /// \param slots the number of slots in the ring
+  /// \param max_values the maximum number of floats (rows * columns) per frame
+  ShmProducer(const std::string &name, int slots, int max_values);
+
+  /// unmaps and unlinks the segment. Consumers that have already opened the
+  /// segment keep their mapping
+  ~ShmProducer();
+
+  ShmProducer(const ShmProducer &) = delete;
+  ShmProducer &operator=(const ShmProducer &) = delete;
+
+  /// copies all aesthetics of \p data into the next slot of the ring and makes
+  /// it visible to consumers. Throws if the frame does not fit in a slot
+  ///
+  /// \return false if the next slot is still held by a consumer, in which case
+  /// nothing is published
+  bool publish(const DataWithAesthetic &data, float time);
+
+  /// returns the number of frames published so far
+  uint64_t published() const { return m_next; }
+};
+
+// the record of a ShmConsumer in the segment, see SharedMemory.cpp
+struct ShmRegistration;
+
+/// Reads data frames published by a ShmProducer
+///
+/// Frames are returned as DataWithAesthetic objects whose RawData points
+/// directly at the shared memory slot. The slot is held until the last copy of
+/// the frame is destroyed.
+class ShmConsumer {
+  std::shared_ptr<ShmRegistration> m_registration;
+  uint64_t m_next;
+  uint64_t m_dropped;
+
+  /// the first value of the frame that the last poll() added as a view
+  const float *m_last_view;
+
+public:
+  /// opens the existing named segment \p name, throws if it already has the
+  /// maximum number of consumers (16)
+  explicit ShmConsumer(const std::string &name);
+
+  /// reads the next frame that has not yet been read by this consumer
+  ///
+  /// Frames that were overwritten before they could be read are skipped and
+  /// counted in dropped()
+  ///
+  /// \param data set to the new frame
+  /// \param time set to the time of the new frame
+  /// \return false if there are no new frames
+  bool next(DataWithAesthetic &data, float &time);
+
+  /// adds every new frame to \p plot using Plot1D::add_frame
+  ///
+  /// The plot keeps its frames for as long as it exists, so if they were all
+  /// views they would hold every slot of the ring and stop the producer. By
+  /// default the frames are copied out of their slots. If \p latest_as_view
+  /// is true the latest frame is added as a view (see next()) and only copied
+  /// once a later poll adds a newer frame, so that drawing the latest frame
+  /// reads the slot directly. The plot then holds at most one slot (two if it
+  /// has aligned the latest frame for drawing, until it next draws)
+  ///
+  /// \return the number of frames added
+  int poll(Plot1D &plot, bool latest_as_view = false);
+
+  /// returns the number of frames that were overwritten before being read
+  uint64_t dropped() const { return m_dropped; }
+
+private:
+  /// reads the next frame as next() does, as a copy of the slot if \p copy
+  /// is true, otherwise as a view holding the slot
+  bool read(DataWithAesthetic &data, float &time, bool copy);
+};
+
+} // namespace trase
+
+#endif // SHARED_MEMORY_H_
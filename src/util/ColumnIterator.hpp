@@ -36,13 +36,24 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef COLUMNITERATOR_H_
 #define COLUMNITERATOR_H_
 
+#include <cstddef>
+#include <iterator>
 #include <vector>
 
 namespace trase {
 
+/// A pointer to the first element of a column, and the distance (in floats)
+/// between consecutive elements
+struct ColumnView {
+  const float *data;
+  int stride;
+};
+
 /// A const iterator that iterates through a single column of the raw data class
 /// Impliments an random access iterator with a given stride
 class ColumnIterator {
+  friend class IndexedColumnIterator;
+
 public:
   using pointer = float const *;
   using iterator_category = std::random_access_iterator_tag;
@@ -55,6 +66,8 @@ public:
   ColumnIterator(const std::vector<float>::const_iterator &p, const int stride)
       : m_p(&(*p)), m_stride(stride) {}
 
+  ColumnIterator(const float *p, const int stride) : m_p(p), m_stride(stride) {}
+
   reference operator*() const { return dereference(); }
 
   reference operator->() const { return dereference(); }
@@ -101,6 +114,73 @@ private:
   int m_stride;
 };
 
+/// A const iterator through a selection of the rows of a single column
+///
+/// It steps through an array of (ascending) row indices rather than through
+/// the column itself, so that a filtered dataset can be iterated without
+/// copying the rows that pass the filter. It is a separate type from
+/// ColumnIterator so that iterating every row never has to check for a
+/// selection, see DataWithAesthetic::visit()
+class IndexedColumnIterator {
+public:
+  using pointer = float const *;
+  using iterator_category = std::random_access_iterator_tag;
+  using reference = float const &;
+  using value_type = float const;
+  using difference_type = std::ptrdiff_t;
+
+  IndexedColumnIterator() = default;
+
+  /// iterates through the rows of \p column given by \p index, counted from
+  /// the row that \p column points to
+  IndexedColumnIterator(const ColumnIterator &column, const int *index)
+      : m_p(column.m_p), m_stride(column.m_stride), m_index(index) {}
+
+  reference operator*() const { return dereference(); }
+
+  reference operator->() const { return dereference(); }
+
+  IndexedColumnIterator &operator++() {
+    ++m_index;
+    return *this;
+  }
+
+  const IndexedColumnIterator operator++(int) {
+    IndexedColumnIterator tmp(*this);
+    operator++();
+    return tmp;
+  }
+
+  IndexedColumnIterator operator+(int n) const {
+    IndexedColumnIterator tmp(*this);
+    tmp.m_index += n;
+    return tmp;
+  }
+
+  reference operator[](const int i) const { return operator+(i).dereference(); }
+
+  size_t operator-(const IndexedColumnIterator &start) const {
+    return m_index - start.m_index;
+  }
+
+  inline bool operator==(const IndexedColumnIterator &rhs) const {
+    return m_p == rhs.m_p && m_index == rhs.m_index;
+  }
+
+  inline bool operator!=(const IndexedColumnIterator &rhs) const {
+    return !operator==(rhs);
+  }
+
+private:
+  reference dereference() const {
+    return m_p[static_cast<std::ptrdiff_t>(*m_index) * m_stride];
+  }
+
+  pointer m_p;
+  int m_stride;
+  const int *m_index;
+};
+
 } // namespace trase
 
 #endif // COLUMNITERATOR_H_
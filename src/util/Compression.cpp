@@ -0,0 +1,293 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Compression.cpp
+
+#include "util/Compression.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+enum Encoding : uint8_t { delta_of_delta = 0, xor_bits = 1 };
+
+// whole numbers up to this size are encoded as integers, so that the
+// difference of differences cannot overflow
+const float max_integer = 1099511627776.f; // 2^40
+
+bool is_integer(const float v) {
+  return std::trunc(v) == v && std::fabs(v) <= max_integer &&
+         !(v == 0 && std::signbit(v));
+}
+
+uint32_t to_bits(const float v) {
+  uint32_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+float from_bits(const uint32_t bits) {
+  float v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+int leading_zeros(uint32_t x) {
+#if defined(__GNUC__)
+  return __builtin_clz(x);
+#else
+  int n = 0;
+  for (; (x & 0x80000000u) == 0; x <<= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+int trailing_zeros(uint32_t x) {
+#if defined(__GNUC__)
+  return __builtin_ctz(x);
+#else
+  int n = 0;
+  for (; (x & 1u) == 0; x >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+uint64_t zigzag(const int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(const uint64_t v) {
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+void write_varint(uint64_t v, std::vector<uint8_t> &out) {
+  for (; v >= 0x80; v >>= 7) {
+    out.push_back(static_cast<uint8_t>(v | 0x80));
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+uint64_t read_varint(const uint8_t *in, const size_t size, size_t &pos) {
+  uint64_t v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (pos == size) {
+      throw Exception("unexpected end of compressed column");
+    }
+    const uint8_t byte = in[pos++];
+    v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return v;
+    }
+  }
+  throw Exception("invalid varint in compressed column");
+}
+
+// writes values of up to 32 bits, most significant bit first
+class BitWriter {
+  std::vector<uint8_t> &m_out;
+  uint64_t m_bits{0};
+  int m_count{0};
+
+public:
+  explicit BitWriter(std::vector<uint8_t> &out) : m_out(out) {}
+
+  void write(const uint32_t value, const int n) {
+    const uint64_t mask = (uint64_t(1) << n) - 1;
+    m_bits = m_bits << n | (value & mask);
+    m_count += n;
+    while (m_count >= 8) {
+      m_count -= 8;
+      m_out.push_back(static_cast<uint8_t>(m_bits >> m_count));
+    }
+    m_bits &= (uint64_t(1) << m_count) - 1;
+  }
+
+  /// writes the last partial byte, padded with zeros
+  void flush() {
+    if (m_count > 0) {
+      m_out.push_back(static_cast<uint8_t>(m_bits << (8 - m_count)));
+      m_count = 0;
+    }
+  }
+};
+
+class BitReader {
+  const uint8_t *m_in;
+  size_t m_size;
+  size_t m_bit{0};
+
+public:
+  BitReader(const uint8_t *in, const size_t size) : m_in(in), m_size(size) {}
+
+  uint32_t read(int n) {
+    if (m_bit + static_cast<size_t>(n) > m_size * 8) {
+      throw Exception("unexpected end of compressed column");
+    }
+    uint32_t value = 0;
+    while (n > 0) {
+      const int available = 8 - static_cast<int>(m_bit & 7);
+      const int take = n < available ? n : available;
+      const uint32_t byte = m_in[m_bit >> 3] >> (available - take);
+      value = value << take | (byte & ((1u << take) - 1));
+      m_bit += static_cast<size_t>(take);
+      n -= take;
+    }
+    return value;
+  }
+
+  /// returns the number of bytes read, including a partial last byte
+  size_t bytes() const { return (m_bit + 7) / 8; }
+};
+
+} // namespace
+
+void compress_column(const float *values, const int n, const int stride,
+                     std::vector<uint8_t> &out) {
+  if (n <= 0) {
+    return;
+  }
+  bool integers = true;
+  for (int i = 0; i < n && integers; ++i) {
+    integers = is_integer(values[i * stride]);
+  }
+
+  if (integers) {
+    out.push_back(delta_of_delta);
+    int64_t previous = static_cast<int64_t>(values[0]);
+    int64_t delta = 0;
+    write_varint(zigzag(previous), out);
+    for (int i = 1; i < n; ++i) {
+      const int64_t v = static_cast<int64_t>(values[i * stride]);
+      write_varint(zigzag(v - previous - delta), out);
+      delta = v - previous;
+      previous = v;
+    }
+    return;
+  }
+
+  out.push_back(xor_bits);
+  BitWriter writer(out);
+  uint32_t previous = to_bits(values[0]);
+  writer.write(previous, 32);
+
+  // the window of meaningful bits of the last value that needed a new one,
+  // leading < 0 until there is one
+  int leading = -1;
+  int trailing = 0;
+  for (int i = 1; i < n; ++i) {
+    const uint32_t bits = to_bits(values[i * stride]);
+    const uint32_t x = bits ^ previous;
+    previous = bits;
+    if (x == 0) {
+      writer.write(0, 1);
+      continue;
+    }
+    const int lz = leading_zeros(x);
+    const int tz = trailing_zeros(x);
+    if (leading >= 0 && lz >= leading && tz >= trailing) {
+      // the changed bits fit in the previous window
+      writer.write(2, 2);
+      writer.write(x >> trailing, 32 - leading - trailing);
+    } else {
+      leading = lz;
+      trailing = tz;
+      const int length = 32 - lz - tz;
+      writer.write(3, 2);
+      writer.write(static_cast<uint32_t>(lz), 5);
+      writer.write(static_cast<uint32_t>(length - 1), 5);
+      writer.write(x >> tz, length);
+    }
+  }
+  writer.flush();
+}
+
+size_t decompress_column(const uint8_t *in, const size_t size, const int n,
+                         float *out, const int stride) {
+  if (n <= 0) {
+    return 0;
+  }
+  if (size == 0) {
+    throw Exception("unexpected end of compressed column");
+  }
+
+  if (in[0] == delta_of_delta) {
+    size_t pos = 1;
+    int64_t previous = unzigzag(read_varint(in, size, pos));
+    int64_t delta = 0;
+    out[0] = static_cast<float>(previous);
+    for (int i = 1; i < n; ++i) {
+      delta += unzigzag(read_varint(in, size, pos));
+      previous += delta;
+      out[i * stride] = static_cast<float>(previous);
+    }
+    return pos;
+  }
+  if (in[0] != xor_bits) {
+    throw Exception("unknown compressed column encoding");
+  }
+
+  BitReader reader(in + 1, size - 1);
+  uint32_t previous = reader.read(32);
+  out[0] = from_bits(previous);
+  int leading = -1;
+  int trailing = 0;
+  for (int i = 1; i < n; ++i) {
+    if (reader.read(1) == 1) {
+      if (reader.read(1) == 0) {
+        if (leading < 0) {
+          throw Exception("invalid compressed column");
+        }
+      } else {
+        leading = static_cast<int>(reader.read(5));
+        trailing = 32 - leading - static_cast<int>(reader.read(5)) - 1;
+        if (trailing < 0) {
+          throw Exception("invalid compressed column");
+        }
+      }
+      previous ^= reader.read(32 - leading - trailing) << trailing;
+    }
+    out[i * stride] = from_bits(previous);
+  }
+  return 1 + reader.bytes();
+}
+
+} // namespace trase
@@ -0,0 +1,69 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Compression.hpp
+/// Lossless compression of blocks of float columns, tuned for time series
+
+#ifndef COMPRESSION_H_
+#define COMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trase {
+
+/// appends the compressed encoding of the \p n floats values[0],
+/// values[stride], ... values[(n - 1) * stride] to \p out
+///
+/// A block in which every value is a whole number (such as timestamps or
+/// counters) is stored as the zigzag varint of the first value and of the
+/// first difference, followed by the varint of each change in the difference
+/// ("delta-of-delta"), so evenly spaced values take a byte each. Any other
+/// block uses Gorilla-style XOR encoding: each value is stored as the bits
+/// that differ from the previous value, which is a single bit if they are
+/// equal. The encoding is lossless, including for NaN, infinity and -0.
+void compress_column(const float *values, int n, int stride,
+                     std::vector<uint8_t> &out);
+
+/// decodes \p n floats compressed by compress_column() from the \p size bytes
+/// at \p in into out[0], out[stride], ... out[(n - 1) * stride]
+///
+/// \return the number of bytes of \p in that were read. Throws if the
+/// encoding is invalid or needs more than \p size bytes
+size_t decompress_column(const uint8_t *in, size_t size, int n, float *out,
+                         int stride);
+
+} // namespace trase
+
+#endif // COMPRESSION_H_
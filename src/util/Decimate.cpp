@@ -0,0 +1,96 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "util/Decimate.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_set>
+
+namespace trase {
+
+namespace {
+
+// a key identifying the grid cell containing p
+uint64_t cell_key(const vfloat2_t &p, const float inv_cell_size) {
+  const auto i = static_cast<int32_t>(std::floor(p[0] * inv_cell_size));
+  const auto j = static_cast<int32_t>(std::floor(p[1] * inv_cell_size));
+  return (static_cast<uint64_t>(static_cast<uint32_t>(i)) << 32u) |
+         static_cast<uint32_t>(j);
+}
+
+std::vector<int> all_indices(const size_t n) {
+  std::vector<int> indices(n);
+  std::iota(indices.begin(), indices.end(), 0);
+  return indices;
+}
+
+} // namespace
+
+std::vector<int> decimate_points(const std::vector<vfloat2_t> &pixels,
+                                 const float cell_size) {
+  if (cell_size <= 0.f) {
+    return all_indices(pixels.size());
+  }
+  const float inv_cell_size = 1.f / cell_size;
+  std::unordered_set<uint64_t> occupied;
+  std::vector<int> indices;
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    if (occupied.insert(cell_key(pixels[i], inv_cell_size)).second) {
+      indices.push_back(static_cast<int>(i));
+    }
+  }
+  return indices;
+}
+
+std::vector<int> decimate_polyline(const std::vector<vfloat2_t> &pixels,
+                                   const float cell_size) {
+  if (cell_size <= 0.f || pixels.size() <= 2) {
+    return all_indices(pixels.size());
+  }
+  const float inv_cell_size = 1.f / cell_size;
+  std::vector<int> indices = {0};
+  uint64_t last = cell_key(pixels[0], inv_cell_size);
+  for (size_t i = 1; i + 1 < pixels.size(); ++i) {
+    const uint64_t key = cell_key(pixels[i], inv_cell_size);
+    if (key != last) {
+      indices.push_back(static_cast<int>(i));
+      last = key;
+    }
+  }
+  indices.push_back(static_cast<int>(pixels.size() - 1));
+  return indices;
+}
+
+} // namespace trase
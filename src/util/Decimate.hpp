@@ -0,0 +1,62 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Decimate.hpp
+/// Reduces dense sets of points to the detail that can be seen at a given
+/// pixel resolution
+
+#ifndef DECIMATE_H_
+#define DECIMATE_H_
+
+#include <vector>
+
+#include "util/Vector.hpp"
+
+namespace trase {
+
+/// returns the indices of the points in \p pixels to draw so that there is at
+/// most one point in each square grid cell of side \p cell_size pixels. The
+/// first point in each cell is kept. All points are kept if \p cell_size <= 0
+std::vector<int> decimate_points(const std::vector<vfloat2_t> &pixels,
+                                 float cell_size);
+
+/// returns the indices of the vertices of the polyline \p pixels to draw,
+/// dropping each vertex that lies in the same square grid cell (of side \p
+/// cell_size pixels) as the previous vertex kept. The first and last vertices
+/// are always kept. All vertices are kept if \p cell_size <= 0
+std::vector<int> decimate_polyline(const std::vector<vfloat2_t> &pixels,
+                                   float cell_size);
+
+} // namespace trase
+
+#endif // DECIMATE_H_
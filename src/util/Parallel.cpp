@@ -0,0 +1,181 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Parallel.cpp
+
+#include "util/Parallel.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+namespace trase {
+
+namespace {
+
+/// a fixed set of threads that run the tasks pushed to it, in order
+class WorkerPool {
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<std::function<void()>> m_tasks;
+  std::vector<std::thread> m_threads;
+  bool m_stop{false};
+
+  void work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+        if (m_tasks.empty()) {
+          return;
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+public:
+  explicit WorkerPool(const int threads) {
+    for (int i = 0; i < threads; ++i) {
+      m_threads.emplace_back([this]() { work(); });
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto &t : m_threads) {
+      t.join();
+    }
+  }
+
+  void push(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+  }
+
+  /// runs the next queued task on the calling thread, returns false if there
+  /// are none
+  bool run_one() {
+    std::function<void()> task;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_tasks.empty()) {
+        return false;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+    return true;
+  }
+};
+
+WorkerPool &worker_pool() {
+  // the calling thread is one of the threads of each parallel_rows()
+  static WorkerPool pool(
+      static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1);
+  return pool;
+}
+
+} // namespace
+
+void parallel_rows(const int rows, const int threads,
+                   const std::function<void(int, int, int)> &f) {
+  if (threads <= 1) {
+    f(0, 0, rows);
+    return;
+  }
+  const int chunk = (rows + threads - 1) / threads;
+
+  // the ranges still running, and the first exception thrown by any range
+  std::mutex mutex;
+  std::condition_variable done;
+  int remaining = threads - 1;
+  std::exception_ptr error;
+  auto run = [&](const int t) {
+    try {
+      f(t, std::min(rows, t * chunk), std::min(rows, (t + 1) * chunk));
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  WorkerPool &pool = worker_pool();
+  for (int t = 1; t < threads; ++t) {
+    pool.push([&, t]() {
+      run(t);
+      // notified with the lock held, as the caller may return (and destroy
+      // these variables) as soon as it sees remaining reach zero
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--remaining == 0) {
+        done.notify_all();
+      }
+    });
+  }
+  run(0);
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (remaining == 0) {
+        break;
+      }
+    }
+    if (!pool.run_one()) {
+      // every range left is running on a worker
+      std::unique_lock<std::mutex> lock(mutex);
+      done.wait(lock, [&]() { return remaining == 0; });
+      break;
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace trase
@@ -0,0 +1,72 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Parallel.hpp
+/// Helpers for dividing rows of data between threads
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace trase {
+
+/// returns the number of threads to use for \p rows rows, so that each thread
+/// has at least \p min_rows_per_thread rows. \p threads is the requested
+/// number of threads, or <= 0 to use every hardware thread
+inline int number_of_threads(const int threads, const int rows,
+                             const int min_rows_per_thread) {
+  int n = threads;
+  if (n <= 0) {
+    n = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  }
+  return std::max(1, std::min(n, rows / min_rows_per_thread));
+}
+
+/// calls f(thread, begin, end) on each of \p threads threads, for contiguous
+/// ranges of rows [begin, end) that cover [0, rows) in thread order. Thread 0
+/// is the calling thread
+///
+/// The other ranges are run by a pool of worker threads that is created on
+/// first use and kept for the life of the process, so that calling this for
+/// every frame drawn does not create threads. While it waits, the calling
+/// thread runs queued ranges itself, so \p f can call parallel_rows() too.
+/// If \p f throws, the first exception is rethrown once every range is done
+void parallel_rows(int rows, int threads,
+                   const std::function<void(int, int, int)> &f);
+
+} // namespace trase
+
+#endif // PARALLEL_H_
@@ -0,0 +1,167 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "util/Png.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include "util/Exception.hpp"
+
+namespace trase {
+
+namespace {
+
+// the largest block of data in an uncompressed deflate block
+const size_t max_stored_block = 65535;
+
+const std::array<uint32_t, 256> &crc_table() {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> t;
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1u) ? 0xedb88320u ^ (c >> 1u) : c >> 1u;
+      }
+      t[n] = c;
+    }
+    return t;
+  }();
+  return table;
+}
+
+uint32_t update_crc(uint32_t crc, const unsigned char *first,
+                    const unsigned char *last) {
+  const auto &table = crc_table();
+  for (; first != last; ++first) {
+    crc = table[(crc ^ *first) & 0xffu] ^ (crc >> 8u);
+  }
+  return crc;
+}
+
+void put_u32(std::vector<unsigned char> &bytes, const uint32_t x) {
+  bytes.push_back(static_cast<unsigned char>(x >> 24u));
+  bytes.push_back(static_cast<unsigned char>(x >> 16u));
+  bytes.push_back(static_cast<unsigned char>(x >> 8u));
+  bytes.push_back(static_cast<unsigned char>(x));
+}
+
+// writes a chunk with the 4 character type and data
+void write_chunk(std::ostream &out, const char *type,
+                 const std::vector<unsigned char> &data) {
+  std::vector<unsigned char> header;
+  put_u32(header, static_cast<uint32_t>(data.size()));
+  header.insert(header.end(), type, type + 4);
+  uint32_t crc = update_crc(0xffffffffu, header.data() + 4, header.data() + 8);
+  crc = update_crc(crc, data.data(), data.data() + data.size());
+
+  std::vector<unsigned char> footer;
+  put_u32(footer, crc ^ 0xffffffffu);
+  out.write(reinterpret_cast<const char *>(header.data()), header.size());
+  out.write(reinterpret_cast<const char *>(data.data()), data.size());
+  out.write(reinterpret_cast<const char *>(footer.data()), footer.size());
+}
+
+} // namespace
+
+void write_png(std::ostream &out, const int width, const int height,
+               const unsigned char *rgba) {
+  if (width <= 0 || height <= 0) {
+    throw Exception("a png image must have at least one pixel");
+  }
+
+  static const unsigned char signature[8] = {0x89, 'P',  'N',  'G',
+                                             '\r', '\n', 0x1a, '\n'};
+  out.write(reinterpret_cast<const char *>(signature), sizeof(signature));
+
+  // 8 bits per channel, RGBA, no interlacing
+  std::vector<unsigned char> ihdr;
+  put_u32(ihdr, static_cast<uint32_t>(width));
+  put_u32(ihdr, static_cast<uint32_t>(height));
+  ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});
+  write_chunk(out, "IHDR", ihdr);
+
+  // each row starts with a filter type byte (0, none)
+  const size_t row_bytes = 4 * static_cast<size_t>(width);
+  std::vector<unsigned char> raw;
+  raw.reserve((row_bytes + 1) * height);
+  for (int i = 0; i < height; ++i) {
+    raw.push_back(0);
+    raw.insert(raw.end(), rgba + i * row_bytes, rgba + (i + 1) * row_bytes);
+  }
+
+  // a zlib stream of uncompressed deflate blocks
+  std::vector<unsigned char> idat;
+  idat.reserve(raw.size() + 5 * (raw.size() / max_stored_block + 1) + 6);
+  idat.push_back(0x78);
+  idat.push_back(0x01);
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (size_t begin = 0; begin < raw.size(); begin += max_stored_block) {
+    const size_t size = std::min(max_stored_block, raw.size() - begin);
+    const bool last = begin + size == raw.size();
+    const auto len = static_cast<uint16_t>(size);
+    const auto nlen = static_cast<uint16_t>(~len);
+    idat.push_back(last ? 1 : 0);
+    idat.push_back(static_cast<unsigned char>(len & 0xffu));
+    idat.push_back(static_cast<unsigned char>(len >> 8u));
+    idat.push_back(static_cast<unsigned char>(nlen & 0xffu));
+    idat.push_back(static_cast<unsigned char>(nlen >> 8u));
+    for (size_t i = begin; i < begin + size; ++i) {
+      idat.push_back(raw[i]);
+      a = (a + raw[i]) % 65521u;
+      b = (b + a) % 65521u;
+    }
+  }
+  put_u32(idat, (b << 16u) | a);
+  write_chunk(out, "IDAT", idat);
+
+  write_chunk(out, "IEND", {});
+}
+
+void write_png(const std::string &filename, const int width, const int height,
+               const unsigned char *rgba) {
+  std::ofstream out(filename, std::ios::binary);
+  if (!out) {
+    throw Exception("unable to open " + filename);
+  }
+  write_png(out, width, height, rgba);
+  if (!out) {
+    throw Exception("unable to write " + filename);
+  }
+}
+
+} // namespace trase
@@ -0,0 +1,149 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "frontend/Align.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+TEST_CASE("align frames by id", "[align]") {
+  std::vector<float> x0 = {0, 1, 2, 3};
+  std::vector<float> id0 = {10, 11, 12, 13};
+  std::vector<float> x1 = {4, 5, 6};
+  std::vector<float> id1 = {12, 14, 10};
+  auto previous = create_data().x(x0).y(x0).id(id0);
+  auto next = create_data().x(x1).y(x1).id(id1);
+
+  const auto alignment = align_frames(previous, next);
+  using pairs = std::vector<std::pair<int, int>>;
+  CHECK(alignment.matched == pairs({{2, 0}, {0, 2}}));
+  CHECK(alignment.entered == std::vector<int>({1}));
+  CHECK(alignment.exited == std::vector<int>({1, 3}));
+
+  // without ids rows are matched by index
+  auto by_index = align_frames(create_data().x(x0), create_data().x(x1));
+  CHECK(by_index.matched == pairs({{0, 0}, {1, 1}, {2, 2}}));
+  CHECK(by_index.entered.empty());
+  CHECK(by_index.exited == std::vector<int>({3}));
+
+  std::vector<float> repeated = {1, 2, 1};
+  CHECK_THROWS_AS(
+      align_frames(previous, create_data().x(x1).y(x1).id(repeated)),
+      Exception);
+
+  // NaN never compares equal, so is rejected rather than never matched
+  std::vector<float> nan = {1, std::numeric_limits<float>::quiet_NaN(), 2};
+  CHECK_THROWS_AS(
+      align_frames(previous, create_data().x(x1).y(x1).id(nan)), Exception);
+}
+
+TEST_CASE("frame tracks", "[align]") {
+  std::vector<DataWithAesthetic> frames;
+  frames.push_back(create_data().id(std::vector<float>{1, 2}));
+  frames.push_back(create_data().id(std::vector<float>{3, 1}));
+  frames.push_back(create_data().id(std::vector<float>{1, 2}));
+
+  const auto tracks = frame_tracks(frames);
+  REQUIRE(tracks.size() == 4);
+  CHECK(tracks[0].first_frame == 0);
+  CHECK(tracks[0].rows == std::vector<int>({0, 1, 0}));
+  CHECK(tracks[1].rows == std::vector<int>({1}));
+  CHECK(tracks[2].first_frame == 1);
+  CHECK(tracks[2].rows == std::vector<int>({0}));
+  // id 2 re-enters with a new track
+  CHECK(tracks[3].first_frame == 2);
+  CHECK(tracks[3].rows == std::vector<int>({1}));
+}
+
+TEST_CASE("animate points that enter and exit", "[align]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  auto points = ax->points(create_data()
+                               .x(std::vector<float>{0, 1})
+                               .y(std::vector<float>{0, 1})
+                               .id(std::vector<float>{1, 2}));
+  points->add_frame(create_data()
+                        .x(std::vector<float>{2, 3, 4})
+                        .y(std::vector<float>{2, 3, 4})
+                        .id(std::vector<float>{3, 2, 4}),
+                    1.f);
+  auto line = ax->line(create_data()
+                           .x(std::vector<float>{0, 1})
+                           .y(std::vector<float>{0, 1})
+                           .id(std::vector<float>{1, 2}));
+  line->add_frame(create_data()
+                      .x(std::vector<float>{1, 2, 3})
+                      .y(std::vector<float>{1, 2, 3})
+                      .id(std::vector<float>{2, 3, 4}),
+                  1.f);
+
+  // only the live points are stored, one circle is drawn for each id
+  std::ostringstream out;
+  BackendSVG backend(out);
+  fig->draw(backend);
+  const std::string svg = out.str();
+  size_t circles = 0;
+  for (auto i = svg.find("<circle"); i != std::string::npos;
+       i = svg.find("<circle", i + 1)) {
+    ++circles;
+  }
+  CHECK(circles == 4);
+
+  // the line is morphed from frame 1 with the vertex of id 2 starting where
+  // it is in frame 0, rather than from frame 0 vertex by vertex
+  const auto d = svg.find("attributeName=\"d\"");
+  REQUIRE(d != std::string::npos);
+  const auto values = svg.find("values=", d);
+  const std::string d_values =
+      svg.substr(values, svg.find('"', values + 8) - values);
+  CHECK(std::count(d_values.begin(), d_values.end(), ';') == 2);
+  const auto second = d_values.find(';') + 1;
+  CHECK(d_values.substr(second, d_values.find(" L", second) - second) ==
+        " M " + std::to_string(ax->to_display<Aesthetic::x>(1.f)) + ' ' +
+            std::to_string(ax->to_display<Aesthetic::y>(1.f)));
+
+  // between frames, id 1 shrinks while ids 3 and 4 grow
+  for (const float time : {0.f, 0.5f, 1.f}) {
+    std::ostringstream single;
+    BackendSVG backend_single(single);
+    CHECK_NOTHROW(fig->draw(backend_single, time));
+  }
+}
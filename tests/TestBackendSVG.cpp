@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "catch.hpp"
 
+#include <algorithm>
 #include <cctype>
 #include <fstream>
 #include <random>
@@ -304,3 +305,216 @@ TEST_CASE("svg backend circle works as expected", "[svg_backend]") {
     out_f.close();
   }
 }
+
+TEST_CASE("svg backend text batch", "[svg_backend]") {
+
+  std::stringstream out_ss;
+  BackendSVG backend(out_ss);
+  backend.font_size(12.f);
+  backend.font_face("Roboto");
+  backend.text_align(ALIGN_CENTER | ALIGN_TOP);
+
+  SECTION("strings in a batch share one text element") {
+
+    backend.begin_text_batch();
+    backend.add_text({1.f, 2.f}, "a", nullptr);
+    backend.add_text({3.f, 4.f}, "b", nullptr);
+    backend.end_text_batch();
+
+    const std::string svg = out_ss.str();
+    CHECK(starts_with_ignoring_ws(svg, "<text"));
+    CHECK(svg.find("<text", 1) == std::string::npos);
+    CHECK(svg.find("font-family") == svg.rfind("font-family"));
+    CHECK(is_substr_ignoring_ws(
+        svg, R"(<tspan x="1" y="2" alignment-baseline="hanging">a</tspan>)"
+             R"(<tspan x="3" y="4" alignment-baseline="hanging">b</tspan>)"));
+    CHECK(is_substr_ignoring_ws(svg, "</text>"));
+  }
+
+  SECTION("an empty batch writes nothing") {
+
+    backend.begin_text_batch();
+    backend.end_text_batch();
+    CHECK(out_ss.str().empty());
+  }
+
+  SECTION("add_text outside a batch writes a text element") {
+
+    backend.add_text({1.f, 2.f}, "a", nullptr);
+    CHECK(starts_with_ignoring_ws(out_ss.str(), "<text"));
+    CHECK(out_ss.str().find("<tspan") == std::string::npos);
+  }
+}
+
+TEST_CASE("svg backend dashboard", "[svg_backend]") {
+
+  std::vector<std::shared_ptr<Figure>> figures;
+  for (int i = 0; i < 3; ++i) {
+    figures.push_back(figure({100.f + 10.f * i, 50.f + 10.f * i}));
+    auto ax = figures.back()->axis();
+    std::vector<float> x = {0.f, 1.f};
+    auto line = ax->line(create_data().x(x).y(x));
+    line->add_frame(create_data().x(x).y(x), 1.f + i);
+  }
+
+  std::stringstream out_ss;
+  BackendSVG backend(out_ss);
+  CHECK_THROWS_AS(draw_dashboard(backend, figures, 0), Exception);
+  draw_dashboard(backend, figures, 2);
+  const std::string svg = out_ss.str();
+
+  auto count = [&](const std::string &needle) {
+    int n = 0;
+    for (size_t pos = svg.find(needle); pos != std::string::npos;
+         pos = svg.find(needle, pos + 1)) {
+      ++n;
+    }
+    return n;
+  };
+
+  // the header and scripts are written once, the figures are nested
+  CHECK(count("<?xml") == 1);
+  CHECK(count("function tooltip") == 1);
+  CHECK(count("<svg ") == 4);
+  CHECK(count("</svg>") == 4);
+  CHECK(is_substr_ignoring_ws(svg, R"(<svg width="230px" height="130px")"));
+  CHECK(is_substr_ignoring_ws(svg, R"(<svg x="0" y="0" width="100px")"));
+  CHECK(is_substr_ignoring_ws(svg, R"(<svg x="120" y="0" width="110px")"));
+  CHECK(is_substr_ignoring_ws(svg, R"(<svg x="0" y="60" width="120px")"));
+
+  // the figures share the longest animation timeline
+  CHECK(count(R"(dur="3s")") > 0);
+  CHECK(count(R"(dur="1s")") == 0);
+  CHECK(count(R"(dur="2s")") == 0);
+
+  // the keyframes of the shorter figures are held until the end
+  for (size_t pos = svg.find("keyTimes=\""); pos != std::string::npos;
+       pos = svg.find("keyTimes=\"", pos + 1)) {
+    const size_t end = svg.find('"', pos + 10);
+    const size_t last = svg.find_last_of(";\"", end - 1) + 1;
+    CHECK(std::stof(svg.substr(last, end - last)) == 1.f);
+
+    // with a value for each keyframe
+    const size_t values = svg.rfind("values=\"", pos);
+    const size_t values_end = svg.find('"', values + 8);
+    CHECK(std::count(svg.begin() + values, svg.begin() + values_end, ';') ==
+          std::count(svg.begin() + pos, svg.begin() + end, ';'));
+  }
+  CHECK(count(R"(keyTimes="0.000000;0.333333;1")") > 0);
+
+  // a figure drawn after the document is standalone again
+  out_ss.str("");
+  figures[0]->draw(backend);
+  CHECK(starts_with_ignoring_ws(out_ss.str(), "<?xml"));
+}
+
+TEST_CASE("svg backend static layer cache", "[svg_backend]") {
+
+  std::vector<float> x = {0.f, 1.f, 2.f, 3.f};
+  std::vector<float> y = {1.f, 3.f, 2.f, 4.f};
+
+  auto fig = figure();
+  auto ax = fig->axis();
+  ax->xlim({0.f, 4.f});
+  ax->ylim({0.f, 5.f});
+  auto points = ax->points(create_data().x(x).y(y));
+  auto line = ax->line(create_data().x(x).y(y));
+  ax->xlabel("x");
+
+  auto draw = [&](std::shared_ptr<LayerCache> cache) {
+    std::stringstream out_ss;
+    BackendSVG backend(out_ss);
+    backend.layer_cache(cache);
+    fig->draw(backend);
+    return out_ss.str();
+  };
+
+  auto cache = std::make_shared<LayerCache>();
+  for (const bool legend : {false, true}) {
+    if (legend) {
+      ax->legend();
+    }
+    const std::string uncached = draw(nullptr);
+    CHECK(draw(cache) == uncached);
+
+    // only the data changes, the cached static layer is reused
+    y[0] = 2.f;
+    line->add_frame(create_data().x(x).y(y), 1.f);
+    const std::string changed = draw(nullptr);
+    CHECK(changed != uncached);
+    CHECK(draw(cache) == changed);
+  }
+  CHECK(cache->size() == 2);
+
+  ax->title("new title");
+  const std::string retitled = draw(cache);
+  CHECK(retitled.find("new title") != std::string::npos);
+  CHECK(cache->size() == 3);
+}
+
+TEST_CASE("svg backend level of detail", "[svg_backend]") {
+
+  const int n = 20000;
+  std::vector<float> x(n);
+  std::vector<float> y(n);
+  std::default_random_engine gen;
+  std::normal_distribution<float> normal(0, 1);
+  std::generate(x.begin(), x.end(), [&]() { return normal(gen); });
+  std::generate(y.begin(), y.end(), [&]() { return normal(gen); });
+
+  auto fig = figure();
+  auto ax = fig->axis();
+  ax->points(create_data().x(x).y(y));
+  ax->line(create_data().x(x).y(y));
+
+  auto count = [](const std::string &s, const std::string &sub) {
+    int n = 0;
+    for (auto i = s.find(sub); i != std::string::npos; i = s.find(sub, i + 1)) {
+      ++n;
+    }
+    return n;
+  };
+
+  std::stringstream out_ss;
+  BackendSVG backend(out_ss);
+  CHECK_THROWS_AS(backend.level_of_detail(0), Exception);
+  backend.level_of_detail(3, 4.f);
+  CHECK(backend.detail_levels() == 3);
+  CHECK(backend.detail_cell_size(0) == 4.f);
+  CHECK(backend.detail_cell_size(1) == 2.f);
+  CHECK(backend.detail_cell_size(2) == 1.f);
+  fig->draw(backend);
+  const std::string svg = out_ss.str();
+
+  CHECK(is_substr_ignoring_ws(svg, R"(viewBox="0 0 800 600")"));
+  CHECK(count(svg, "class=\"trase-lod\"") == 6);
+  CHECK(count(svg, "<animate") == 0);
+
+  // level 0 of the points is displayed, the others are hidden
+  const auto level0 = svg.find("data-level=\"0\" display=\"inline\"");
+  const auto level1 = svg.find("data-level=\"1\" display=\"none\"");
+  const auto level2 = svg.find("data-level=\"2\" display=\"none\"");
+  REQUIRE(level0 != std::string::npos);
+  REQUIRE(level1 != std::string::npos);
+  REQUIRE(level2 != std::string::npos);
+  const auto end = svg.find("</g>", level2);
+  const int circles0 = count(svg.substr(level0, level1 - level0), "<circle");
+  const int circles1 = count(svg.substr(level1, level2 - level1), "<circle");
+  const int circles2 = count(svg.substr(level2, end - level2), "<circle");
+  CHECK(circles0 < circles1);
+  CHECK(circles1 < circles2);
+
+  // even the finest level is decimated
+  CHECK(circles2 < n);
+
+  // the line only has tooltips at level 0
+  const auto line_level1 = svg.find("data-level=\"1\"", end);
+  const auto line_end = svg.find("</svg>", line_level1);
+  REQUIRE(line_level1 != std::string::npos);
+  CHECK(count(svg.substr(end, line_level1 - end), "<circle") > 0);
+  CHECK(count(svg.substr(line_level1, line_end - line_level1), "<circle") ==
+        0);
+
+  std::ofstream out("test_level_of_detail.svg");
+  out << svg;
+}
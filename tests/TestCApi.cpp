@@ -0,0 +1,158 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <string>
+#include <vector>
+
+#include "capi/trase.h"
+
+namespace {
+
+struct Particle {
+  float x;
+  float y;
+  float r;
+};
+
+void count_release(void *context) { ++*static_cast<int *>(context); }
+
+trase_frame particle_frame(const std::vector<Particle> &particles,
+                           trase_ownership ownership, int *released) {
+  trase_frame frame = {};
+  frame.rows = particles.size();
+  frame.x = {&particles[0].x, sizeof(Particle)};
+  frame.y = {&particles[0].y, sizeof(Particle)};
+  frame.size = {&particles[0].r, sizeof(Particle)};
+  frame.ownership = ownership;
+  frame.release = count_release;
+  frame.context = released;
+  return frame;
+}
+
+std::string render(trase_figure *fig) {
+  size_t length = 0;
+  CHECK(trase_render_svg(fig, nullptr, 0, &length) == TRASE_BUFFER_TOO_SMALL);
+  std::vector<char> buffer(length + 1, 'x');
+  CHECK(trase_render_svg(fig, buffer.data(), buffer.size(), &length) ==
+        TRASE_OK);
+  CHECK(buffer[length] == '\0');
+  return std::string(buffer.data(), length);
+}
+
+} // namespace
+
+TEST_CASE("c api borrows and copies strided columns", "[capi]") {
+  std::vector<Particle> particles = {{0, 0, 1}, {1, 2, 2}, {2, 1, 3}};
+
+  trase_figure *fig = nullptr;
+  trase_axis *ax = nullptr;
+  trase_plot *borrowed = nullptr;
+  trase_plot *copied = nullptr;
+  REQUIRE(trase_figure_new(400, 300, &fig) == TRASE_OK);
+  REQUIRE(trase_figure_axis(fig, &ax) == TRASE_OK);
+
+  int borrow_released = 0;
+  int copy_released = 0;
+  trase_frame frame = particle_frame(particles, TRASE_BORROW, &borrow_released);
+  REQUIRE(trase_axis_points(ax, &frame, &borrowed) == TRASE_OK);
+  CHECK(trase_plot_add_frame(borrowed, &frame, 1.f) == TRASE_OK);
+  frame = particle_frame(particles, TRASE_COPY, &copy_released);
+  REQUIRE(trase_axis_points(ax, &frame, &copied) == TRASE_OK);
+  CHECK(copy_released == 1);
+  CHECK(borrow_released == 0);
+
+  const std::string before = render(fig);
+  CHECK(before.find("<svg") != std::string::npos);
+  CHECK(before.find("</svg>") != std::string::npos);
+
+  // the borrowed plot reads the particles in place, so it sees the change
+  particles[1].y = 1.5f;
+  const std::string after = render(fig);
+  CHECK(after.size() == before.size());
+  CHECK(after != before);
+
+  // a buffer one byte short of the terminator is too small
+  std::vector<char> buffer(after.size());
+  size_t length = 0;
+  CHECK(trase_render_svg(fig, buffer.data(), buffer.size(), &length) ==
+        TRASE_BUFFER_TOO_SMALL);
+  CHECK(length == after.size());
+
+  // each call releases its frame once
+  trase_figure_free(fig);
+  CHECK(borrow_released == 2);
+  CHECK(copy_released == 1);
+}
+
+TEST_CASE("c api reports errors", "[capi]") {
+  std::vector<Particle> particles = {{0, 0, 1}, {1, 2, 2}};
+  trase_figure *fig = nullptr;
+  trase_axis *ax = nullptr;
+  trase_plot *plot = nullptr;
+  CHECK(trase_figure_new(0, 300, &fig) == TRASE_INVALID_ARGUMENT);
+  CHECK(fig == nullptr);
+  CHECK(std::string(trase_last_error()) != "");
+  REQUIRE(trase_figure_new(400, 300, &fig) == TRASE_OK);
+  CHECK(std::string(trase_last_error()) == "");
+  REQUIRE(trase_figure_axis(fig, &ax) == TRASE_OK);
+
+  // a failed call still releases the frame
+  int released = 0;
+  trase_frame frame = particle_frame(particles, TRASE_BORROW, &released);
+  frame.x.stride = 3;
+  CHECK(trase_axis_points(ax, &frame, &plot) == TRASE_INVALID_ARGUMENT);
+  CHECK(plot == nullptr);
+  CHECK(released == 1);
+
+  frame = particle_frame(particles, TRASE_BORROW, &released);
+  frame.y.data = nullptr;
+  CHECK(trase_axis_points(ax, &frame, &plot) == TRASE_INVALID_ARGUMENT);
+  CHECK(released == 2);
+
+  frame = particle_frame(particles, TRASE_BORROW, &released);
+  REQUIRE(trase_axis_points(ax, &frame, &plot) == TRASE_OK);
+  frame = particle_frame(particles, TRASE_COPY, &released);
+  CHECK(trase_plot_add_frame(plot, &frame, 2.f) == TRASE_OK);
+  CHECK(released == 3);
+  frame = particle_frame(particles, TRASE_COPY, &released);
+  CHECK(trase_plot_add_frame(plot, &frame, 1.f) == TRASE_ERROR);
+  CHECK(released == 4);
+
+  CHECK(trase_render_svg(nullptr, nullptr, 0, nullptr) ==
+        TRASE_INVALID_ARGUMENT);
+  trase_figure_free(fig);
+  CHECK(released == 5);
+  trase_figure_free(nullptr);
+}
@@ -0,0 +1,134 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "io/ColumnFile.hpp"
+#include "io/PlotSpec.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+TEST_CASE("column file round trip", "[io]") {
+  std::vector<float> x = {1, 2, 3};
+  std::vector<float> y = {4, 5, 6};
+  std::vector<float> color = {0, 0.5, 1};
+  auto data = create_data().x(x).y(y).color(color);
+
+  std::stringstream ss;
+  write_columns(ss, data);
+  auto read = read_columns(ss);
+
+  CHECK(read.rows() == 3);
+  CHECK(read.column(Aesthetic::size::index) == -1);
+  for (int i = 0; i < 3; ++i) {
+    CHECK(read.begin<Aesthetic::x>()[i] == x[i]);
+    CHECK(read.begin<Aesthetic::y>()[i] == y[i]);
+    CHECK(read.begin<Aesthetic::color>()[i] == color[i]);
+  }
+  CHECK(read.limits().bmax[Aesthetic::y::index] == 6.f);
+
+  std::stringstream truncated(ss.str().substr(0, 20));
+  CHECK_THROWS_AS(read_columns(truncated), Exception);
+  std::stringstream garbage("not a column file");
+  CHECK_THROWS_AS(read_columns(garbage), Exception);
+}
+
+TEST_CASE("column file headers are checked", "[io]") {
+  auto header = [](const uint64_t rows, const uint32_t name_length,
+                   const uint32_t version = 2) {
+    std::string bytes = "TRCF";
+    for (const uint32_t i : {version, 1u}) {
+      bytes.append(reinterpret_cast<const char *>(&i), sizeof(i));
+    }
+    bytes.append(reinterpret_cast<const char *>(&rows), sizeof(rows));
+    bytes.append(reinterpret_cast<const char *>(&name_length),
+                 sizeof(name_length));
+    return bytes + std::string("x\0\0\0", 4);
+  };
+
+  // more rows than fit in a dataset, which a RowSource can still read
+  std::stringstream many(header(0x80000001u, 1));
+  CHECK(read_column_header(many).rows == 0x80000001ll);
+  std::stringstream more(header(0x100000001ull, 1));
+  CHECK(read_column_header(more).rows == 0x100000001ll);
+  std::stringstream too_many(header(0x80000001u, 1));
+  CHECK_THROWS_AS(read_columns(too_many), Exception);
+  std::stringstream overflow(header(0xffffffffffffffffull, 1));
+  CHECK_THROWS_AS(read_column_header(overflow), Exception);
+  std::stringstream version(header(1, 1, 1));
+  CHECK_THROWS_AS(read_column_header(version), Exception);
+  std::stringstream blocks(header(0x80000001u, 1));
+  ColumnFileSource source(blocks, 16);
+  DataWithAesthetic block;
+  CHECK_THROWS_AS(source.next(block), Exception);
+
+  // a header that claims far more rows than the data holds fails once the
+  // data runs out, without allocating memory for every row it claims
+  std::stringstream lying(header(0x7fffffffu, 1) + std::string(16, '\0'));
+  CHECK_THROWS_AS(read_columns(lying), Exception);
+
+  // a corrupt name length is not allocated
+  std::stringstream corrupt(header(1, 0xffffffffu));
+  CHECK_THROWS_AS(read_column_header(corrupt), Exception);
+}
+
+TEST_CASE("plot spec", "[io]") {
+  auto spec = parse_plot_spec("# a comment\n"
+                              "geometry=points\n"
+                              "width=400\n"
+                              "title=my title\n"
+                              "legend=true\n");
+  CHECK(spec.geometry == "points");
+  CHECK(spec.width == 400.f);
+  CHECK(spec.height == 600.f);
+  CHECK(spec.title == "my title");
+  CHECK(spec.legend);
+
+  CHECK_THROWS_AS(parse_plot_spec("colour=red"), Exception);
+  CHECK_THROWS_AS(parse_plot_spec("geometry=bars"), Exception);
+  CHECK_THROWS_AS(parse_plot_spec("width=-1"), Exception);
+  CHECK_THROWS_AS(parse_plot_spec("title"), Exception);
+
+  std::vector<float> x = {1, 2, 3};
+  auto fig = make_figure(spec, create_data().x(x).y(x));
+  std::ostringstream out;
+  BackendSVG backend(out);
+  fig->draw(backend);
+  CHECK(out.str().find("my title") != std::string::npos);
+}
@@ -0,0 +1,196 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "frontend/CompressedData.hpp"
+#include "trase.hpp"
+#include "util/Compression.hpp"
+
+using namespace trase;
+
+namespace {
+
+bool same_bits(const std::vector<float> &a, const std::vector<float> &b) {
+  return a.size() == b.size() &&
+         std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+std::vector<float> round_trip(const std::vector<float> &values,
+                              size_t &bytes) {
+  std::vector<uint8_t> encoded;
+  const int n = static_cast<int>(values.size());
+  compress_column(values.data(), n, 1, encoded);
+  bytes = encoded.size();
+  std::vector<float> decoded(values.size());
+  CHECK(decompress_column(encoded.data(), encoded.size(), n, decoded.data(),
+                          1) == encoded.size());
+  return decoded;
+}
+
+} // namespace
+
+TEST_CASE("compress columns", "[compression]") {
+  size_t bytes = 0;
+
+  // evenly spaced timestamps take a byte each
+  std::vector<float> times;
+  for (int i = 0; i < 1000; ++i) {
+    times.push_back(1000000.f + 250.f * i);
+  }
+  CHECK(same_bits(round_trip(times, bytes), times));
+  CHECK(bytes < 1010);
+
+  const std::vector<float> integers = {0, -5, 7, 7, -1e9f, 1e12f, 3};
+  CHECK(same_bits(round_trip(integers, bytes), integers));
+
+  // slowly changing values share most of their bits
+  std::vector<float> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(20.5f + (i / 100) * 0.25f);
+  }
+  CHECK(same_bits(round_trip(values, bytes), values));
+  CHECK(bytes < 300);
+
+  std::mt19937 generator(1);
+  std::normal_distribution<float> normal;
+  std::vector<float> noise;
+  for (int i = 0; i < 1000; ++i) {
+    noise.push_back(normal(generator));
+  }
+  CHECK(same_bits(round_trip(noise, bytes), noise));
+
+  const std::vector<float> special = {
+      -0.f, 0.f, std::numeric_limits<float>::quiet_NaN(),
+      std::numeric_limits<float>::infinity(), 1e-40f, 3.f};
+  CHECK(same_bits(round_trip(special, bytes), special));
+
+  // strided columns of a row major matrix
+  const std::vector<float> matrix = {1, 0.5f, 2, 0.25f, 3, 0.125f};
+  std::vector<uint8_t> encoded;
+  compress_column(matrix.data(), 3, 2, encoded);
+  compress_column(matrix.data() + 1, 3, 2, encoded);
+  std::vector<float> decoded(6);
+  const size_t first =
+      decompress_column(encoded.data(), encoded.size(), 3, decoded.data(), 2);
+  decompress_column(encoded.data() + first, encoded.size() - first, 3,
+                    decoded.data() + 1, 2);
+  CHECK(same_bits(decoded, matrix));
+
+  // truncated or corrupt data is detected
+  encoded.clear();
+  compress_column(noise.data(), 100, 1, encoded);
+  CHECK_THROWS_AS(
+      decompress_column(encoded.data(), encoded.size() / 2, 100, &noise[0], 1),
+      Exception);
+  encoded[0] = 7;
+  CHECK_THROWS_AS(
+      decompress_column(encoded.data(), encoded.size(), 100, &noise[0], 1),
+      Exception);
+}
+
+TEST_CASE("compressed data", "[compression]") {
+  CompressedData history(100);
+  std::vector<float> time;
+  std::vector<float> value;
+  for (int batch = 0; batch < 70; ++batch) {
+    std::vector<float> t;
+    std::vector<float> v;
+    for (int i = 0; i < 45; ++i) {
+      t.push_back(static_cast<float>(time.size() + t.size()));
+      // a sensor reading with a resolution of 1/8
+      v.push_back(std::round(80.f * std::sin(0.01f * t.back())) / 8.f);
+    }
+    time.insert(time.end(), t.begin(), t.end());
+    value.insert(value.end(), v.begin(), v.end());
+    history.append(create_data().x(t).y(v));
+  }
+  REQUIRE(history.rows() == 3150);
+  CHECK(history.blocks() == 32);
+  CHECK(history.aesthetics() == std::vector<int>{0, 1});
+  CHECK(history.limits().bmax[Aesthetic::x::index] ==
+        Approx(3149.f).margin(0.01));
+  CHECK(history.bytes() < time.size() * 2 * sizeof(float) / 3);
+
+  const DataWithAesthetic all = history.decompress();
+  REQUIRE(all.rows() == 3150);
+  CHECK(std::equal(time.begin(), time.end(), all.begin<Aesthetic::x>()));
+  CHECK(std::equal(value.begin(), value.end(), all.begin<Aesthetic::y>()));
+
+  std::vector<float> matrix;
+  CHECK(history.decompress_block(31, matrix) == 50);
+  CHECK(matrix[50] == value[3100]);
+  CHECK(history.decompress_block(2, matrix) == 100);
+  CHECK(matrix[100] == value[200]);
+  CHECK_THROWS_AS(history.decompress_block(32, matrix), std::out_of_range);
+
+  // streaming reuses one buffer for every block
+  CompressedSource source(history);
+  StreamingLimits limits;
+  StreamingMoments moments(Aesthetic::x::index);
+  CHECK(stream(source, limits, moments) == 3150);
+  CHECK(limits.limits().bmin[Aesthetic::y::index] ==
+        *std::min_element(value.begin(), value.end()));
+  CHECK(moments.mean() == Approx(1574.5));
+
+  CompressedSource blocks(history);
+  DataWithAesthetic block;
+  REQUIRE(blocks.next(block));
+  const float *first = &*block.begin<Aesthetic::x>();
+  REQUIRE(blocks.next(block));
+  CHECK(&*block.begin<Aesthetic::x>() == first);
+  const DataWithAesthetic kept = block;
+  REQUIRE(blocks.next(block));
+  CHECK(&*block.begin<Aesthetic::x>() != first);
+  CHECK(kept.begin<Aesthetic::x>()[0] == 100.f);
+  CHECK(block.begin<Aesthetic::x>()[0] == 200.f);
+
+  CHECK_THROWS_AS(history.append(create_data().x(time)), Exception);
+  CHECK_THROWS_AS(CompressedData(0), Exception);
+
+  // a bulk append of the whole history does not leave a buffer of its
+  // uncompressed size behind
+  CompressedData bulk(100);
+  bulk.append(create_data().x(time).y(value));
+  CHECK(bulk.blocks() == 32);
+  CHECK(bulk.bytes() <= history.bytes());
+  const DataWithAesthetic all_bulk = bulk.decompress();
+  CHECK(std::equal(value.begin(), value.end(),
+                   all_bulk.begin<Aesthetic::y>()));
+}
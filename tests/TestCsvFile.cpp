@@ -0,0 +1,64 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <sstream>
+
+#include "io/CsvFile.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+TEST_CASE("read csv", "[io]") {
+  std::istringstream in("x, y ,color\n"
+                        "1,2,0.5\r\n"
+                        "\n"
+                        "3, 4e1 ,-1\n");
+  auto data = read_csv(in);
+  CHECK(data.rows() == 2);
+  CHECK(data.column(Aesthetic::size::index) == -1);
+  CHECK(data.begin<Aesthetic::x>()[1] == 3.f);
+  CHECK(data.begin<Aesthetic::y>()[1] == 40.f);
+  CHECK(data.begin<Aesthetic::color>()[0] == 0.5f);
+  CHECK(data.limits().bmin[Aesthetic::color::index] == -1.f);
+
+  std::istringstream bad_name("x,z\n1,2\n");
+  CHECK_THROWS_AS(read_csv(bad_name), Exception);
+  std::istringstream bad_value("x,y\n1,two\n");
+  CHECK_THROWS_AS(read_csv(bad_value), Exception);
+  std::istringstream missing_value("x,y\n1,2\n3\n");
+  CHECK_THROWS_AS(read_csv(missing_value), Exception);
+  std::istringstream empty_value("x,y\n1,\n");
+  CHECK_THROWS_AS(read_csv(empty_value), Exception);
+}
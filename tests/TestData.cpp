@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "catch.hpp"
 
+#include <algorithm>
 #include <limits>
 #include <type_traits>
 
@@ -40,6 +41,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 using namespace trase;
 
+namespace {
+
+std::vector<float> x_values(const DataWithAesthetic &data) {
+  std::vector<float> ret;
+  data.visit<Aesthetic::x>(
+      [&](const auto x) { ret = std::vector<float>(x, x + data.rows()); });
+  return ret;
+}
+
+} // namespace
+
 TEST_CASE("create raw data", "[data]") {
   RawData data;
   CHECK(data.rows() == 0);
@@ -176,7 +188,14 @@ TEST_CASE("aesthetics", "[data]") {
   // x/y lims = 0->100
   // color lims = 100->200
   // size lims = 1->2
-  Limits lim({0, 0, 100, 1}, {100, 100, 200, 2});
+  // id and time lims = 0->1
+  Limits lim;
+  const float lim_min[Aesthetic::N] = {0, 0, 100, 1, 0, 0};
+  const float lim_max[Aesthetic::N] = {100, 100, 200, 2, 1, 1};
+  for (int i = 0; i < Aesthetic::N; ++i) {
+    lim.bmin[i] = lim_min[i];
+    lim.bmax[i] = lim_max[i];
+  }
 
   // xy pixel limits = 0 -> 200
   bfloat2_t pixels({0, 0}, {200, 200});
@@ -210,3 +229,125 @@ TEST_CASE("aesthetics", "[data]") {
       Aesthetic::color::from_display(color_display, lim, pixels);
   CHECK(color_data_check == color_data);
 }
+
+TEST_CASE("filter data with a selection", "[data]") {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> x = {0, 1, 2, nan, 4, 5, 6, 7};
+  std::vector<float> y = {1, 2, 1, 2, 3, 1, 2, 3};
+  auto data = create_data().x(x).y(y);
+
+  auto filtered = Filter().drop_nan<Aesthetic::x>()(data);
+  CHECK(filtered.rows() == 7);
+  CHECK(&filtered.raw() == &data.raw());
+  CHECK(x_values(filtered)[3] == 4.f);
+  CHECK(x_values(filtered).size() == 7);
+  CHECK(data.rows() == 8);
+
+  // only a selection is iterated through its row indices
+  bool indexed = false;
+  filtered.visit<Aesthetic::x>([&](const auto x) {
+    indexed = std::is_same<decltype(x), const IndexedColumnIterator>::value;
+  });
+  CHECK(indexed);
+  data.visit<Aesthetic::x>([&](const auto x) {
+    indexed = std::is_same<decltype(x), const IndexedColumnIterator>::value;
+  });
+  CHECK_FALSE(indexed);
+  CHECK_THROWS_AS(filtered.begin<Aesthetic::x>(), Exception);
+
+  Filter filter;
+  filter.range<Aesthetic::x>(1, 6).members<Aesthetic::y>({1, 3});
+  auto selected = filter(data);
+  REQUIRE(selected.rows() == 3);
+  CHECK(std::vector<int>(selected.selection(), selected.selection() + 3) ==
+        std::vector<int>({2, 4, 5}));
+  CHECK(x_values(selected) == std::vector<float>({2, 4, 5}));
+  CHECK(selected.limits().bmin[Aesthetic::x::index] == 2.f);
+  CHECK(selected.limits().bmax[Aesthetic::y::index] == 3.f);
+
+  // filtering a selection selects from the selected rows
+  auto again = Filter().range<Aesthetic::y>(0, 2)(selected);
+  REQUIRE(again.rows() == 2);
+  CHECK(std::vector<int>(again.selection(), again.selection() + 2) ==
+        std::vector<int>({2, 5}));
+
+  // nothing selected has no limits, rather than those of the previous rows
+  auto none = Filter().range<Aesthetic::x>(10, 20)(selected);
+  CHECK(none.rows() == 0);
+  CHECK(none.limits().bmin[Aesthetic::x::index] >
+        none.limits().bmax[Aesthetic::x::index]);
+
+  CHECK_THROWS_AS(Filter().drop_nan<Aesthetic::color>()(data), Exception);
+  CHECK_THROWS_AS(selected.x(x), Exception);
+
+  SECTION("many rows") {
+    const int n = 5000;
+    std::vector<float> category(n);
+    std::vector<float> members;
+    for (int i = 0; i < n; ++i) {
+      category[i] = static_cast<float>(i % 100);
+    }
+    for (int i = 0; i < 50; ++i) {
+      members.push_back(static_cast<float>(2 * i));
+    }
+    auto categorical = create_data().x(category);
+    auto even = Filter().members<Aesthetic::x>(members)(categorical);
+    CHECK(even.rows() == n / 2);
+    const auto even_x = x_values(even);
+    CHECK(std::all_of(even_x.begin(), even_x.end(), [](const float x) {
+      return static_cast<int>(x) % 2 == 0;
+    }));
+  }
+}
+
+TEST_CASE("split long-format data into frames", "[data]") {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> time = {2, 1, 2, nan, 3, 1, 2};
+  std::vector<float> x = {0, 1, 2, 3, 4, 5, 6};
+  auto data = create_data().x(x).y(x).time(time);
+
+  auto split = split_frames(data);
+  CHECK(split.times == std::vector<float>({1, 2, 3}));
+  REQUIRE(split.frames.size() == 3);
+  auto frame_x = [&](const int f) { return x_values(split.frames[f]); };
+  CHECK(frame_x(0) == std::vector<float>({1, 5}));
+  CHECK(frame_x(1) == std::vector<float>({0, 2, 6}));
+  CHECK(frame_x(2) == std::vector<float>({4}));
+  CHECK(&split.frames[1].raw() == &data.raw());
+  CHECK(split.frames[1].limits().bmax[Aesthetic::x::index] == 6.f);
+
+  // frames of a selection use the selected rows
+  auto late = split_frames(Filter().range<Aesthetic::x>(2, 6)(data));
+  CHECK(late.times == std::vector<float>({1, 2, 3}));
+  CHECK(late.frames[1].rows() == 2);
+
+  CHECK_THROWS_AS(split_frames(create_data().x(x)), Exception);
+}
+
+TEST_CASE("append rows to data", "[data]") {
+  std::vector<float> x = {0, 1};
+  std::vector<float> y = {5, 6};
+  auto data = create_data().x(x).y(y);
+  const auto shared = data;
+
+  std::vector<float> x2 = {2, 3, 4};
+  std::vector<float> y2 = {7, 4, 8};
+  data.append(create_data().y(y2).x(x2));
+  REQUIRE(data.rows() == 5);
+  CHECK(data.begin<Aesthetic::x>()[4] == 4.f);
+  CHECK(data.begin<Aesthetic::y>()[2] == 7.f);
+  CHECK(data.limits().bmin[Aesthetic::y::index] == Approx(4.f).margin(0.01));
+  CHECK(data.limits().bmax[Aesthetic::x::index] == Approx(4.f).margin(0.01));
+
+  // the shared RawData was copied before appending
+  CHECK(shared.rows() == 2);
+  CHECK(shared.limits().bmax[Aesthetic::x::index] == Approx(1.f).margin(0.01));
+
+  // the appended rows must have every aesthetic
+  CHECK_THROWS_AS(data.append(create_data().x(x2)), Exception);
+
+  // an empty dataset adopts the rows
+  DataWithAesthetic empty;
+  empty.append(data);
+  CHECK(empty.rows() == 5);
+}
@@ -0,0 +1,66 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include "util/Decimate.hpp"
+
+using namespace trase;
+
+TEST_CASE("decimate points", "[decimate]") {
+  std::vector<vfloat2_t> pixels = {
+      {0.1f, 0.1f}, {0.9f, 0.2f}, {1.5f, 0.5f}, {0.5f, 0.5f}, {3.f, 3.f}};
+
+  CHECK(decimate_points(pixels, 0.f) == std::vector<int>({0, 1, 2, 3, 4}));
+  CHECK(decimate_points(pixels, 1.f) == std::vector<int>({0, 2, 4}));
+  CHECK(decimate_points(pixels, 2.f) == std::vector<int>({0, 4}));
+  CHECK(decimate_points(pixels, 10.f) == std::vector<int>({0}));
+  CHECK(decimate_points({}, 1.f).empty());
+
+  // negative coordinates are in separate cells
+  CHECK(decimate_points({{-0.5f, 0.5f}, {0.5f, 0.5f}, {-0.5f, -0.5f}}, 1.f)
+            .size() == 3);
+}
+
+TEST_CASE("decimate polyline", "[decimate]") {
+  std::vector<vfloat2_t> pixels = {{0.1f, 0.1f}, {0.2f, 0.2f}, {1.5f, 0.5f},
+                                   {0.5f, 0.5f}, {0.6f, 0.6f}, {0.7f, 0.7f}};
+
+  CHECK(decimate_polyline(pixels, 0.f) ==
+        std::vector<int>({0, 1, 2, 3, 4, 5}));
+  // a vertex is only dropped if it is in the same cell as the previous vertex
+  CHECK(decimate_polyline(pixels, 1.f) == std::vector<int>({0, 2, 3, 5}));
+  // first and last vertex are always kept
+  CHECK(decimate_polyline(pixels, 10.f) == std::vector<int>({0, 5}));
+  CHECK(decimate_polyline({{0.f, 0.f}}, 1.f) == std::vector<int>({0}));
+}
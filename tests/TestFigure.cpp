@@ -36,6 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "catch.hpp"
 
 #include <limits>
+#include <sstream>
 #include <type_traits>
 
 #include "trase.hpp"
@@ -60,3 +61,51 @@ TEST_CASE("check axis methods can be invoked", "[figure]") {
   CHECK_THROWS_AS(fig->axis(2), std::out_of_range);
   CHECK_THROWS_AS(fig->axis(-1), std::out_of_range);
 }
+
+TEST_CASE("figure can be cloned", "[figure]") {
+  auto fig = figure({800, 600});
+  auto ax = fig->axis();
+  std::vector<float> x = {0.f, 1.f, 2.f};
+  std::vector<float> y = {1.f, 3.f, 2.f};
+  auto points = ax->points(create_data().x(x).y(y));
+  points->add_frame(create_data().x(x).y(x), 1.f);
+  ax->line(create_data().x(x).y(y));
+  ax->title("original");
+
+  auto draw = [](Figure &f) {
+    std::ostringstream out;
+    BackendSVG backend(out);
+    f.draw(backend);
+    return out.str();
+  };
+  const std::string before = draw(*fig);
+
+  auto copy = fig->clone();
+  auto copy_ax = copy->axis(0);
+  REQUIRE(copy_ax != ax);
+  REQUIRE(copy_ax->plot(0) != ax->plot(0));
+
+  // the frame data is shared, the tree is not
+  CHECK(&copy_ax->plot(0)->get_data(1).raw() == &points->get_data(1).raw());
+  CHECK(copy_ax->plot(0)->data_size() == 2);
+  CHECK(copy_ax->plot(0)->get_time(1) == 1.f);
+
+  // changing the clone leaves the original untouched
+  copy_ax->title("copy");
+  copy_ax->xlim({{-10.f, 10.f}});
+  copy_ax->plot(0)->set_color(RGBA(1, 2, 3, 255));
+  CHECK(draw(*fig) == before);
+
+  // an unchanged clone draws like the original, apart from the figure id
+  auto strip_id = [](std::string svg) {
+    const size_t begin = svg.find("<desc>");
+    const size_t end = svg.find("</desc>");
+    return svg.erase(begin, end - begin);
+  };
+  CHECK(strip_id(draw(*fig->clone())) == strip_id(before));
+
+  auto thumb = fig->clone({200, 150});
+  CHECK(thumb->pixels().bmax[0] == 200.f);
+  CHECK(thumb->axis(0)->pixels().bmax[0] == Approx(180.f));
+  CHECK(ax->pixels().bmax[0] == Approx(720.f));
+}
@@ -0,0 +1,124 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "io/FileFollower.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+void append_to(const std::string &path, const std::string &bytes) {
+  std::ofstream out(path, std::ios::binary | std::ios::app);
+  out << bytes;
+}
+
+} // namespace
+
+TEST_CASE("follow a csv file", "[io]") {
+  const std::string path =
+      "/tmp/trase_tst_follow_" + std::to_string(getpid()) + ".csv";
+  std::remove(path.c_str());
+  CHECK_THROWS_AS(FileFollower(path), Exception);
+
+  append_to(path, "x,y\n0,1\n1,");
+  FileFollower follower(path);
+  auto fig = figure();
+  auto ax = fig->axis();
+  auto plot = ax->line(follower.read());
+  REQUIRE(plot->get_data(0).rows() == 1);
+
+  // nothing has been written, and the partial line is not read
+  CHECK_FALSE(follower.wait(0, 0));
+  CHECK(follower.poll(*plot) == 0);
+
+  // a burst of writes is read in one go
+  append_to(path, "2\n");
+  append_to(path, "2,5\n3,0\n");
+  CHECK(follower.wait(1000));
+  CHECK(follower.poll(*plot) == 3);
+  CHECK_FALSE(follower.wait(0, 0));
+  REQUIRE(plot->data_size() == 1);
+  const DataWithAesthetic &data = plot->get_data(0);
+  REQUIRE(data.rows() == 4);
+  CHECK(data.begin<Aesthetic::x>()[1] == 1.f);
+  CHECK(data.begin<Aesthetic::y>()[1] == 2.f);
+  CHECK(data.begin<Aesthetic::y>()[3] == 0.f);
+  CHECK(data.limits().bmax[Aesthetic::y::index] == 5.f);
+
+  append_to(path, "4,oops\n");
+  CHECK_THROWS_AS(follower.read(), Exception);
+
+  std::ofstream(path, std::ios::trunc) << "x,y\n";
+  CHECK_THROWS_AS(follower.read(), Exception);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("follow a binary log", "[io]") {
+  const std::string path =
+      "/tmp/trase_tst_follow_" + std::to_string(getpid()) + ".bin";
+  std::ofstream(path, std::ios::trunc).close();
+
+  FileFollower follower(path, {Aesthetic::x::index, Aesthetic::y::index});
+  auto fig = figure();
+  auto plot = fig->axis()->points(follower.read());
+  CHECK(plot->get_data(0).rows() == 0);
+
+  const float records[] = {1, 10, 2, 20, 3};
+  append_to(path, std::string(reinterpret_cast<const char *>(records),
+                              sizeof(records)));
+  CHECK(follower.poll(*plot) == 2);
+  CHECK(plot->get_data(0).begin<Aesthetic::y>()[1] == 20.f);
+
+  // the rest of the third record
+  const float rest = 30;
+  append_to(path,
+            std::string(reinterpret_cast<const char *>(&rest), sizeof(rest)));
+  CHECK(follower.poll(*plot) == 1);
+  CHECK(plot->get_data(0).rows() == 3);
+  CHECK(plot->get_data(0).limits().bmax[Aesthetic::y::index] ==
+        Approx(30.f).margin(0.01));
+
+  CHECK_THROWS_AS(FileFollower(path, {}), Exception);
+  CHECK_THROWS_AS(FileFollower(path, {Aesthetic::N}), Exception);
+  std::remove(path.c_str());
+}
@@ -111,3 +111,36 @@ TEST_CASE("histogram creation", "[histogram]") {
   ax->histogram(create_data().x(x));
   DummyDraw::draw("histogram", fig);
 }
+
+TEST_CASE("histogram append", "[histogram]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x = {0.1f, 0.2f, 0.3f, 0.4f, 0.9f};
+  std::vector<float> more = {0.2f, 0.3f, 0.3f};
+  auto eager = ax->histogram(create_data().x(x));
+  auto lazy = ax->histogram(create_data().x(x));
+  lazy->set_lazy(true);
+  eager->add_frame(create_data().x(x), 1.f);
+  lazy->add_frame(create_data().x(x), 1.f);
+
+  // the counts of the existing bins are updated, rather than new bins added
+  const int bins = eager->get_data(1).rows();
+  eager->append(create_data().x(more));
+  lazy->append(create_data().x(more));
+  REQUIRE(eager->get_data(1).rows() == bins);
+  REQUIRE(lazy->get_data(1).rows() == bins);
+  float total = 0.f;
+  for (int i = 0; i < bins; ++i) {
+    total += eager->get_data(1).begin<Aesthetic::y>()[i];
+    CHECK(eager->get_data(1).begin<Aesthetic::y>()[i] ==
+          lazy->get_data(1).begin<Aesthetic::y>()[i]);
+  }
+  CHECK(total == 8.f);
+
+  // and again for rows appended after the lazy frame was transformed
+  eager->append(create_data().x(more));
+  lazy->append(create_data().x(more));
+  CHECK(lazy->get_data(1).rows() == bins);
+  CHECK(lazy->get_data(1).begin<Aesthetic::y>()[0] ==
+        eager->get_data(1).begin<Aesthetic::y>()[0]);
+}
@@ -0,0 +1,129 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+
+#include "io/JsonLines.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+TEST_CASE("read json lines", "[io]") {
+  // strings and nested values longer than 16 bytes, and escaped quotes,
+  // exercise both the vector and scalar scans
+  const std::string lines =
+      "{\"service\": \"a very long service name \\\"quoted\\\"\", "
+      "\"tags\": {\"region\": \"eu\", \"hosts\": [[1, 2], {\"t\": \"}\"}]}, "
+      "\"time\": 1, \"latency\": 2.5e1}\n"
+      "\r\n"
+      "{\"latency\":-0.125,\"time\":2,\"time\":\"ignored\"}\r\n"
+      "  {\"time\": 3e0, \"ok\": true, \"latency\": 1000000000000000000000}";
+  const std::map<std::string, std::string> fields = {{"x", "time"},
+                                                     {"y", "latency"}};
+  auto data = read_json_lines(lines.data(), lines.size(), fields);
+  REQUIRE(data.rows() == 3);
+  CHECK(data.column(Aesthetic::color::index) == -1);
+  CHECK(data.begin<Aesthetic::x>()[0] == 1.f);
+  CHECK(data.begin<Aesthetic::x>()[1] == 2.f);
+  CHECK(data.begin<Aesthetic::x>()[2] == 3.f);
+  CHECK(data.begin<Aesthetic::y>()[0] == 25.f);
+  CHECK(data.begin<Aesthetic::y>()[1] == -0.125f);
+  CHECK(data.begin<Aesthetic::y>()[2] == 1e21f);
+  CHECK(data.limits().bmin[Aesthetic::y::index] == -0.125f);
+
+  std::istringstream in("{\"v\": 0.1}\n{\"v\": 12345.678}\n");
+  auto stream = read_json_lines(in, {{"color", "v"}});
+  REQUIRE(stream.rows() == 2);
+  CHECK(stream.begin<Aesthetic::color>()[0] == 0.1f);
+  CHECK(stream.begin<Aesthetic::color>()[1] == 12345.678f);
+
+  // one key can be used for several aesthetics
+  std::istringstream shared("{\"t\": 1, \"v\": 2}\n{\"v\": 4, \"t\": 3}\n");
+  auto both = read_json_lines(shared, {{"x", "t"}, {"y", "v"}, {"color", "v"}});
+  REQUIRE(both.rows() == 2);
+  CHECK(both.begin<Aesthetic::y>()[0] == 2.f);
+  CHECK(both.begin<Aesthetic::color>()[0] == 2.f);
+  CHECK(both.begin<Aesthetic::color>()[1] == 4.f);
+  CHECK(both.begin<Aesthetic::x>()[1] == 3.f);
+
+  const auto read = [](const std::string &s) {
+    return read_json_lines(s.data(), s.size(), {{"x", "t"}});
+  };
+  CHECK(read("\n \n").rows() == 0);
+  CHECK_THROWS_AS(read_json_lines("{}", 2, {{"z", "t"}}), Exception);
+  CHECK_THROWS_AS(read("{\"t\": 1}\n[1]\n"), Exception);
+  CHECK_THROWS_AS(read("{\"t\": null}"), Exception);
+  CHECK_THROWS_AS(read("{\"t\": \"1\"}"), Exception);
+  CHECK_THROWS_AS(read("{\"s\": 1}"), Exception);
+  CHECK_THROWS_AS(read("{\"s\": \"unterminated}"), Exception);
+  CHECK_THROWS_AS(read("{\"s\": [1, 2}"), Exception);
+  CHECK_THROWS_AS(read("{\"s\": , \"t\": 1}"), Exception);
+  CHECK_THROWS_AS(read("{\"t\": 1."), Exception);
+  CHECK_THROWS_WITH(read("{\"t\": 1}\n\n{\"s\": 2}\n"),
+                    Catch::Contains("line 3"));
+}
+
+TEST_CASE("read json lines on several threads", "[io]") {
+  // enough lines for several chunks, with some blank lines to close up
+  std::string lines;
+  for (int i = 0; i < 20000; ++i) {
+    lines += "{\"name\": \"point " + std::to_string(i) + "\", \"i\": " +
+             std::to_string(i) + ", \"half\": " + std::to_string(i * 0.5) +
+             "}\n";
+    if (i % 7 == 0) {
+      lines += "\n";
+    }
+  }
+  const std::map<std::string, std::string> fields = {{"x", "i"},
+                                                     {"y", "half"}};
+  auto serial = read_json_lines(lines.data(), lines.size(), fields, 1);
+  auto parallel = read_json_lines(lines.data(), lines.size(), fields, 4);
+  REQUIRE(serial.rows() == 20000);
+  REQUIRE(parallel.rows() == 20000);
+  bool equal = true;
+  for (int i = 0; i < 20000; ++i) {
+    equal = equal && parallel.begin<Aesthetic::x>()[i] == float(i) &&
+            parallel.begin<Aesthetic::y>()[i] == float(i * 0.5) &&
+            serial.begin<Aesthetic::x>()[i] == float(i);
+  }
+  CHECK(equal);
+
+  // the error is reported on the same line whichever thread finds it
+  lines += "{\"i\": 1}\n";
+  const std::string line = std::to_string(20000 + 20000 / 7 + 2);
+  CHECK_THROWS_WITH(read_json_lines(lines.data(), lines.size(), fields, 4),
+                    Catch::Contains("line " + line + ":"));
+}
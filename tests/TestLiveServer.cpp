@@ -0,0 +1,181 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "io/LiveServer.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+/// a minimal HTTP client that sends a GET request to the server
+class Client {
+  int m_fd;
+  std::string m_received;
+
+public:
+  Client(const int port, const std::string &target,
+         const std::string &host = "localhost")
+      : m_fd(::socket(AF_INET, SOCK_STREAM, 0)) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    timeval timeout{5, 0};
+    ::setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    REQUIRE(::connect(m_fd, reinterpret_cast<const sockaddr *>(&addr),
+                      sizeof(addr)) == 0);
+    const std::string request = "GET " + target + " HTTP/1.1\r\nHost: " +
+                                host + ":" + std::to_string(port) +
+                                "\r\n\r\n";
+    REQUIRE(::send(m_fd, request.data(), request.size(), 0) ==
+            static_cast<ssize_t>(request.size()));
+  }
+
+  ~Client() { ::close(m_fd); }
+
+  /// reads until \p text has been received (or the connection is closed),
+  /// and returns everything received since the last call
+  std::string read_until(const std::string &text) {
+    char buffer[4096];
+    while (m_received.find(text) == std::string::npos) {
+      const ssize_t r = ::recv(m_fd, buffer, sizeof(buffer), 0);
+      if (r <= 0) {
+        break;
+      }
+      m_received.append(buffer, static_cast<size_t>(r));
+    }
+    std::string received;
+    received.swap(m_received);
+    return received;
+  }
+};
+
+} // namespace
+
+TEST_CASE("live server", "[io]") {
+  auto fig = figure({{400, 300}});
+  auto ax = fig->axis();
+  ax->title("live \"title\"");
+  LiveServer server(fig);
+  server.start();
+  CHECK(server.port() > 0);
+
+  const std::string page = Client(server.port(), "/").read_until("</html>");
+  CHECK(page.find("HTTP/1.1 200 OK") == 0);
+  CHECK(page.find("EventSource") != std::string::npos);
+  CHECK(Client(server.port(), "/nothing").read_until("\n").find("404") !=
+        std::string::npos);
+  CHECK(Client(server.port(), "/", "127.0.0.1").read_until("</html>").find(
+            "200 OK") != std::string::npos);
+
+  // requests for another host name are refused
+  CHECK(Client(server.port(), "/events", "rebound.example.com")
+            .read_until("\n")
+            .find("403") != std::string::npos);
+
+  Client events(server.port(), "/events");
+  std::string received = events.read_until("event: figure");
+  CHECK(received.find("text/event-stream") != std::string::npos);
+
+  // x = {1, 2}, y = {0, 0}: 1.f is 0000803f and 2.f is 00000040, in base64
+  auto plot = ax->points(create_data().x(std::vector<float>{1, 2}).y(
+      std::vector<float>{0, 0}));
+  CHECK(server.publish() == 4);
+  received = events.read_until("event: limits");
+  CHECK(received.find("\"title\":\"live \\\"title\\\"\"") !=
+        std::string::npos);
+  CHECK(received.find("\"geometry\":\"points\"") != std::string::npos);
+  CHECK(received.find("\"x\":\"AACAPwAAAEA=\"") != std::string::npos);
+  CHECK(received.find("\"y\":\"AAAAAAAAAAA=\"") != std::string::npos);
+
+  // nothing has changed
+  CHECK(server.publish() == 0);
+
+  // only the newest of the new frames is sent, limits are unchanged
+  plot->add_frame(std::vector<float>{1}, std::vector<float>{0}, 1.f);
+  plot->add_frame(std::vector<float>{2, 2}, std::vector<float>{0, 0}, 2.f);
+  CHECK(server.publish() == 1);
+  received = events.read_until("\n\n");
+  CHECK(received.find("event: frame") == 0);
+  CHECK(received.find("\"time\":2") != std::string::npos);
+  CHECK(received.find("\"x\":\"AAAAQAAAAEA=\"") != std::string::npos);
+
+  // a new client gets the current state, without the frames it replaced
+  Client late(server.port(), "/events");
+  received = late.read_until("event: limits");
+  CHECK(received.find("event: axis") != std::string::npos);
+  CHECK(received.find("\"time\":2") != std::string::npos);
+  CHECK(received.find("\"x\":\"AACAPwAAAEA=\"") == std::string::npos);
+
+  // rows appended to the latest frame are part of the state
+  plot->append(create_data().x(std::vector<float>{1}).y(
+      std::vector<float>{0}));
+  CHECK(server.publish() == 1);
+  CHECK(events.read_until("\n\n").find("event: rows") == 0);
+  Client later(server.port(), "/events");
+  received = later.read_until("event: limits");
+  CHECK(received.find("event: rows") != std::string::npos);
+
+  server.stop();
+  CHECK(events.read_until("never sent").empty());
+}
+
+TEST_CASE("live server limits its connections", "[io]") {
+  auto fig = figure({{400, 300}});
+  LiveServer server(fig);
+  server.start();
+
+  std::vector<std::unique_ptr<Client>> clients;
+  for (int i = 0; i < 64; ++i) {
+    clients.emplace_back(new Client(server.port(), "/events"));
+    REQUIRE(clients.back()->read_until("event: figure").find(
+                "event: figure") != std::string::npos);
+  }
+  CHECK(Client(server.port(), "/").read_until("\n").find("503") !=
+        std::string::npos);
+
+  server.stop();
+}
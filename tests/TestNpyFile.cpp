@@ -0,0 +1,262 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "io/NpyFile.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+template <typename T> std::string bytes_of(const std::vector<T> &values) {
+  return std::string(reinterpret_cast<const char *>(values.data()),
+                     values.size() * sizeof(T));
+}
+
+// a version 1 .npy file, with the data aligned to 64 bytes as numpy does
+std::string npy(const std::string &descr, const bool fortran,
+                const std::string &shape, const std::string &data) {
+  std::string dict = "{'descr': '" + descr + "', 'fortran_order': " +
+                     (fortran ? "True" : "False") + ", 'shape': " + shape +
+                     ", }";
+  dict.append((64 - (10 + dict.size() + 1) % 64) % 64, ' ');
+  dict += '\n';
+  std::string out = "\x93NUMPY";
+  out += '\x01';
+  out += '\x00';
+  out += static_cast<char>(dict.size() & 0xff);
+  out += static_cast<char>(dict.size() >> 8);
+  return out + dict + data;
+}
+
+void write_le(std::string &out, const uint64_t value, const int bytes) {
+  for (int i = 0; i < bytes; ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+struct Member {
+  std::string name;
+  std::string data;
+  bool align;
+  int method;
+};
+
+// a zip archive of members stored without compression (the crc is not
+// checked, so it is left as zero). An aligned member has an extra field that
+// pads its data to 4 bytes
+std::string zip(const std::vector<Member> &members) {
+  std::string out;
+  std::string directory;
+  for (const auto &m : members) {
+    const size_t local = out.size();
+    const size_t unpadded = local + 30 + m.name.size();
+    const size_t extra = m.align ? 4 + (4 - unpadded % 4) % 4 : 0;
+    write_le(out, 0x04034b50, 4);
+    write_le(out, 20, 2);
+    write_le(out, 0, 2);
+    write_le(out, m.method, 2);
+    write_le(out, 0, 4);
+    write_le(out, 0, 4);
+    write_le(out, m.data.size(), 4);
+    write_le(out, m.data.size(), 4);
+    write_le(out, m.name.size(), 2);
+    write_le(out, extra, 2);
+    out += m.name;
+    if (extra > 0) {
+      write_le(out, 0xcafe, 2);
+      write_le(out, extra - 4, 2);
+      out.append(extra - 4, '\0');
+    }
+    out += m.data;
+
+    write_le(directory, 0x02014b50, 4);
+    write_le(directory, 20, 2);
+    write_le(directory, 20, 2);
+    write_le(directory, 0, 2);
+    write_le(directory, m.method, 2);
+    write_le(directory, 0, 4);
+    write_le(directory, 0, 4);
+    write_le(directory, m.data.size(), 4);
+    write_le(directory, m.data.size(), 4);
+    write_le(directory, m.name.size(), 2);
+    write_le(directory, 0, 2);
+    write_le(directory, 0, 2);
+    write_le(directory, 0, 2);
+    write_le(directory, 0, 2);
+    write_le(directory, 0, 4);
+    write_le(directory, local, 4);
+    directory += m.name;
+  }
+  const size_t offset = out.size();
+  out += directory;
+  write_le(out, 0x06054b50, 4);
+  write_le(out, 0, 4);
+  write_le(out, members.size(), 2);
+  write_le(out, members.size(), 2);
+  write_le(out, directory.size(), 4);
+  write_le(out, offset, 4);
+  write_le(out, 0, 2);
+  return out;
+}
+
+void write_file(const std::string &filename, const std::string &contents) {
+  std::ofstream out(filename, std::ios::binary);
+  out << contents;
+}
+
+} // namespace
+
+TEST_CASE("read npy files", "[io]") {
+  const std::string filename = "test_npy_file.npy";
+  const std::vector<float> matrix = {0, 10, 100, 1, 11, 101, 2, 12, 102};
+  const int x = Aesthetic::x::index;
+  const int y = Aesthetic::y::index;
+
+  SECTION("float32 in c order is a strided view") {
+    write_file(filename, npy("<f4", false, "(3, 3)", bytes_of(matrix)));
+    auto data = read_npy(filename, {x, -1, y});
+    CHECK(data.raw().is_view());
+    CHECK(data.raw().cols() == 2);
+    REQUIRE(data.rows() == 3);
+    CHECK(data.begin<Aesthetic::x>()[2] == 2.f);
+    CHECK(data.begin<Aesthetic::y>()[1] == 101.f);
+    CHECK(data.limits().bmax[y] == Approx(102.f).margin(0.01));
+  }
+
+  SECTION("float32 in fortran order is a contiguous view") {
+    write_file(filename, npy("<f4", true, "(3, 3)", bytes_of(matrix)));
+    auto data = read_npy(filename, {-1, y, x});
+    CHECK(data.raw().is_view());
+    CHECK(data.begin<Aesthetic::y>()[0] == 1.f);
+    CHECK(data.begin<Aesthetic::x>()[0] == 2.f);
+    CHECK(data.begin<Aesthetic::x>()[2] == 102.f);
+  }
+
+  SECTION("other types are converted") {
+    const std::vector<double> doubles = {0.5, -1.5};
+    write_file(filename, npy("<f8", false, "(2,)", bytes_of(doubles)));
+    auto data = read_npy(filename, {Aesthetic::color::index});
+    CHECK_FALSE(data.raw().is_view());
+    CHECK(data.begin<Aesthetic::color>()[1] == -1.5f);
+
+    // big-endian int16 {258, -2}
+    write_file(filename, npy(">i2", false, "(2L, 1L)",
+                             std::string("\x01\x02\xff\xfe", 4)));
+    data = read_npy(filename, {x});
+    CHECK(data.begin<Aesthetic::x>()[0] == 258.f);
+    CHECK(data.begin<Aesthetic::x>()[1] == -2.f);
+
+    write_file(filename, npy("|u1", true, "(2, 2)", "\x01\x02\x03\xff"));
+    data = read_npy(filename, {x, y});
+    CHECK(data.begin<Aesthetic::x>()[1] == 2.f);
+    CHECK(data.begin<Aesthetic::y>()[1] == 255.f);
+
+    const std::vector<int64_t> longs = {-7, 1ll << 40};
+    write_file(filename, npy("<i8", false, "(2,)", bytes_of(longs)));
+    data = read_npy(filename, {y});
+    CHECK(data.begin<Aesthetic::y>()[0] == -7.f);
+    CHECK(data.begin<Aesthetic::y>()[1] == 1099511627776.f);
+  }
+
+  SECTION("invalid files") {
+    write_file(filename, npy("<f4", false, "(3, 3)", bytes_of(matrix)));
+    CHECK_THROWS_AS(read_npy(filename, {x, y}), Exception);
+    CHECK_THROWS_AS(read_npy(filename, {-1, -1, -1}), Exception);
+    CHECK_THROWS_AS(read_npy(filename, {x, y, 99}), Exception);
+    write_file(filename, npy("<f4", false, "(3, 4)", bytes_of(matrix)));
+    CHECK_THROWS_AS(read_npy(filename, {x, y, -1, -1}), Exception);
+    write_file(filename, npy("<f4", false, "(1, 3, 3)", bytes_of(matrix)));
+    CHECK_THROWS_AS(read_npy(filename, {x}), Exception);
+    write_file(filename, npy("<c8", false, "(1,)", bytes_of(matrix)));
+    CHECK_THROWS_AS(read_npy(filename, {x}), Exception);
+    write_file(filename, "x,y\n1,2\n");
+    CHECK_THROWS_AS(read_npy(filename, {x}), Exception);
+    CHECK_THROWS_AS(read_npy("does_not_exist.npy", {x}), Exception);
+  }
+  std::remove(filename.c_str());
+
+  // records are not supported
+  const std::string records =
+      npy("[('a', '<f4')]", false, "(1,)", std::string(4, '\0'));
+  CHECK_THROWS_AS(read_npy_header(records.data(), records.size()), Exception);
+
+  // version 2 headers have a four byte length
+  std::string v2 = npy("<f4", false, "(2,)", "");
+  v2[6] = '\x02';
+  v2.insert(10, 2, '\0');
+  const NpyHeader header = read_npy_header(v2.data(), v2.size());
+  CHECK(header.data_offset == v2.size());
+  CHECK(header.shape == std::vector<int64_t>{2});
+  CHECK(header.kind == 'f');
+  CHECK(header.item_size == 4);
+}
+
+TEST_CASE("read npz archives", "[io]") {
+  const std::string filename = "test_npy_file.npz";
+  const std::vector<float> positions = {1, 2, 3, 4};
+  const std::vector<float> speeds = {5, 6};
+  write_file(filename,
+             zip({{"pos.npy", npy("<f4", false, "(2, 2)", bytes_of(positions)),
+                   false, 0},
+                  {"speed.npy", npy("<f4", false, "(2,)", bytes_of(speeds)),
+                   true, 0},
+                  {"packed.npy", "", false, 8}}));
+
+  // the data of pos is not aligned in the archive, so it is copied
+  auto pos = read_npz(filename, "pos", {0, 1});
+  CHECK_FALSE(pos.raw().is_view());
+  CHECK(pos.begin<Aesthetic::x>()[1] == 3.f);
+  CHECK(pos.begin<Aesthetic::y>()[1] == 4.f);
+
+  auto speed = read_npz(filename, "speed.npy", {Aesthetic::color::index});
+  CHECK(speed.raw().is_view());
+  CHECK(speed.begin<Aesthetic::color>()[1] == 6.f);
+
+  CHECK_THROWS_AS(read_npz(filename, "packed", {0}), Exception);
+  CHECK_THROWS_AS(read_npz(filename, "missing", {0}), Exception);
+  std::remove(filename.c_str());
+
+  write_file(filename, npy("<f4", false, "(2,)", bytes_of(speeds)));
+  CHECK_THROWS_AS(read_npz(filename, "speed", {0}), Exception);
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "catch.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "trase.hpp"
+
+using namespace trase;
+
+TEST_CASE("render a figure off-screen", "[offscreen]") {
+  auto fig = figure({320, 240});
+  auto ax = fig->axis();
+  std::vector<float> x = {0.f, 1.f, 2.f, 3.f};
+  std::vector<float> y = {0.f, 2.f, 1.f, 3.f};
+  ax->line(create_data().x(x).y(y));
+  ax->points(create_data().x(x).y(x));
+
+  BackendGL backend;
+  backend.offscreen("test_offscreen.png");
+  fig->draw(backend, 0.f);
+
+  REQUIRE(backend.image_width() == 320);
+  REQUIRE(backend.image_height() == 240);
+  const auto &image = backend.image();
+  REQUIRE(image.size() == 4 * 320 * 240);
+
+  // the background is white, the axis box is grey
+  auto pixel = [&](int i, int j) {
+    const auto *p = image.data() + 4 * (j * 320 + i);
+    return RGBA(p[0], p[1], p[2], p[3]);
+  };
+  CHECK(pixel(1, 1) == RGBA(255, 255, 255, 255));
+  CHECK(pixel(160, 120) != RGBA(255, 255, 255, 255));
+
+  std::ifstream png("test_offscreen.png", std::ios::binary);
+  std::string signature(8, '\0');
+  png.read(&signature[0], 8);
+  CHECK(signature == "\x89PNG\r\n\x1a\n");
+
+  // the context is reused for another figure of a different size
+  auto small = fig->clone({64, 48});
+  backend.offscreen();
+  small->draw(backend, 0.f);
+  CHECK(backend.image_width() == 64);
+  CHECK(backend.image().size() == 4 * 64 * 48);
+}
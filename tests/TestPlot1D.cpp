@@ -35,6 +35,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "catch.hpp"
 
 #include <limits>
+#include <memory>
+#include <sstream>
 #include <type_traits>
 
 #include "trase.hpp"
@@ -62,3 +64,141 @@ TEST_CASE("plot1d can be created", "[plot1d]") {
 
   auto pl5 = ax->plot(x, y);
 }
+
+TEST_CASE("plot1d frames from a time aesthetic", "[plot1d]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> time = {10, 10, 11, 11, 11, 12};
+  std::vector<float> x = {0, 1, 0, 1, 2, 0};
+  std::vector<float> id = {1, 2, 1, 2, 3, 3};
+  auto points = ax->points(create_data().x(x).y(x).id(id).time(time));
+
+  REQUIRE(points->data_size() == 3);
+  CHECK(points->get_time(0) == 0.f);
+  CHECK(points->get_time(1) == 1.f);
+  CHECK(points->get_time(2) == 2.f);
+  CHECK(points->get_data(1).rows() == 3);
+
+  // later frames of the same log are shifted like the first, and must follow
+  // the existing ones
+  std::vector<float> later = {13, 14};
+  std::vector<float> earlier = {1, 2};
+  std::vector<float> x2 = {1, 2};
+  points->add_frames(create_data().x(x2).y(x2).time(later));
+  CHECK(points->data_size() == 5);
+  CHECK(points->get_time(3) == 3.f);
+  CHECK(points->get_time(4) == 4.f);
+  CHECK_THROWS_AS(points->add_frames(create_data().x(x2).y(x2).time(earlier)),
+                  Exception);
+}
+
+TEST_CASE("plot1d append rows to the latest frame", "[plot1d]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x = {0, 1};
+  auto line = ax->line(create_data().x(x).y(x));
+
+  std::vector<float> x2 = {2, 10};
+  line->append(create_data().x(x2).y(x2));
+  CHECK_THROWS_AS(line->append(create_data().x(x2)), Exception);
+  CHECK(line->data_size() == 1);
+  CHECK(line->get_data(0).rows() == 4);
+  CHECK(ax->limits().bmax[Aesthetic::x::index] >= 10.f);
+}
+
+namespace {
+
+// an identity transform that counts how many times it is applied
+struct CountingTransform {
+  std::shared_ptr<int> calls;
+  DataWithAesthetic operator()(const DataWithAesthetic &data) const {
+    ++*calls;
+    return data;
+  }
+};
+
+// shifts x by the number of times it has been applied before
+struct ShiftingTransform {
+  int applied = 0;
+  DataWithAesthetic operator()(const DataWithAesthetic &data) {
+    std::vector<float> x(data.begin<Aesthetic::x>(),
+                         data.end<Aesthetic::x>());
+    for (auto &xi : x) {
+      xi += static_cast<float>(applied);
+    }
+    ++applied;
+    return create_data().x(x).y(x);
+  }
+};
+
+} // namespace
+
+TEST_CASE("plot1d lazy frames are transformed when drawn", "[plot1d]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x = {0, 1};
+  auto line = ax->line(create_data().x(x).y(x));
+
+  auto calls = std::make_shared<int>(0);
+  line->set_lazy(true);
+  line->set_transform(Transform(CountingTransform{calls}));
+  for (int i = 1; i < 10; ++i) {
+    std::vector<float> xi = {static_cast<float>(i), i + 1.f};
+    line->add_frame(create_data().x(xi).y(xi), static_cast<float>(i));
+  }
+  CHECK(*calls == 0);
+  CHECK(line->pending_frames() == 9);
+  CHECK(ax->limits().bmax[Aesthetic::x::index] < 2.f);
+
+  // only the frames either side of the time are drawn
+  std::ostringstream out;
+  BackendSVG backend(out);
+  fig->draw(backend, 4.5f);
+  CHECK(*calls == 2);
+  CHECK(line->pending_frames() == 7);
+  CHECK(ax->limits().bmax[Aesthetic::x::index] >= 6.f);
+
+  // transformed frames are kept
+  fig->draw(backend, 4.5f);
+  fig->draw(backend, 5.f);
+  CHECK(*calls == 2);
+
+  // rows appended to a pending frame are transformed with it
+  std::vector<float> x2 = {20, 21};
+  line->append(create_data().x(x2).y(x2));
+  CHECK(*calls == 2);
+  CHECK(line->get_data(9).rows() == 4);
+  CHECK(*calls == 3);
+
+  line->transform_frames();
+  CHECK(*calls == 9);
+  CHECK(line->pending_frames() == 0);
+  CHECK(line->get_data(7).rows() == 2);
+  CHECK(line->get_data(7).limits().bmax[Aesthetic::x::index] ==
+        Approx(8.f).margin(0.01));
+  CHECK(ax->limits().bmax[Aesthetic::x::index] >= 21.f);
+}
+
+TEST_CASE("plot1d lazy frames are transformed apart in a clone",
+          "[plot1d]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x = {0, 1};
+  auto line = ax->line(create_data().x(x).y(x));
+  line->set_lazy(true);
+  line->set_transform(Transform(ShiftingTransform()));
+  line->add_frame(create_data().x(x).y(x), 1.f);
+  line->add_frame(create_data().x(x).y(x), 2.f);
+
+  // each plot applies its own copy of the transform, starting from the state
+  // it had when the plot was cloned
+  auto copy = std::dynamic_pointer_cast<Line>(line->clone(ax.get()));
+  REQUIRE(copy);
+  copy->transform_frames();
+  line->transform_frames();
+  for (const int f : {1, 2}) {
+    CHECK(line->get_data(f).begin<Aesthetic::x>()[0] ==
+          copy->get_data(f).begin<Aesthetic::x>()[0]);
+  }
+  CHECK(line->get_data(2).begin<Aesthetic::x>()[0] == 1.f);
+}
@@ -0,0 +1,166 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "catch.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "util/Exception.hpp"
+#include "util/Png.hpp"
+
+using namespace trase;
+
+namespace {
+
+struct Chunk {
+  std::string type;
+  std::vector<unsigned char> data;
+  bool crc_ok;
+};
+
+uint32_t read_u32(const unsigned char *p) {
+  return (uint32_t(p[0]) << 24u) | (uint32_t(p[1]) << 16u) |
+         (uint32_t(p[2]) << 8u) | uint32_t(p[3]);
+}
+
+uint32_t crc32(const unsigned char *p, size_t n) {
+  uint32_t crc = 0xffffffffu;
+  for (size_t i = 0; i < n; ++i) {
+    crc ^= p[i];
+    for (int k = 0; k < 8; ++k) {
+      crc = (crc & 1u) ? 0xedb88320u ^ (crc >> 1u) : crc >> 1u;
+    }
+  }
+  return crc ^ 0xffffffffu;
+}
+
+std::vector<Chunk> read_chunks(const std::string &png) {
+  const auto *p = reinterpret_cast<const unsigned char *>(png.data());
+  std::vector<Chunk> chunks;
+  size_t pos = 8;
+  while (pos + 12 <= png.size()) {
+    const uint32_t size = read_u32(p + pos);
+    Chunk c;
+    c.type = png.substr(pos + 4, 4);
+    c.data.assign(p + pos + 8, p + pos + 8 + size);
+    c.crc_ok = crc32(p + pos + 4, size + 4) == read_u32(p + pos + 8 + size);
+    chunks.push_back(c);
+    pos += 12 + size;
+  }
+  return chunks;
+}
+
+// decodes a zlib stream made of uncompressed deflate blocks
+std::vector<unsigned char> inflate_stored(const std::vector<unsigned char> &z,
+                                          bool &adler_ok) {
+  std::vector<unsigned char> out;
+  size_t pos = 2;
+  bool last = false;
+  while (!last) {
+    last = (z[pos] & 1u) != 0;
+    REQUIRE((z[pos] & 6u) == 0);
+    const unsigned len = z[pos + 1] | (z[pos + 2] << 8u);
+    const unsigned nlen = z[pos + 3] | (z[pos + 4] << 8u);
+    REQUIRE(len == (~nlen & 0xffffu));
+    out.insert(out.end(), z.begin() + pos + 5, z.begin() + pos + 5 + len);
+    pos += 5 + len;
+  }
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (const unsigned char c : out) {
+    a = (a + c) % 65521u;
+    b = (b + a) % 65521u;
+  }
+  adler_ok = read_u32(z.data() + pos) == ((b << 16u) | a);
+  return out;
+}
+
+void check_png(const int width, const int height) {
+  std::vector<unsigned char> rgba(4 * width * height);
+  for (size_t i = 0; i < rgba.size(); ++i) {
+    rgba[i] = static_cast<unsigned char>(i * 7);
+  }
+  std::ostringstream out;
+  write_png(out, width, height, rgba.data());
+  const std::string png = out.str();
+
+  REQUIRE(png.substr(0, 8) == "\x89PNG\r\n\x1a\n");
+  const auto chunks = read_chunks(png);
+  REQUIRE(chunks.size() == 3);
+  CHECK(chunks[0].type == "IHDR");
+  CHECK(chunks[1].type == "IDAT");
+  CHECK(chunks[2].type == "IEND");
+  for (const auto &c : chunks) {
+    CHECK(c.crc_ok);
+  }
+
+  const auto &ihdr = chunks[0].data;
+  REQUIRE(ihdr.size() == 13);
+  CHECK(read_u32(ihdr.data()) == static_cast<uint32_t>(width));
+  CHECK(read_u32(ihdr.data() + 4) == static_cast<uint32_t>(height));
+  CHECK(ihdr[8] == 8);
+  CHECK(ihdr[9] == 6);
+
+  bool adler_ok = false;
+  const auto raw = inflate_stored(chunks[1].data, adler_ok);
+  CHECK(adler_ok);
+  REQUIRE(raw.size() == static_cast<size_t>(height * (4 * width + 1)));
+  bool rows_ok = true;
+  for (int i = 0; i < height; ++i) {
+    const auto *row = raw.data() + i * (4 * width + 1);
+    rows_ok &= row[0] == 0 &&
+               std::equal(row + 1, row + 1 + 4 * width,
+                          rgba.begin() + i * 4 * width);
+  }
+  CHECK(rows_ok);
+}
+
+} // namespace
+
+TEST_CASE("write png", "[png]") {
+  check_png(3, 2);
+  check_png(1, 1);
+
+  // more than one deflate block
+  check_png(300, 200);
+
+  std::ostringstream out;
+  unsigned char pixel[4] = {0, 0, 0, 0};
+  CHECK_THROWS_AS(write_png(out, 0, 1, pixel), Exception);
+  CHECK_THROWS_AS(write_png("/nonexistent/dir/file.png", 1, 1, pixel),
+                  Exception);
+}
@@ -34,6 +34,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "catch.hpp"
 
 #include "DummyDraw.hpp"
+#include "frontend/Points.hpp"
+
+#include <algorithm>
+#include <sstream>
 
 //! [points example includes]
 #include "trase.hpp"
@@ -125,3 +129,102 @@ TEST_CASE("points creation", "[points]") {
   ax->points(create_data().x(x).y(y).size(r).color(c));
   DummyDraw::draw("points", fig);
 }
+
+TEST_CASE("points animation over several transpose tiles", "[points]") {
+  // enough points that draw_frames() needs more than one tile
+  const int n = 5000;
+  const int nframes = 3;
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x(n), y(n);
+  for (int i = 0; i < n; ++i) {
+    x[i] = static_cast<float>(i);
+    y[i] = static_cast<float>(n - i);
+  }
+  auto points = ax->points(create_data().x(x).y(y));
+  for (int f = 1; f < nframes; ++f) {
+    for (int i = 0; i < n; ++i) {
+      y[i] = static_cast<float>((i * (f + 1)) % n);
+    }
+    points->add_frame(create_data().x(x).y(y), static_cast<float>(f));
+  }
+
+  std::ostringstream out;
+  BackendSVG backend(out);
+  fig->draw(backend);
+  const std::string svg = out.str();
+
+  auto count = [&](const std::string &needle) {
+    int n = 0;
+    for (size_t pos = svg.find(needle); pos != std::string::npos;
+         pos = svg.find(needle, pos + 1)) {
+      ++n;
+    }
+    return n;
+  };
+  CHECK(count("<circle") == n);
+  CHECK(count("attributeName=\"cy\"") == n);
+
+  // every point, including the last, has a value for each frame
+  const size_t last = svg.find("values=", svg.rfind("attributeName=\"cy\""));
+  const std::string values = svg.substr(last, svg.find(' ', last) - last);
+  CHECK(std::count(values.begin(), values.end(), ';') == nframes - 1);
+}
+
+TEST_CASE("points projection", "[points]") {
+  const int n = 40000;
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x(n), y(n), c(n);
+  for (int i = 0; i < n; ++i) {
+    x[i] = static_cast<float>(i % 200);
+    y[i] = static_cast<float>(i / 200);
+    c[i] = static_cast<float>(i % 7);
+  }
+  auto plot = ax->points(create_data().x(x).y(y).color(c));
+  auto points = std::dynamic_pointer_cast<Points>(plot);
+  REQUIRE(points);
+  std::reverse(y.begin(), y.end());
+  points->add_frame(create_data().x(x).y(y).color(c), 1.f);
+
+  auto flatten = [&](int threads) {
+    points->project(threads);
+    std::vector<ProjectedPoint> all;
+    for (const auto &buffer : points->projected()) {
+      all.insert(all.end(), buffer.begin(), buffer.end());
+    }
+    return all;
+  };
+
+  for (const float time : {0.f, 0.3f, 1.f}) {
+    points->update_frame_info(time);
+    const auto serial = flatten(1);
+    const auto parallel = flatten(4);
+    CHECK(points->projected().size() > 1);
+    REQUIRE(serial.size() == n);
+    REQUIRE(parallel.size() == serial.size());
+    bool same = true;
+    for (size_t i = 0; i < serial.size(); ++i) {
+      same &= (serial[i].centre == parallel[i].centre).all() &&
+              serial[i].radius == parallel[i].radius &&
+              serial[i].color == parallel[i].color;
+    }
+    CHECK(same);
+  }
+
+  // the alignment of the frames is redone when the rows change
+  std::vector<float> x2(200, 1.f);
+  points->append(create_data().x(x2).y(x2).color(x2));
+  points->update_frame_info(0.3f);
+  CHECK(flatten(4).size() == n + 200);
+
+  // points outside the axis are culled
+  ax->xlim({{-1.f, 99.5f}});
+  points->update_frame_info(0.f);
+  CHECK(flatten(4).size() == n / 2);
+
+  // frames that provide different aesthetics cannot be interpolated
+  points->add_frame(create_data().x(x).y(y), 2.f);
+  points->update_frame_info(1.5f);
+  CHECK_THROWS_AS(points->project(4), Exception);
+}
@@ -0,0 +1,112 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "io/RenderServer.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+/// opens a connection to the server at \p path, without sending anything
+int connect_to(const std::string &path) {
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  REQUIRE(::connect(fd, reinterpret_cast<const sockaddr *>(&addr),
+                    sizeof(addr)) == 0);
+  return fd;
+}
+} // namespace
+
+TEST_CASE("render server", "[io]") {
+  const std::string path =
+      "/tmp/trase_tst_render_" + std::to_string(getpid()) + ".sock";
+  std::vector<float> x = {1, 2, 3, 4};
+  std::vector<float> y = {1, 4, 9, 16};
+  auto data = create_data().x(x).y(y);
+
+  CHECK_THROWS_AS(render_remote(path, "", data), Exception);
+
+  RenderServer server(path, 2);
+  server.start();
+  CHECK(server.threads() == 2);
+
+  const std::string svg =
+      render_remote(path, "geometry=points\ntitle=remote title\n", data);
+  CHECK(svg.find("<svg") != std::string::npos);
+  CHECK(svg.find("remote title") != std::string::npos);
+
+  CHECK_THROWS_AS(render_remote(path, "geometry=bars", data), Exception);
+  CHECK_THROWS_AS(render_remote(path, "", data, RenderFormat::pdf), Exception);
+#ifndef TRASE_BACKEND_GL
+  CHECK_THROWS_AS(render_remote(path, "", data, RenderFormat::png), Exception);
+#endif
+
+  // idle connections do not hold the workers
+  std::vector<int> idle;
+  for (int i = 0; i < 4; ++i) {
+    idle.push_back(connect_to(path));
+  }
+  CHECK_NOTHROW(render_remote(path, "", data));
+  for (const int fd : idle) {
+    ::close(fd);
+  }
+
+  // the server is still serving requests after the errors above
+  CHECK_NOTHROW(render_remote(path, "", data));
+
+  server.stop();
+  CHECK(access(path.c_str(), F_OK) == -1);
+  CHECK_THROWS_AS(render_remote(path, "", data), Exception);
+
+  // a server stops with a connection open
+  RenderServer small(path, 1, 16);
+  small.start();
+  const int open = connect_to(path);
+
+  // requests larger than the limit are refused
+  CHECK_THROWS_AS(render_remote(path, "", data), Exception);
+  small.stop();
+  ::close(open);
+}
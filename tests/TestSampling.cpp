@@ -0,0 +1,164 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "frontend/Sampling.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+DataWithAesthetic example_data(const int n) {
+  std::vector<float> x(n), y(n), color(n);
+  for (int i = 0; i < n; ++i) {
+    // most of the points are in the bottom left corner
+    x[i] = i % 10 == 0 ? static_cast<float>(i % 97) : (i % 7) / 10.f;
+    y[i] = i % 10 == 0 ? static_cast<float>(i % 89) : (i % 5) / 10.f;
+    color[i] = static_cast<float>(i);
+  }
+  return create_data().x(x).y(y).color(color);
+}
+
+template <typename Aesthetic>
+std::vector<float> values(const DataWithAesthetic &data) {
+  std::vector<float> ret;
+  data.visit<Aesthetic>(
+      [&](const auto v) { ret = std::vector<float>(v, v + data.rows()); });
+  return ret;
+}
+
+std::vector<float> colors(const DataWithAesthetic &data) {
+  return values<Aesthetic::color>(data);
+}
+
+} // namespace
+
+TEST_CASE("random sample", "[sampling]") {
+  const int n = 300000;
+  auto data = example_data(n);
+
+  auto sample = RandomSample(1000, 42, 1)(data);
+  CHECK(sample.rows() == 1000);
+  CHECK(&sample.raw() == &data.raw());
+
+  // each row keeps its own aesthetics
+  const auto c = colors(sample);
+  CHECK(std::is_sorted(c.begin(), c.end()));
+  CHECK(std::adjacent_find(c.begin(), c.end()) == c.end());
+  CHECK(values<Aesthetic::x>(sample)[10] ==
+        data.begin<Aesthetic::x>()[static_cast<int>(c[10])]);
+
+  // the same for any number of threads, different for another seed
+  CHECK(colors(RandomSample(1000, 42, 4)(data)) == c);
+  CHECK(colors(RandomSample(1000, 43, 4)(data)) != c);
+
+  // small datasets are returned unchanged
+  CHECK(RandomSample(n)(data).rows() == n);
+  CHECK_THROWS_AS(RandomSample(0), Exception);
+}
+
+TEST_CASE("stratified sample", "[sampling]") {
+  const int n = 300000;
+  auto data = example_data(n);
+  const int cells = 20;
+
+  auto sample = StratifiedSample(cells, cells, 2, 7, 1)(data);
+  CHECK(colors(StratifiedSample(cells, cells, 2, 7, 3)(data)) ==
+        colors(sample));
+
+  auto cell_of = [&](const float x, const float y) {
+    const auto &lim = data.limits();
+    const int cx = std::min(cells - 1,
+                            static_cast<int>((x - lim.bmin[0]) * cells /
+                                             (lim.bmax[0] - lim.bmin[0])));
+    const int cy = std::min(cells - 1,
+                            static_cast<int>((y - lim.bmin[1]) * cells /
+                                             (lim.bmax[1] - lim.bmin[1])));
+    return cy * cells + cx;
+  };
+
+  // at most two rows in each cell, and every occupied cell is represented
+  std::vector<int> sampled(cells * cells, 0);
+  const auto sample_x = values<Aesthetic::x>(sample);
+  const auto sample_y = values<Aesthetic::y>(sample);
+  for (int i = 0; i < sample.rows(); ++i) {
+    ++sampled[cell_of(sample_x[i], sample_y[i])];
+  }
+  CHECK(*std::max_element(sampled.begin(), sampled.end()) == 2);
+  std::set<int> occupied;
+  for (int i = 0; i < n; ++i) {
+    occupied.insert(cell_of(data.begin<Aesthetic::x>()[i],
+                            data.begin<Aesthetic::y>()[i]));
+  }
+  for (const int cell : occupied) {
+    CHECK(sampled[cell] > 0);
+  }
+
+  // a grid over the limits of a zoomed axis only keeps the rows inside them,
+  // at the same number per cell
+  auto fig = figure();
+  auto ax = fig->axis();
+  const auto &lim = data.limits();
+  const float xmid = 0.5f * (lim.bmin[0] + lim.bmax[0]);
+  const float ymid = 0.5f * (lim.bmin[1] + lim.bmax[1]);
+  ax->xlim({{lim.bmin[0], xmid}});
+  ax->ylim({{lim.bmin[1], ymid}});
+  std::weak_ptr<Axis> weak = ax;
+  auto limits = [weak] {
+    auto axis = weak.lock();
+    return axis ? axis->limits() : Limits();
+  };
+  const StratifiedSample follow(limits, cells, cells, 2, 7);
+  auto zoomed = follow(data);
+  CHECK(zoomed.rows() > sample.rows() / 2);
+  const auto zoomed_x = values<Aesthetic::x>(zoomed);
+  const auto zoomed_y = values<Aesthetic::y>(zoomed);
+  bool inside = true;
+  for (int i = 0; i < zoomed.rows(); ++i) {
+    inside &= zoomed_x[i] <= xmid && zoomed_y[i] <= ymid;
+  }
+  CHECK(inside);
+
+  // once the axis has gone the grid covers the limits of the data
+  fig.reset();
+  ax.reset();
+  CHECK(follow(data).rows() == sample.rows());
+
+  CHECK_THROWS_AS(StratifiedSample(0, 10), Exception);
+}
@@ -0,0 +1,162 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "io/SceneFile.hpp"
+#include "trase.hpp"
+
+#ifndef _WIN32
+#include "io/MappedSceneFile.hpp"
+#endif
+
+using namespace trase;
+
+namespace {
+
+std::shared_ptr<Figure> example_figure() {
+  auto fig = figure({640, 480});
+  auto ax = fig->axis();
+  ax->xlabel("x");
+  ax->ylabel("y");
+  ax->title("scene");
+  ax->legend();
+
+  std::vector<float> x = {0, 1, 2, 3, 4};
+  std::vector<float> y = {1, 3, 2, 5, 4};
+  auto line = ax->line(create_data().x(x).y(y));
+  line->set_label("line");
+  line->add_frame(create_data().x(x).y(x), 1.f);
+
+  std::vector<float> color = {0, 0.25f, 0.5f, 0.75f, 1};
+  auto points = ax->points(create_data().x(y).y(x).color(color));
+  points->set_label("points");
+  points->set_color(RGBA(10, 20, 30, 40));
+
+  std::vector<float> samples = {0.1f, 0.2f, 0.2f, 0.7f, 0.9f, 0.9f, 0.95f};
+  ax->histogram(create_data().x(samples));
+  return fig;
+}
+
+std::string svg(Figure &fig) {
+  std::ostringstream out;
+  BackendSVG backend(out);
+  fig.draw(backend);
+
+  // figures are numbered in order of creation, ignore the number
+  std::string result = out.str();
+  const auto desc = result.find("<desc>");
+  result.erase(desc, result.find("</desc>") - desc);
+  return result;
+}
+
+} // namespace
+
+TEST_CASE("scene file round trip", "[io]") {
+  auto fig = example_figure();
+  std::stringstream ss;
+  save_figure(ss, *fig);
+
+  auto loaded = load_figure(ss);
+  auto ax = loaded->axis(0);
+  CHECK(loaded->axis(0)->plot(0)->get_label() == "line");
+  CHECK(ax->plot(1)->get_color() == RGBA(10, 20, 30, 40));
+  CHECK_THROWS_AS(ax->plot(3), std::out_of_range);
+  CHECK(svg(*loaded) == svg(*fig));
+
+  // the plot data point into the loaded buffer
+  CHECK(ax->plot(0)->get_data(0).raw().is_view());
+
+  SECTION("invalid data") {
+    const std::string bytes = ss.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 9));
+    CHECK_THROWS_AS(load_figure(truncated), Exception);
+    std::stringstream garbage("not a scene file");
+    CHECK_THROWS_AS(load_figure(garbage), Exception);
+  }
+
+  SECTION("data frames that do not match the scene") {
+    auto two_frames = figure();
+    std::vector<float> x = {0, 1, 2};
+    auto line = two_frames->axis()->line(create_data().x(x).y(x));
+    line->add_frame(create_data().x(x).y(x), 1.f);
+    std::stringstream saved;
+    save_figure(saved, *two_frames);
+    std::string bytes = saved.str();
+
+    // the line is the last thing in the scene, after its frame count, and
+    // each frame is a header of 20 values and 3 rows of 2 columns
+    const size_t frame_bytes = (20 + 3 * 2) * sizeof(int32_t);
+    const size_t count = bytes.size() - 2 * frame_bytes - sizeof(uint32_t);
+    const size_t last = bytes.size() - frame_bytes;
+    auto set = [&](const size_t pos, const int32_t value) {
+      std::string corrupt = bytes;
+      std::memcpy(&corrupt[pos], &value, sizeof(value));
+      return corrupt;
+    };
+
+    // fewer frames than frame times
+    std::stringstream missing(set(count, 1).substr(0, last));
+    CHECK_THROWS_AS(load_figure(missing), Exception);
+
+    // more columns than the scene holds
+    std::stringstream too_wide(set(last + sizeof(int32_t), 3));
+    CHECK_THROWS_AS(load_figure(too_wide), Exception);
+
+    // a frame without rows can claim any number of columns
+    std::string empty = set(last, 0);
+    std::memcpy(&empty[last + sizeof(int32_t)], "\xff\xff\xff\x7f", 4);
+    std::stringstream wide(empty);
+    auto loaded = load_figure(wide);
+    CHECK(loaded->axis(0)->plot(0)->get_data(1).cols() == 2);
+  }
+
+#ifndef _WIN32
+  SECTION("memory map") {
+    const std::string filename = "test_scene.trsc";
+    save_figure(filename, *fig);
+    auto mapped = map_figure(filename);
+    std::remove(filename.c_str());
+    CHECK(svg(*mapped) == svg(*fig));
+
+    CHECK_THROWS_AS(map_figure("does_not_exist.trsc"), Exception);
+  }
+#endif
+}
@@ -0,0 +1,241 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "io/SharedMemory.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+std::string shm_test_name() {
+  return "/trase_tst_" + std::to_string(getpid());
+}
+} // namespace
+
+TEST_CASE("raw data views", "[data]") {
+  auto matrix = std::make_shared<std::vector<float>>(
+      std::vector<float>{1, 10, 2, 20, 3, 30});
+  RawData view(3, {{matrix->data(), 2}, {matrix->data() + 1, 2}}, matrix);
+
+  CHECK(view.is_view());
+  CHECK(view.rows() == 3);
+  CHECK(view.cols() == 2);
+  CHECK(view.end(1) - view.begin(1) == 3);
+  CHECK(view.begin(0)[2] == 3.f);
+  CHECK(view.begin(1)[1] == 20.f);
+  CHECK_THROWS_AS(view.add_column(std::vector<float>(3)), Exception);
+  CHECK_THROWS_AS(view.set_column(0, std::vector<float>(3)), Exception);
+
+  DataWithAesthetic data(std::make_shared<RawData>(view));
+  data.map(Aesthetic::x::index, 1);
+  CHECK(data.column(Aesthetic::x::index) == 1);
+  CHECK(data.column(Aesthetic::y::index) == -1);
+  CHECK(data.begin<Aesthetic::x>()[0] == 10.f);
+  CHECK(data.limits().bmin[Aesthetic::x::index] == 10.f);
+  CHECK(data.limits().bmax[Aesthetic::x::index] == 30.f);
+  CHECK_THROWS_AS(data.map(Aesthetic::y::index, 2), std::out_of_range);
+}
+
+TEST_CASE("shared memory frames", "[shared_memory]") {
+  const std::string name = shm_test_name();
+  ShmProducer producer(name, 2, 100);
+  ShmConsumer consumer(name);
+
+  DataWithAesthetic frame;
+  float time;
+  CHECK_FALSE(consumer.next(frame, time));
+
+  std::vector<float> x = {1, 2, 3};
+  std::vector<float> y = {4, 5, 6};
+  REQUIRE(producer.publish(create_data().x(x).y(y), 0.f));
+
+  REQUIRE(consumer.next(frame, time));
+  CHECK(time == 0.f);
+  CHECK(frame.rows() == 3);
+  CHECK(frame.raw().is_view());
+  CHECK(frame.column(Aesthetic::color::index) == -1);
+  for (int i = 0; i < 3; ++i) {
+    CHECK(frame.begin<Aesthetic::x>()[i] == x[i]);
+    CHECK(frame.begin<Aesthetic::y>()[i] == y[i]);
+  }
+  CHECK(frame.limits().bmax[Aesthetic::y::index] == 6.f);
+
+  SECTION("slots held by the consumer are not overwritten") {
+    REQUIRE(producer.publish(create_data().x(y).y(x), 1.f));
+    // slot 0 is still held by frame
+    CHECK_FALSE(producer.publish(create_data().x(x).y(y), 2.f));
+    CHECK(frame.begin<Aesthetic::x>()[0] == 1.f);
+
+    frame = DataWithAesthetic();
+    CHECK(producer.publish(create_data().x(x).y(y), 2.f));
+    CHECK(producer.published() == 3);
+  }
+
+  SECTION("frames are added to plots") {
+    auto fig = figure();
+    auto ax = fig->axis();
+    auto points = ax->points(create_data().x(x).y(y));
+    frame = DataWithAesthetic();
+
+    for (auto &v : y) {
+      v += 1.f;
+    }
+    REQUIRE(producer.publish(create_data().x(x).y(y), 0.5f));
+    CHECK(consumer.poll(*points) == 1);
+    CHECK(consumer.poll(*points) == 0);
+    CHECK(points->data_size() == 2);
+    CHECK(points->get_data(1).begin<Aesthetic::y>()[0] == 5.f);
+    CHECK_FALSE(points->get_data(1).raw().is_view());
+
+    // the plot holds copies of the frames, so the producer can go on
+    REQUIRE(producer.publish(create_data().x(x).y(y), 2.f));
+    REQUIRE(producer.publish(create_data().x(x).y(y), 3.f));
+    CHECK(consumer.poll(*points) == 2);
+    CHECK(points->data_size() == 4);
+    CHECK(consumer.dropped() == 0);
+  }
+
+  SECTION("the latest frame is added to plots as a view") {
+    auto fig = figure();
+    auto ax = fig->axis();
+    auto points = ax->points(create_data().x(x).y(y));
+    frame = DataWithAesthetic();
+
+    REQUIRE(producer.publish(create_data().x(x).y(y), 0.5f));
+    CHECK(consumer.poll(*points, true) == 1);
+    CHECK(points->get_data(1).raw().is_view());
+
+    // the view is copied once a newer frame is polled, so the plot never
+    // holds more than one slot of the ring
+    for (int i = 2; i < 6; ++i) {
+      REQUIRE(producer.publish(create_data().x(x).y(y), 0.5f * i));
+      CHECK(consumer.poll(*points, true) == 1);
+      CHECK_FALSE(points->get_data(i - 1).raw().is_view());
+      CHECK(points->get_data(i).raw().is_view());
+    }
+
+    // the slot of the latest frame is held until it is copied
+    REQUIRE(producer.publish(create_data().x(x).y(y), 3.f));
+    CHECK_FALSE(producer.publish(create_data().x(x).y(y), 3.5f));
+    CHECK(consumer.poll(*points, true) == 1);
+    CHECK(producer.publish(create_data().x(x).y(y), 3.5f));
+    CHECK(consumer.poll(*points, true) == 1);
+    CHECK(points->data_size() == 8);
+    CHECK_FALSE(points->get_data(6).raw().is_view());
+    CHECK(points->get_data(7).begin<Aesthetic::y>()[2] == 6.f);
+    CHECK(consumer.dropped() == 0);
+  }
+
+  SECTION("frames that are too large are rejected") {
+    std::vector<float> big(60);
+    CHECK_THROWS_AS(producer.publish(create_data().x(big).y(big), 1.f),
+                    Exception);
+  }
+}
+
+TEST_CASE("shared memory consumer reads while the producer publishes",
+          "[shared_memory]") {
+  // a single slot, so that the consumer often finds it being written
+  const int n = 4;
+  const std::string name = shm_test_name();
+  ShmProducer producer(name, 1, 2 * n);
+  ShmConsumer consumer(name);
+
+  std::atomic<bool> done(false);
+  std::thread reader([&]() {
+    DataWithAesthetic frame;
+    float time;
+    while (!done) {
+      while (consumer.next(frame, time)) {
+        frame = DataWithAesthetic();
+      }
+    }
+  });
+  std::vector<float> x(n, 1.f);
+  for (int i = 0; i < 20000; ++i) {
+    producer.publish(create_data().x(x).y(x), static_cast<float>(i));
+  }
+  done = true;
+  reader.join();
+
+  // leases taken while the slot was written must not be lost, or the slot
+  // would never be free again
+  CHECK(producer.publish(create_data().x(x).y(x), 20000.f));
+}
+
+TEST_CASE("slots held by a consumer that has exited are reclaimed",
+          "[shared_memory]") {
+  const std::string name = shm_test_name();
+  ShmProducer producer(name, 1, 8);
+  std::vector<float> x = {1, 2};
+  REQUIRE(producer.publish(create_data().x(x).y(x), 0.f));
+
+  const pid_t child = fork();
+  if (child == 0) {
+    // exit while holding the only slot, without releasing it
+    ShmConsumer consumer(name);
+    DataWithAesthetic frame;
+    float time;
+    _exit(consumer.next(frame, time) ? 0 : 1);
+  }
+  REQUIRE(child > 0);
+  int status;
+  REQUIRE(waitpid(child, &status, 0) == child);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 0);
+
+  CHECK(producer.publish(create_data().x(x).y(x), 1.f));
+
+  // a live consumer still holds its slot
+  ShmConsumer consumer(name);
+  DataWithAesthetic frame;
+  float time;
+  REQUIRE(consumer.next(frame, time));
+  CHECK(time == 1.f);
+  CHECK_FALSE(producer.publish(create_data().x(x).y(x), 2.f));
+}
+
+TEST_CASE("shared memory consumer needs an existing segment",
+          "[shared_memory]") {
+  CHECK_THROWS_AS(ShmConsumer(shm_test_name() + "_missing"), Exception);
+}
@@ -0,0 +1,262 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "frontend/Streaming.hpp"
+#include "io/ColumnFile.hpp"
+#ifndef _WIN32
+#include "io/MappedColumnFile.hpp"
+#endif
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+// a source of n normally distributed x values and uniform y values, in blocks
+// of block_rows
+GeneratorSource normal_source(const int n, const int block_rows,
+                              std::vector<float> &all_x) {
+  auto gen = std::make_shared<std::default_random_engine>();
+  auto remaining = std::make_shared<int>(n);
+  all_x.clear();
+  return GeneratorSource([=, &all_x](DataWithAesthetic &block) {
+    if (*remaining == 0) {
+      return false;
+    }
+    std::normal_distribution<float> normal(1.f, 2.f);
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+    std::vector<float> x(std::min(block_rows, *remaining));
+    std::vector<float> y(x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+      x[i] = normal(*gen);
+      y[i] = uniform(*gen);
+    }
+    all_x.insert(all_x.end(), x.begin(), x.end());
+    *remaining -= static_cast<int>(x.size());
+    block = create_data().x(x).y(y);
+    return true;
+  });
+}
+
+} // namespace
+
+TEST_CASE("streaming accumulators", "[streaming]") {
+  std::vector<float> all_x;
+  auto source = normal_source(10000, 999, all_x);
+
+  StreamingLimits limits;
+  StreamingBinX bins(20, -3.f, 5.f);
+  StreamingMoments moments;
+  StreamingSample sample(100, 42);
+  CHECK(stream(source, limits, bins, moments, sample) == 10000);
+  REQUIRE(all_x.size() == 10000);
+
+  // limits
+  const auto min_max = std::minmax_element(all_x.begin(), all_x.end());
+  CHECK(limits.limits().bmin[Aesthetic::x::index] == *min_max.first);
+  CHECK(limits.limits().bmax[Aesthetic::x::index] == *min_max.second);
+  CHECK(limits.limits().bmin[Aesthetic::y::index] >= 0.f);
+  CHECK(limits.limits().bmax[Aesthetic::y::index] <= 1.f);
+  CHECK(limits.limits().bmin[Aesthetic::color::index] >
+        limits.limits().bmax[Aesthetic::color::index]);
+
+  // the bins match those from BinX over the whole dataset
+  auto whole = create_data().x(all_x);
+  auto binned = BinX(20, -3.f, 5.f)(whole);
+  auto streamed = bins.result();
+  REQUIRE(streamed.rows() == 20);
+  uint64_t total = bins.underflow() + bins.overflow();
+  for (int i = 0; i < 20; ++i) {
+    CHECK(streamed.begin<Aesthetic::y>()[i] ==
+          binned.begin<Aesthetic::y>()[i]);
+    total += bins.counts()[i];
+  }
+  CHECK(total == 10000);
+  CHECK(bins.underflow() > 0);
+  CHECK(bins.overflow() > 0);
+  CHECK(streamed.limits().bmin[Aesthetic::x::index] == -3.f);
+  CHECK(streamed.limits().bmax[Aesthetic::x::index] == 5.f);
+
+  // moments
+  double mean = 0;
+  for (const float x : all_x) {
+    mean += x;
+  }
+  mean /= all_x.size();
+  double variance = 0;
+  for (const float x : all_x) {
+    variance += (x - mean) * (x - mean);
+  }
+  variance /= all_x.size();
+  CHECK(moments.count() == 10000);
+  CHECK(moments.mean() == Approx(mean));
+  CHECK(moments.variance() == Approx(variance));
+
+  // sample
+  auto sampled = sample.result();
+  CHECK(sample.seen() == 10000);
+  REQUIRE(sampled.rows() == 100);
+  CHECK(sampled.column(Aesthetic::y::index) != -1);
+  for (int i = 0; i < sampled.rows(); ++i) {
+    CHECK(std::find(all_x.begin(), all_x.end(),
+                    sampled.begin<Aesthetic::x>()[i]) != all_x.end());
+  }
+
+  // the binned result can be plotted directly
+  auto fig = figure();
+  auto ax = fig->axis();
+  CHECK_NOTHROW(ax->histogram(streamed, Transform(Identity())));
+
+  CHECK_THROWS_AS(StreamingBinX(0, 0.f, 1.f), Exception);
+  CHECK_THROWS_AS(StreamingBinX(10, 1.f, 1.f), Exception);
+  CHECK_THROWS_AS(StreamingSample(0), Exception);
+}
+
+TEST_CASE("column file sources", "[streaming]") {
+  std::vector<float> x(1000);
+  std::vector<float> color(1000);
+  for (int i = 0; i < 1000; ++i) {
+    x[i] = static_cast<float>(i);
+    color[i] = static_cast<float>(-i);
+  }
+  std::stringstream ss;
+  write_columns(ss, create_data().x(x).color(color));
+
+  auto check_source = [&](RowSource &source) {
+    StreamingLimits limits;
+    StreamingMoments moments(Aesthetic::color::index);
+    CHECK(stream(source, limits, moments) == 1000);
+    CHECK(limits.limits().bmin[Aesthetic::x::index] == 0.f);
+    CHECK(limits.limits().bmax[Aesthetic::x::index] == 999.f);
+    CHECK(limits.limits().bmin[Aesthetic::color::index] == -999.f);
+    CHECK(moments.mean() == Approx(-499.5));
+  };
+
+  SECTION("stream") {
+    ColumnFileSource source(ss, 300);
+    check_source(source);
+  }
+
+#ifndef _WIN32
+  SECTION("memory map") {
+    const std::string filename = "test_streaming.trcf";
+    {
+      std::ofstream out(filename, std::ios::binary);
+      out << ss.str();
+    }
+    MappedColumnFileSource source(filename, 300);
+    DataWithAesthetic first;
+    {
+      check_source(source);
+      MappedColumnFileSource again(filename, 256);
+      REQUIRE(again.next(first));
+    }
+    // blocks are views that keep the mapping alive
+    CHECK(first.raw().is_view());
+    CHECK(first.rows() == 256);
+    CHECK(first.begin<Aesthetic::x>()[255] == 255.f);
+    std::remove(filename.c_str());
+
+    CHECK_THROWS_AS(MappedColumnFileSource("does_not_exist.trcf", 10),
+                    Exception);
+  }
+#endif
+}
+
+TEST_CASE("merging partial states", "[streaming]") {
+  std::vector<float> all_x;
+  auto source = normal_source(9000, 1000, all_x);
+  StreamingLimits limits;
+  StreamingBinX bins(15, -2.f, 4.f);
+  StreamingMoments moments;
+  stream(source, limits, bins, moments);
+
+  // compute partial states over three shards, and send them through a stream
+  std::stringstream partials;
+  for (int shard = 0; shard < 3; ++shard) {
+    std::vector<float> x(all_x.begin() + shard * 3000,
+                         all_x.begin() + (shard + 1) * 3000);
+    auto data = create_data().x(x);
+    StreamingLimits shard_limits;
+    StreamingBinX shard_bins(15, -2.f, 4.f);
+    StreamingMoments shard_moments;
+    shard_limits.consume(data);
+    shard_bins.consume(data);
+    shard_moments.consume(data);
+    shard_limits.write(partials);
+    shard_bins.write(partials);
+    shard_moments.write(partials);
+  }
+
+  auto merged_limits = StreamingLimits::read(partials);
+  auto merged_bins = StreamingBinX::read(partials);
+  auto merged_moments = StreamingMoments::read(partials);
+  for (int shard = 1; shard < 3; ++shard) {
+    merged_limits.merge(StreamingLimits::read(partials));
+    merged_bins.merge(StreamingBinX::read(partials));
+    merged_moments.merge(StreamingMoments::read(partials));
+  }
+
+  CHECK(merged_limits.limits().bmin[Aesthetic::x::index] ==
+        limits.limits().bmin[Aesthetic::x::index]);
+  CHECK(merged_limits.limits().bmax[Aesthetic::x::index] ==
+        limits.limits().bmax[Aesthetic::x::index]);
+  CHECK(merged_limits.limits().bmin[Aesthetic::y::index] >
+        merged_limits.limits().bmax[Aesthetic::y::index]);
+  CHECK(merged_bins.counts() == bins.counts());
+  CHECK(merged_bins.underflow() == bins.underflow());
+  CHECK(merged_bins.overflow() == bins.overflow());
+  CHECK(merged_moments.count() == moments.count());
+  CHECK(merged_moments.mean() == Approx(moments.mean()));
+  CHECK(merged_moments.variance() == Approx(moments.variance()));
+
+  CHECK_THROWS_AS(merged_bins.merge(StreamingBinX(15, -2.f, 5.f)), Exception);
+  CHECK_THROWS_AS(merged_bins.merge(StreamingBinX(14, -2.f, 4.f)), Exception);
+  CHECK_THROWS_AS(merged_moments.merge(StreamingMoments(Aesthetic::y::index)),
+                  Exception);
+
+  std::stringstream wrong_type;
+  moments.write(wrong_type);
+  CHECK_THROWS_AS(StreamingBinX::read(wrong_type), Exception);
+  std::stringstream truncated(partials.str().substr(0, 10));
+  CHECK_THROWS_AS(StreamingLimits::read(truncated), Exception);
+}
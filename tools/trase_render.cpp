@@ -0,0 +1,228 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file trase_render.cpp
+/// Renders many datasets to SVG files in parallel
+///
+/// usage: trase-render [-j threads] [-o output dir] <spec> <input>...
+///
+/// Each input is either a csv file (.csv extension) or a binary column file
+/// (see ColumnFile.hpp), and is plotted as described by the PlotSpec file
+/// <spec>. The output file has the same name as the input, with the extension
+/// replaced by .svg. Timing and size statistics are printed for every file.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "io/ColumnFile.hpp"
+#include "io/CsvFile.hpp"
+#include "io/PlotSpec.hpp"
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct Options {
+  int threads{0};
+  std::string output_dir;
+  std::string spec;
+  std::vector<std::string> inputs;
+};
+
+bool parse_options(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if ((arg == "-j" || arg == "-o") && i + 1 < argc) {
+      if (arg == "-j") {
+        options.threads = std::atoi(argv[++i]);
+      } else {
+        options.output_dir = argv[++i];
+      }
+    } else if (!arg.empty() && arg[0] == '-') {
+      return false;
+    } else if (options.spec.empty()) {
+      options.spec = arg;
+    } else {
+      options.inputs.push_back(arg);
+    }
+  }
+  return !options.spec.empty() && !options.inputs.empty();
+}
+
+std::string read_file(const std::string &filename) {
+  std::ifstream in(filename, std::ios::binary);
+  if (!in) {
+    throw Exception("unable to open " + filename);
+  }
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+bool ends_with(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string output_filename(const std::string &input,
+                            const std::string &output_dir) {
+  std::string name = input;
+  if (!output_dir.empty()) {
+    const auto slash = name.find_last_of('/');
+    if (slash != std::string::npos) {
+      name = name.substr(slash + 1);
+    }
+    name = output_dir + '/' + name;
+  }
+  const auto dot = name.find_last_of('.');
+  const auto slash = name.find_last_of('/');
+  if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+    name.erase(dot);
+  }
+  return name + ".svg";
+}
+
+/// renders a single input, returning the size of the output file
+size_t render_file(const std::string &input, const std::string &output,
+                   const PlotSpec &spec,
+                   const std::shared_ptr<LayerCache> &cache) {
+  std::ifstream in(input, std::ios::binary);
+  if (!in) {
+    throw Exception("unable to open " + input);
+  }
+  const DataWithAesthetic data =
+      ends_with(input, ".csv") ? read_csv(in) : read_columns(in);
+
+  auto fig = make_figure(spec, data);
+  std::ostringstream svg;
+  BackendSVG backend(svg);
+  backend.layer_cache(cache);
+  fig->draw(backend);
+
+  const std::string bytes = svg.str();
+  std::ofstream out(output, std::ios::binary);
+  if (!out.write(bytes.data(), bytes.size())) {
+    throw Exception("unable to write " + output);
+  }
+  return bytes.size();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    std::cerr << "usage: " << argv[0]
+              << " [-j threads] [-o output dir] <spec> <input>...\n";
+    return 1;
+  }
+
+  PlotSpec spec;
+  try {
+    spec = parse_plot_spec(read_file(options.spec));
+  } catch (std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  int threads = options.threads;
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::min(threads, static_cast<int>(options.inputs.size()));
+
+  // figures sharing a layout also share their static layers
+  auto cache = std::make_shared<LayerCache>();
+
+  std::atomic<size_t> next(0);
+  std::atomic<int> failed(0);
+  std::atomic<size_t> total_bytes(0);
+  std::mutex print_mutex;
+
+  const auto start = clock_type::now();
+  auto worker = [&]() {
+    for (size_t i = next++; i < options.inputs.size(); i = next++) {
+      const std::string &input = options.inputs[i];
+      const std::string output = output_filename(input, options.output_dir);
+      const auto file_start = clock_type::now();
+      std::string error;
+      size_t bytes = 0;
+      try {
+        bytes = render_file(input, output, spec, cache);
+        total_bytes += bytes;
+      } catch (std::exception &e) {
+        error = e.what();
+        ++failed;
+      }
+      const std::chrono::duration<double, std::milli> ms =
+          clock_type::now() - file_start;
+
+      std::lock_guard<std::mutex> lock(print_mutex);
+      if (error.empty()) {
+        std::cout << output << ' ' << std::fixed << std::setprecision(2)
+                  << ms.count() << " ms " << bytes << " bytes\n";
+      } else {
+        std::cerr << input << " failed: " << error << '\n';
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  const std::chrono::duration<double> seconds = clock_type::now() - start;
+
+  const size_t rendered = options.inputs.size() - failed;
+  std::cout << "rendered " << rendered << " of " << options.inputs.size()
+            << " files (" << total_bytes << " bytes) in " << std::fixed
+            << std::setprecision(3) << seconds.count() << " s using "
+            << threads << " threads" << std::endl;
+  return failed > 0 ? 1 : 0;
+}